@@ -4,10 +4,11 @@
 #
 #-------------------------------------------------
 
-QT += widgets quickwidgets
+QT += widgets quickwidgets network
 
 TEMPLATE = lib
 TARGET = ScreenSpaceCameraController
+CONFIG += c++14
 
 win32:CONFIG(release, debug|release): {
        DESTDIR = $$PWD/../x64/release
@@ -25,6 +26,15 @@ win32:CONFIG(release, debug|release) : {
 
 DEFINES += QT_DEPRECATED_WARNINGS
 
+# sqrt不设置errno, RtcEllipsoidPicker的float循环才能向量化
+gcc|clang: QMAKE_CXXFLAGS += -fno-math-errno
+
+# CONFIG += avx2 开启BatchTransform, WindowProjection, CullingVolume和EllipsoidalOccluder的AVX2路径 (需要支持AVX2和FMA的CPU)
+avx2 {
+    msvc: QMAKE_CXXFLAGS += /arch:AVX2
+    else: QMAKE_CXXFLAGS += -mavx2 -mfma
+}
+
 
 INCLUDEPATH += $$PWD/../licore/include
 
@@ -33,6 +43,7 @@ SOURCES += \
         cameraeventaggregator.cpp \
         screenspaceeventhandler.cpp \
         intersectiontests.cpp \
+        sphere.cpp \
         cameracontroller.cpp \
         quadraticrealpolynomial.cpp \
         cubicrealpolynomial.cpp \
@@ -40,6 +51,19 @@ SOURCES += \
         tweencollection.cpp \
         tweenjs.cpp \
         cameraflightpath.cpp \
+        cameratour.cpp \
+        camerapathfile.cpp \
+        camerastate.cpp \
+        cameraclock.cpp \
+        cameracommandbuffer.cpp \
+        camerasync.cpp \
+        camerasimulation.cpp \
+        cameraenvironment.cpp \
+        rtcellipsoidpicker.cpp \
+        batchtransform.cpp \
+        windowprojection.cpp \
+        cullingvolume.cpp \
+        ellipsoidaloccluder.cpp \
         cesiummath.cpp \
         cesiumcartesian3.cpp \
         ellipsoidgeodesic.cpp
@@ -50,6 +74,7 @@ HEADERS += \
         cameraeventaggregator.h \
         screenspaceeventhandler.h \
         intersectiontests.h \
+        sphere.h \
         cameracontroller.h \
         quadraticrealpolynomial.h \
         cubicrealpolynomial.h \
@@ -57,7 +82,21 @@ HEADERS += \
         screenspaceeventutils.h \
         tweencollection.h \
         tweenjs.h \
+        easing.h \
         cameraflightpath.h \
+        cameratour.h \
+        camerapathfile.h \
+        camerastate.h \
+        cameraclock.h \
+        cameracommandbuffer.h \
+        camerasync.h \
+        camerasimulation.h \
+        cameraenvironment.h \
+        rtcellipsoidpicker.h \
+        batchtransform.h \
+        windowprojection.h \
+        cullingvolume.h \
+        ellipsoidaloccluder.h \
         cesiummath.h \
         cesiumcartesian3.h \
         ellipsoidgeodesic.h
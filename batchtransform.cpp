@@ -0,0 +1,113 @@
+#include "batchtransform.h"
+
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#include <immintrin.h>
+#define BATCHTRANSFORM_AVX2
+#endif
+
+BatchTransform::BatchTransform()
+{
+    const double identity[12] = {
+        1.0, 0.0, 0.0, 0.0,
+        0.0, 1.0, 0.0, 0.0,
+        0.0, 0.0, 1.0, 0.0
+    };
+    for (int i = 0; i < 12; ++i) {
+        _m[i] = identity[i];
+    }
+}
+
+BatchTransform BatchTransform::fromMatrix(const Matrix4 &matrix)
+{
+    BatchTransform result;
+    for (int row = 0; row < 3; ++row) {
+        result._m[row * 4 + 0] = matrix[row];
+        result._m[row * 4 + 1] = matrix[row + 4];
+        result._m[row * 4 + 2] = matrix[row + 8];
+        result._m[row * 4 + 3] = matrix[row + 12];
+    }
+    return result;
+}
+
+BatchTransform BatchTransform::fromCameraAxes(const Cartesian3 &position, const Cartesian3 &right, const Cartesian3 &direction, const Cartesian3 &up)
+{
+    BatchTransform result;
+    const Cartesian3 *axes[3] = { &right, &direction, &up };
+    for (int row = 0; row < 3; ++row) {
+        const Cartesian3 &axis = *axes[row];
+        result._m[row * 4 + 0] = axis.x;
+        result._m[row * 4 + 1] = axis.y;
+        result._m[row * 4 + 2] = axis.z;
+        result._m[row * 4 + 3] = -Cartesian3::dot(axis, position);
+    }
+    return result;
+}
+
+Cartesian3 BatchTransform::transformPoint(const Cartesian3 &point) const
+{
+    return Cartesian3(_m[0] * point.x + _m[1] * point.y + _m[2] * point.z + _m[3],
+                      _m[4] * point.x + _m[5] * point.y + _m[6] * point.z + _m[7],
+                      _m[8] * point.x + _m[9] * point.y + _m[10] * point.z + _m[11]);
+}
+
+void BatchTransform::transformPoints(const double *x, const double *y, const double *z,
+                                     double *resultX, double *resultY, double *resultZ, int count) const
+{
+    transform(x, y, z, resultX, resultY, resultZ, count, true);
+}
+
+void BatchTransform::transformVectors(const double *x, const double *y, const double *z,
+                                      double *resultX, double *resultY, double *resultZ, int count) const
+{
+    transform(x, y, z, resultX, resultY, resultZ, count, false);
+}
+
+void BatchTransform::transform(const double *x, const double *y, const double *z,
+                               double *resultX, double *resultY, double *resultZ, int count, bool translate) const
+{
+    const double tx = translate ? _m[3] : 0.0;
+    const double ty = translate ? _m[7] : 0.0;
+    const double tz = translate ? _m[11] : 0.0;
+
+    int i = 0;
+
+#ifdef BATCHTRANSFORM_AVX2
+    const __m256d m00 = _mm256_set1_pd(_m[0]);
+    const __m256d m01 = _mm256_set1_pd(_m[1]);
+    const __m256d m02 = _mm256_set1_pd(_m[2]);
+    const __m256d m10 = _mm256_set1_pd(_m[4]);
+    const __m256d m11 = _mm256_set1_pd(_m[5]);
+    const __m256d m12 = _mm256_set1_pd(_m[6]);
+    const __m256d m20 = _mm256_set1_pd(_m[8]);
+    const __m256d m21 = _mm256_set1_pd(_m[9]);
+    const __m256d m22 = _mm256_set1_pd(_m[10]);
+    const __m256d t0 = _mm256_set1_pd(tx);
+    const __m256d t1 = _mm256_set1_pd(ty);
+    const __m256d t2 = _mm256_set1_pd(tz);
+
+    for (; i + 4 <= count; i += 4) {
+        // 先读入再写出, 输入输出是同一组数组时也正确
+        __m256d vx = _mm256_loadu_pd(x + i);
+        __m256d vy = _mm256_loadu_pd(y + i);
+        __m256d vz = _mm256_loadu_pd(z + i);
+
+        __m256d rx = _mm256_fmadd_pd(m02, vz, _mm256_fmadd_pd(m01, vy, _mm256_fmadd_pd(m00, vx, t0)));
+        __m256d ry = _mm256_fmadd_pd(m12, vz, _mm256_fmadd_pd(m11, vy, _mm256_fmadd_pd(m10, vx, t1)));
+        __m256d rz = _mm256_fmadd_pd(m22, vz, _mm256_fmadd_pd(m21, vy, _mm256_fmadd_pd(m20, vx, t2)));
+
+        _mm256_storeu_pd(resultX + i, rx);
+        _mm256_storeu_pd(resultY + i, ry);
+        _mm256_storeu_pd(resultZ + i, rz);
+    }
+#endif
+
+    for (; i < count; ++i) {
+        double vx = x[i];
+        double vy = y[i];
+        double vz = z[i];
+
+        resultX[i] = _m[0] * vx + _m[1] * vy + _m[2] * vz + tx;
+        resultY[i] = _m[4] * vx + _m[5] * vy + _m[6] * vz + ty;
+        resultZ[i] = _m[8] * vx + _m[9] * vy + _m[10] * vz + tz;
+    }
+}
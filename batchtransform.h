@@ -0,0 +1,85 @@
+#ifndef BATCHTRANSFORM_H
+#define BATCHTRANSFORM_H
+
+#include "sscc_global.h"
+#include "cartesian3.h"
+#include "matrix4.h"
+
+/**
+ * @brief 刚体变换 (旋转 + 平移), 用于批量变换SoA数组 (x, y, z分别存放) 中的点和向量
+ *
+ * 编译时开启AVX2和FMA (qmake: CONFIG += avx2) 时每次处理4个点, 否则使用普通循环.
+ * 输入和输出可以是同一组数组, 但不能部分重叠
+ */
+class CONTROLLER_EXPORT BatchTransform
+{
+public:
+    /**
+     * @brief 默认构造 (单位变换)
+     *
+     */
+    BatchTransform();
+
+    /**
+     * @brief 由4×4矩阵构造, 只使用前三行 (矩阵必须是仿射变换)
+     *
+     * @param matrix 4×4矩阵 (列主序, 与CameraController::multiplyByPoint相同)
+     * @return BatchTransform 变换
+     */
+    static BatchTransform fromMatrix(const Matrix4 &matrix);
+
+    /**
+     * @brief 构造从世界坐标到相机局部坐标的变换, 原点为相机位置, x: right, y: direction, z: up
+     *
+     * @param position 相机位置 (世界坐标)
+     * @param right 相机的x轴方向 (世界坐标, 单位向量)
+     * @param direction 相机的y轴方向 (世界坐标, 单位向量)
+     * @param up 相机的z轴方向 (世界坐标, 单位向量)
+     * @return BatchTransform 变换
+     */
+    static BatchTransform fromCameraAxes(const Cartesian3 &position, const Cartesian3 &right, const Cartesian3 &direction, const Cartesian3 &up);
+
+    /**
+     * @brief 变换一个点
+     *
+     * @param point 点
+     * @return Cartesian3 变换后的点
+     */
+    Cartesian3 transformPoint(const Cartesian3 &point) const;
+
+    /**
+     * @brief 批量变换点
+     *
+     * @param x 输入的x数组
+     * @param y 输入的y数组
+     * @param z 输入的z数组
+     * @param resultX 输出的x数组
+     * @param resultY 输出的y数组
+     * @param resultZ 输出的z数组
+     * @param count 点的数量
+     */
+    void transformPoints(const double *x, const double *y, const double *z,
+                         double *resultX, double *resultY, double *resultZ, int count) const;
+
+    /**
+     * @brief 批量变换向量 (不平移)
+     *
+     * @param x 输入的x数组
+     * @param y 输入的y数组
+     * @param z 输入的z数组
+     * @param resultX 输出的x数组
+     * @param resultY 输出的y数组
+     * @param resultZ 输出的z数组
+     * @param count 向量的数量
+     */
+    void transformVectors(const double *x, const double *y, const double *z,
+                          double *resultX, double *resultY, double *resultZ, int count) const;
+
+private:
+    void transform(const double *x, const double *y, const double *z,
+                   double *resultX, double *resultY, double *resultZ, int count, bool translate) const;
+
+    double _m[12]; ///< 3×4矩阵, 行主序: 第i行为 _m[4i], _m[4i+1], _m[4i+2], 平移 _m[4i+3]
+};
+
+#endif // BATCHTRANSFORM_H
@@ -0,0 +1,61 @@
+#-------------------------------------------------
+#
+# Microbenchmarks for the ScreenSpaceCameraController kernels
+#
+#-------------------------------------------------
+
+QT += testlib
+QT -= gui
+
+TEMPLATE = app
+TARGET = sscc_benchmarks
+CONFIG += console c++14
+CONFIG -= app_bundle
+
+gcc|clang: QMAKE_CXXFLAGS += -fno-math-errno
+
+avx2 {
+    msvc: QMAKE_CXXFLAGS += /arch:AVX2
+    else: QMAKE_CXXFLAGS += -mavx2 -mfma
+}
+
+# CameraController is taken from the library, the unexported kernels are compiled in below
+win32:CONFIG(release, debug|release) : {
+    LIBS += -L$$PWD/../../x64/release/ -llicore -lScreenSpaceCameraController
+} else : win32:CONFIG(debug, debug|release) : {
+    LIBS += -L$$PWD/../../x64/debug/ -llicored -lScreenSpaceCameraController
+}
+
+INCLUDEPATH += $$PWD/.. $$PWD/../../licore/include
+
+SOURCES += \
+        main.cpp \
+        easingbenchmark.cpp \
+        grazingbenchmark.cpp \
+        intersectionbenchmark.cpp \
+        polynomialbenchmark.cpp \
+        cameramathbenchmark.cpp \
+        pickbenchmark.cpp \
+        controllerbenchmark.cpp \
+        camerapathbenchmark.cpp \
+        ../tweenjs.cpp \
+        ../cesiummath.cpp \
+        ../ellipsoidgeodesic.cpp \
+        ../intersectiontests.cpp \
+        ../quadraticrealpolynomial.cpp \
+        ../cubicrealpolynomial.cpp \
+        ../quarticrealpolynomial.cpp
+
+HEADERS += \
+        easingbenchmark.h \
+        grazingbenchmark.h \
+        intersectionbenchmark.h \
+        polynomialbenchmark.h \
+        cameramathbenchmark.h \
+        pickbenchmark.h \
+        controllerbenchmark.h \
+        camerapathbenchmark.h \
+        benchmarkutils.h
+
+DISTFILES += \
+        compare_baseline.py
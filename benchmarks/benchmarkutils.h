@@ -0,0 +1,47 @@
+#ifndef BENCHMARKUTILS_H
+#define BENCHMARKUTILS_H
+
+#include <random>
+#include "cartesian3.h"
+
+/**
+ * @brief 基准测试的公共数据生成函数, 所有输入都由固定的随机种子生成, 保证每次运行的数据相同
+ *
+ */
+namespace BenchmarkUtils {
+
+const unsigned int RANDOM_SEED = 20190219u;
+
+/**
+ * @brief 创建随机数生成器, 不同的测试使用不同的stream, 互不影响
+ *
+ * @param stream 数据流编号
+ * @return std::mt19937 随机数生成器
+ */
+inline std::mt19937 generator(unsigned int stream)
+{
+    std::seed_seq seed{ RANDOM_SEED, stream };
+    return std::mt19937(seed);
+}
+
+/**
+ * @brief 生成均匀分布在单位球面上的方向
+ *
+ * @param engine 随机数生成器
+ * @return Cartesian3 单位向量
+ */
+inline Cartesian3 unitVector(std::mt19937 &engine)
+{
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    for (;;) {
+        Cartesian3 v(unit(engine), unit(engine), unit(engine));
+        double magnitudeSquared = v.magnitudeSquared();
+        if (magnitudeSquared > 1e-6 && magnitudeSquared <= 1.0) {
+            return v.normalize();
+        }
+    }
+}
+
+}
+
+#endif // BENCHMARKUTILS_H
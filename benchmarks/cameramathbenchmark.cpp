@@ -0,0 +1,185 @@
+#include "cameramathbenchmark.h"
+#include "ellipsoidgeodesic.h"
+#include "cesiummath.h"
+#include "cameracontroller.h"
+#include "batchtransform.h"
+#include "windowprojection.h"
+#include "cullingvolume.h"
+#include "ellipsoidaloccluder.h"
+#include "ellipsoid.h"
+#include "benchmarkutils.h"
+#include <QtTest>
+
+namespace {
+const int SAMPLE_COUNT = 1024;
+const int POINT_COUNT = 16384;
+
+BatchTransform viewTransform()
+{
+    Cartesian3 position(-2187000.0, 4386000.0, 4070000.0);
+    Cartesian3 direction = (position * -1.0).normalize();
+    Cartesian3 right = Cartesian3::cross(direction, Cartesian3::UNIT_Z).normalize();
+    Cartesian3 up = Cartesian3::cross(right, direction);
+    return BatchTransform::fromCameraAxes(position, right, direction, up);
+}
+}
+
+void CameraMathBenchmark::initTestCase()
+{
+    std::mt19937 generator = BenchmarkUtils::generator(5);
+    std::uniform_real_distribution<double> longitude(-M_PI, M_PI);
+    std::uniform_real_distribution<double> latitude(-M_PI_2 * 0.98, M_PI_2 * 0.98);
+    std::uniform_real_distribution<double> angle(0.0, 2.0 * M_PI);
+    std::uniform_real_distribution<double> pitch(-M_PI_2, M_PI_2);
+    std::uniform_real_distribution<double> extent(0.0001, 0.5);
+
+    _starts.clear();
+    _ends.clear();
+    _angles.clear();
+    _rectangles.clear();
+    for (int i = 0; i < SAMPLE_COUNT; ++i) {
+        _starts.append(Cartographic(longitude(generator), latitude(generator), 0.0));
+        _ends.append(Cartographic(longitude(generator), latitude(generator), 0.0));
+
+        _angles << angle(generator) << pitch(generator) << angle(generator);
+
+        LiRectangle rectangle;
+        rectangle.west = longitude(generator);
+        rectangle.south = std::max(latitude(generator), -M_PI_2 + 0.6);
+        rectangle.east = rectangle.west + extent(generator);
+        rectangle.north = std::min(rectangle.south + extent(generator), M_PI_2);
+        if (rectangle.east > M_PI) {
+            rectangle.east -= 2.0 * M_PI;
+        }
+        _rectangles.append(rectangle);
+    }
+
+    std::uniform_real_distribution<double> coordinate(-6.4e6, 6.4e6);
+    _x.resize(POINT_COUNT);
+    _y.resize(POINT_COUNT);
+    _z.resize(POINT_COUNT);
+    for (int i = 0; i < POINT_COUNT; ++i) {
+        _x[i] = coordinate(generator);
+        _y[i] = coordinate(generator);
+        _z[i] = coordinate(generator);
+    }
+}
+
+void CameraMathBenchmark::geodesicSetEndPoints()
+{
+    EllipsoidGeodesic geodesic;
+    QBENCHMARK {
+        for (int i = 0; i < _starts.length(); ++i) {
+            geodesic.setEndPoints(_starts[i], _ends[i]);
+        }
+    }
+}
+
+void CameraMathBenchmark::geodesicInterpolateUsingFraction()
+{
+    EllipsoidGeodesic geodesic;
+    geodesic.setEndPoints(_starts[0], _ends[0]);
+
+    double sum = 0.0;
+    QBENCHMARK {
+        for (int i = 0; i < SAMPLE_COUNT; ++i) {
+            sum += geodesic.interpolateUsingFraction(static_cast<double>(i) / SAMPLE_COUNT).latitude;
+        }
+    }
+    QVERIFY(sum == sum);
+}
+
+void CameraMathBenchmark::fromHeadingPitchRoll()
+{
+    double sum = 0.0;
+    QBENCHMARK {
+        for (int i = 0; i < _angles.length(); i += 3) {
+            sum += CesiumMath::fromHeadingPitchRoll(_angles[i], _angles[i + 1], _angles[i + 2]).toRotationMatrix()[0];
+        }
+    }
+    QVERIFY(sum == sum);
+}
+
+void CameraMathBenchmark::rectangleCameraPosition3D()
+{
+    double sum = 0.0;
+    QBENCHMARK {
+        for (const LiRectangle &rectangle : _rectangles) {
+            sum += CameraController::rectangleCameraPosition3D(rectangle, 60.0, 16.0 / 9.0).x;
+        }
+    }
+    QVERIFY(sum == sum);
+}
+
+void CameraMathBenchmark::transformPointsScalar()
+{
+    // one point at a time through Cartesian3, the way worldToCameraCoordinates(Cartesian3 &) is used
+    BatchTransform transform = viewTransform();
+    QVector<Cartesian3> results(POINT_COUNT);
+    QBENCHMARK {
+        for (int i = 0; i < POINT_COUNT; ++i) {
+            results[i] = transform.transformPoint(Cartesian3(_x[i], _y[i], _z[i]));
+        }
+    }
+    QVERIFY(results[0].x == results[0].x);
+}
+
+void CameraMathBenchmark::transformPointsBatch()
+{
+    BatchTransform transform = viewTransform();
+    QVector<double> x(POINT_COUNT);
+    QVector<double> y(POINT_COUNT);
+    QVector<double> z(POINT_COUNT);
+    QBENCHMARK {
+        transform.transformPoints(_x.constData(), _y.constData(), _z.constData(), x.data(), y.data(), z.data(), POINT_COUNT);
+    }
+
+    Cartesian3 expected = transform.transformPoint(Cartesian3(_x[0], _y[0], _z[0]));
+    QVERIFY(qAbs(expected.x - x[0]) < 1e-6 && qAbs(expected.y - y[0]) < 1e-6 && qAbs(expected.z - z[0]) < 1e-6);
+}
+
+void CameraMathBenchmark::projectToWindowBatch()
+{
+    WindowProjection projection(viewTransform(), 60.0, 16.0 / 9.0, 1.0, 1920, 1080);
+    QVector<double> windowX(POINT_COUNT);
+    QVector<double> windowY(POINT_COUNT);
+    QVector<quint8> flags(POINT_COUNT);
+    QBENCHMARK {
+        projection.project(_x.constData(), _y.constData(), _z.constData(), windowX.data(), windowY.data(), flags.data(), POINT_COUNT);
+    }
+
+    int expectedFlags = 0;
+    Cartesian2 expected = projection.project(Cartesian3(_x[0], _y[0], _z[0]), &expectedFlags);
+    QCOMPARE(int(flags[0]), expectedFlags);
+    QVERIFY(qAbs(expected.x - windowX[0]) < 1e-6);
+}
+
+void CameraMathBenchmark::cullingVolumeBatch()
+{
+    Cartesian3 position(-2187000.0, 4386000.0, 4070000.0);
+    Cartesian3 direction = (position * -1.0).normalize();
+    Cartesian3 right = Cartesian3::cross(direction, Cartesian3::UNIT_Z).normalize();
+    Cartesian3 up = Cartesian3::cross(right, direction);
+    CullingVolume volume(position, direction, up, right, 60.0, 16.0 / 9.0, 1.0, 5.0e7);
+
+    QVector<double> radius(POINT_COUNT, 50000.0);
+    QVector<qint8> results(POINT_COUNT);
+    QBENCHMARK {
+        volume.computeVisibility(_x.constData(), _y.constData(), _z.constData(), radius.constData(), results.data(), POINT_COUNT);
+    }
+
+    QCOMPARE(int(results[0]), int(volume.computeVisibility(Cartesian3(_x[0], _y[0], _z[0]), radius[0])));
+}
+
+void CameraMathBenchmark::horizonOcclusionBatch()
+{
+    EllipsoidalOccluder occluder(Ellipsoid::WGS84(), Cartesian3(-2187000.0, 4386000.0, 4070000.0) * 1.5);
+
+    QVector<double> radius(POINT_COUNT, 50000.0);
+    QVector<quint8> visible(POINT_COUNT);
+    QBENCHMARK {
+        occluder.isBoundingSphereVisible(_x.constData(), _y.constData(), _z.constData(), radius.constData(), visible.data(), POINT_COUNT);
+    }
+
+    QCOMPARE(bool(visible[0]), occluder.isBoundingSphereVisible(Cartesian3(_x[0], _y[0], _z[0]), radius[0]));
+}
@@ -0,0 +1,40 @@
+#ifndef CAMERAMATHBENCHMARK_H
+#define CAMERAMATHBENCHMARK_H
+
+#include <QObject>
+#include <QVector>
+#include "cartographic.h"
+#include "rectangle.h"
+
+/**
+ * @brief 测地线, heading/pitch/roll转四元数, 矩形范围相机位置, 批量坐标变换, 投影, 包围球裁剪和地平线遮挡的基准测试
+ *
+ */
+class CameraMathBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void geodesicSetEndPoints();
+    void geodesicInterpolateUsingFraction();
+    void fromHeadingPitchRoll();
+    void rectangleCameraPosition3D();
+    void transformPointsScalar();
+    void transformPointsBatch();
+    void projectToWindowBatch();
+    void cullingVolumeBatch();
+    void horizonOcclusionBatch();
+
+private:
+    QVector<Cartographic> _starts;
+    QVector<Cartographic> _ends;
+    QVector<double> _angles; ///< 每3个为一组heading/pitch/roll
+    QVector<LiRectangle> _rectangles;
+    QVector<double> _x; ///< 变换用的点 (SoA)
+    QVector<double> _y;
+    QVector<double> _z;
+};
+
+#endif // CAMERAMATHBENCHMARK_H
@@ -0,0 +1,127 @@
+#include "camerapathbenchmark.h"
+#include "camerapathfile.h"
+#include <QtTest>
+#include <functional>
+#include <random>
+
+namespace {
+const int RECORD_COUNT = 100000;
+const quint32 INDEX_STRIDE = 64;
+const int SAMPLE_COUNT = 10000;
+
+/**
+ * @brief 写入一个合法的路径文件, 返回文件内容
+ *
+ */
+QByteArray writePath(const QString &fileName)
+{
+    CameraPathWriter writer;
+    writer.open(fileName, false, INDEX_STRIDE);
+    for (int i = 0; i < RECORD_COUNT; ++i) {
+        writer.append(i * 0.1, Cartesian3(-2358415.0 + i, 5382639.0, 2492975.0), 0.0, -M_PI / 2.0, 0.0);
+    }
+    writer.close();
+
+    QFile file(fileName);
+    file.open(QIODevice::ReadOnly);
+    return file.readAll();
+}
+
+QByteArray withHeader(QByteArray contents, const std::function<void(CameraPathHeader &)> &modify)
+{
+    CameraPathHeader header;
+    memcpy(&header, contents.constData(), sizeof(header));
+    modify(header);
+    memcpy(contents.data(), &header, sizeof(header));
+    return contents;
+}
+
+}
+
+void CameraPathBenchmark::openInvalid_data()
+{
+    QTest::addColumn<QByteArray>("contents");
+    QTest::addColumn<bool>("valid");
+
+    QTemporaryDir dir;
+    QByteArray contents = writePath(dir.filePath(QStringLiteral("path.bin")));
+
+    QTest::newRow("valid") << contents << true;
+    QTest::newRow("truncated record") << contents.left(int(sizeof(CameraPathHeader)) + 1000) << false;
+    QTest::newRow("truncated index") << contents.left(contents.size() - 8) << false;
+
+    // count * recordSize和indexCount * 8都溢出成很小的值
+    QTest::newRow("wrapping count") << withHeader(contents, [](CameraPathHeader &header) {
+        header.count = (quint64(1) << 62) + 1;
+        header.indexStride = 1;
+        header.indexCount = header.count;
+    }) << false;
+
+    // recordsOffset + count * recordSize溢出
+    QTest::newRow("wrapping records offset") << withHeader(contents, [](CameraPathHeader &header) {
+        header.recordsOffset = ~quint64(7);
+    }) << false;
+
+    // indexOffset + indexCount * 8溢出
+    QTest::newRow("wrapping index offset") << withHeader(contents, [](CameraPathHeader &header) {
+        header.indexOffset = ~quint64(7);
+    }) << false;
+
+    // 没有索引时seek找不到所在的块
+    QTest::newRow("zero index stride") << withHeader(contents, [](CameraPathHeader &header) {
+        header.indexStride = 0;
+        header.indexCount = 0;
+    }) << false;
+
+    // count + indexStride - 1溢出
+    QTest::newRow("wrapping index stride") << withHeader(contents, [](CameraPathHeader &header) {
+        header.count = ~quint64(0);
+        header.indexStride = 0xFFFFFFFF;
+        header.indexCount = 0;
+    }) << false;
+}
+
+void CameraPathBenchmark::openInvalid()
+{
+    QFETCH(QByteArray, contents);
+    QFETCH(bool, valid);
+
+    QTemporaryDir dir;
+    QString fileName = dir.filePath(QStringLiteral("path.bin"));
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(contents);
+    file.close();
+
+    CameraPathFile path;
+    QCOMPARE(path.open(fileName), valid);
+    if (valid) {
+        QCOMPARE(path.count(), qint64(RECORD_COUNT));
+    }
+}
+
+void CameraPathBenchmark::sample()
+{
+    QTemporaryDir dir;
+    QString fileName = dir.filePath(QStringLiteral("path.bin"));
+    writePath(fileName);
+
+    CameraPathFile path;
+    QVERIFY(path.open(fileName));
+
+    // 每次迭代SAMPLE_COUNT次随机时间的查找
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<double> time(path.startTime(), path.endTime());
+    QVector<double> times(SAMPLE_COUNT);
+    for (double &t : times) {
+        t = time(generator);
+    }
+
+    double sum = 0.0;
+    QBENCHMARK {
+        for (double t : times) {
+            sum += path.sample(t).position.x;
+        }
+    }
+    QVERIFY(sum != 0.0);
+}
@@ -0,0 +1,21 @@
+#ifndef CAMERAPATHBENCHMARK_H
+#define CAMERAPATHBENCHMARK_H
+
+#include <QObject>
+
+/**
+ * @brief CameraPathFile的文件头校验 (截断和溢出的文件头) 和查找基准测试
+ *
+ */
+class CameraPathBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void openInvalid_data();
+    void openInvalid();
+
+    void sample();
+};
+
+#endif // CAMERAPATHBENCHMARK_H
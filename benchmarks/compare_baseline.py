@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+"""Compare two runs of sscc_benchmarks and flag regressions.
+
+Record a run with
+
+    sscc_benchmarks --output-dir results/baseline -median 5
+    sscc_benchmarks --output-dir results/current -median 5
+
+and compare them with
+
+    compare_baseline.py results/baseline results/current --threshold 0.10
+
+Every <Class>.xml written by QTest is read; each BenchmarkResult is keyed by
+class, function and data tag. QTest reports the value per iteration, so runs
+with different iteration counts are comparable. The script prints one CSV line
+per benchmark and exits with status 1 when any benchmark got slower than the
+baseline by more than the threshold.
+"""
+
+import argparse
+import csv
+import glob
+import os
+import sys
+import xml.etree.ElementTree as ElementTree
+
+
+def load(directory):
+    results = {}
+    for path in sorted(glob.glob(os.path.join(directory, "*.xml"))):
+        root = ElementTree.parse(path).getroot()
+        test_case = root.get("name") or os.path.splitext(os.path.basename(path))[0]
+        for function in root.iter("TestFunction"):
+            for result in function.iter("BenchmarkResult"):
+                key = (test_case, function.get("name"), result.get("tag", ""))
+                results[key] = (result.get("metric"), float(result.get("value")))
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline", help="directory with the baseline *.xml files")
+    parser.add_argument("current", help="directory with the *.xml files to check")
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="relative slowdown that counts as a regression (default 0.10)")
+    arguments = parser.parse_args()
+
+    baseline = load(arguments.baseline)
+    current = load(arguments.current)
+    if not baseline or not current:
+        sys.stderr.write("no benchmark results found\n")
+        return 2
+
+    writer = csv.writer(sys.stdout)
+    writer.writerow(["class", "function", "tag", "metric", "baseline", "current", "change", "status"])
+
+    regressions = 0
+    for key in sorted(set(baseline) | set(current)):
+        if key not in baseline or key not in current:
+            status = "missing-baseline" if key not in baseline else "missing-current"
+            metric, value = current.get(key) or baseline.get(key)
+            writer.writerow(list(key) + [metric, baseline.get(key, ("", ""))[1], current.get(key, ("", ""))[1], "", status])
+            continue
+
+        metric, old = baseline[key]
+        current_metric, new = current[key]
+        if metric != current_metric:
+            writer.writerow(list(key) + [metric + "/" + current_metric, old, new, "", "metric-mismatch"])
+            continue
+
+        change = (new - old) / old if old > 0.0 else 0.0
+        status = "ok"
+        if change > arguments.threshold:
+            status = "REGRESSION"
+            regressions += 1
+        elif change < -arguments.threshold:
+            status = "improved"
+        writer.writerow(list(key) + [metric, "%.6g" % old, "%.6g" % new, "%+.1f%%" % (change * 100.0), status])
+
+    if regressions:
+        sys.stderr.write("%d benchmark(s) regressed by more than %.0f%%\n" % (regressions, arguments.threshold * 100.0))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,165 @@
+#include "controllerbenchmark.h"
+#include "screenspacecameracontroller.h"
+#include "cameraenvironment.h"
+#include "cameraclock.h"
+#include "camerasimulation.h"
+#include "ellipsoid.h"
+#include <QtTest>
+#include <QThreadPool>
+
+namespace {
+const int WIDTH = 1920;
+const int HEIGHT = 1080;
+const int STEP_COUNT = 1000;
+const qint64 FRAME_NANOSECONDS = 16666667;
+const int SCRIPT_COUNT = 64;
+const int SCRIPT_FRAME_COUNT = 200;
+const int WHEEL_TICK_COUNT = 30;
+
+/**
+ * @brief 统计拾取次数的地球
+ *
+ */
+class CountingCameraGlobe : public EllipsoidCameraGlobe
+{
+public:
+    explicit CountingCameraGlobe(Ellipsoid *ellipsoid) : EllipsoidCameraGlobe(ellipsoid) {}
+
+    void pick(const Ray &ray, Cartesian3 *result) override
+    {
+        ++picks;
+        EllipsoidCameraGlobe::pick(ray, result);
+    }
+
+    int picks = 0;
+};
+}
+
+void ControllerBenchmark::headlessUpdate_data()
+{
+    QTest::addColumn<bool>("moving");
+    QTest::newRow("idle") << false;
+    QTest::newRow("rotate + zoom") << true;
+}
+
+void ControllerBenchmark::headlessUpdate()
+{
+    QFETCH(bool, moving);
+
+    FixedCameraCanvas canvas(WIDTH, HEIGHT);
+    SimpleCameraRig camera;
+    camera.setFrustum(60.0, double(WIDTH) / HEIGHT, 1.0, 500000000.0);
+    EllipsoidCameraGlobe globe(Ellipsoid::WGS84());
+
+    CameraEnvironment environment;
+    environment.canvas = &canvas;
+    environment.globe = &globe;
+    environment.camera = &camera;
+
+    ScreenSpaceCameraController controller(environment);
+    ManualCameraClock clock;
+    controller.setClock(&clock);
+    controller.setView(Cartesian3(-2358415.0, 5382639.0, 2492975.0) * 1.5, 0.0, -M_PI / 2.0, 0.0);
+
+    CameraCommandBuffer commands;
+    commands.rotateRight(0.001).zoomIn(100.0);
+
+    // 每次迭代STEP_COUNT帧
+    QBENCHMARK {
+        for (int i = 0; i < STEP_COUNT; ++i) {
+            if (moving) {
+                controller.submitCommands(commands);
+            }
+            clock.advance(FRAME_NANOSECONDS);
+            controller.update();
+        }
+    }
+}
+
+void ControllerBenchmark::simulationScaling_data()
+{
+    QTest::addColumn<int>("threads");
+    int idealThreadCount = QThread::idealThreadCount();
+    for (int threads = 1; threads <= 8; threads *= 2) {
+        if (threads > 1 && threads > idealThreadCount) {
+            break;
+        }
+        QTest::newRow(qPrintable(QString("%1 threads").arg(threads))) << threads;
+    }
+}
+
+void ControllerBenchmark::simulationScaling()
+{
+    QFETCH(int, threads);
+
+    // 每条轨迹的起点和旋转方向不同
+    QVector<CameraSimulationScript> scripts(SCRIPT_COUNT);
+    for (int i = 0; i < SCRIPT_COUNT; ++i) {
+        CameraSimulationScript &script = scripts[i];
+        script.destination = Cartesian3(-2358415.0, 5382639.0, 2492975.0) * (1.2 + 0.01 * i);
+        script.heading = 2.0 * M_PI * i / SCRIPT_COUNT;
+
+        CameraCommandBuffer commands;
+        commands.rotateRight(0.0005 * (i % 4 + 1)).zoomIn(50.0);
+        script.frames.fill(commands, SCRIPT_FRAME_COUNT);
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+
+    // 每次迭代SCRIPT_COUNT条轨迹, 每条SCRIPT_FRAME_COUNT帧
+    QBENCHMARK {
+        QVector<QVector<CameraState>> results = CameraSimulation::run(scripts, CameraSimulationOptions(), &pool);
+        QCOMPARE(results.size(), SCRIPT_COUNT);
+    }
+}
+
+void ControllerBenchmark::wheelBurstPicks_data()
+{
+    QTest::addColumn<double>("tolerance");
+    QTest::addColumn<bool>("reuse");
+    QTest::newRow("reuse anchor") << 8.0 << true;
+    QTest::newRow("re-pick") << 0.0 << false;
+}
+
+void ControllerBenchmark::wheelBurstPicks()
+{
+    QFETCH(double, tolerance);
+    QFETCH(bool, reuse);
+
+    FixedCameraCanvas canvas(WIDTH, HEIGHT);
+    SimpleCameraRig camera;
+    camera.setFrustum(60.0, double(WIDTH) / HEIGHT, 1.0, 500000000.0);
+    CountingCameraGlobe globe(Ellipsoid::WGS84());
+
+    CameraEnvironment environment;
+    environment.canvas = &canvas;
+    environment.globe = &globe;
+    environment.camera = &camera;
+
+    ScreenSpaceCameraController controller(environment);
+    ManualCameraClock clock;
+    controller.setClock(&clock);
+    controller.setZoomAnchorTolerance(tolerance);
+    // 整个过程都高于_minimumPickingTerrainHeight, zoom3D不拾取, 只统计handleZoom的锚点和屏幕中心拾取
+    controller.setView(Cartesian3(-2358415.0, 5382639.0, 2492975.0).normalized() * (6378137.0 + 1500000.0),
+                       0.0, -M_PI / 2.0, 0.0);
+    clock.advance(FRAME_NANOSECONDS);
+    controller.update();
+
+    // 鼠标在屏幕中心附近抖动1像素, 每帧一个小的滚轮刻度 (每帧缩放约5%)
+    globe.picks = 0;
+    for (int i = 0; i < WHEEL_TICK_COUNT; ++i) {
+        controller.handleWheel(Cartesian2(WIDTH / 2 + i % 2, HEIGHT / 2), 10);
+        clock.advance(FRAME_NANOSECONDS);
+        controller.update();
+    }
+    qInfo("%d wheel ticks, %d picks", WHEEL_TICK_COUNT, globe.picks);
+
+    if (reuse) {
+        // 第一帧拾取锚点和屏幕中心, 之后沿用
+        QVERIFY(globe.picks < WHEEL_TICK_COUNT);
+    } else {
+        QVERIFY(globe.picks >= 2 * WHEEL_TICK_COUNT);
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef CONTROLLERBENCHMARK_H
+#define CONTROLLERBENCHMARK_H
+
+#include <QObject>
+
+/**
+ * @brief 不依赖LiWidget和GlobalViewer的ScreenSpaceCameraController::update基准测试 (离线生成相机轨迹)
+ *
+ */
+class ControllerBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void headlessUpdate_data();
+    void headlessUpdate();
+    void simulationScaling_data();
+    void simulationScaling();
+    void wheelBurstPicks_data();
+    void wheelBurstPicks();
+};
+
+#endif // CONTROLLERBENCHMARK_H
@@ -0,0 +1,117 @@
+#include "easingbenchmark.h"
+#include "tweenjs.h"
+#include "benchmarkutils.h"
+#include <QtTest>
+
+namespace {
+const int SAMPLE_COUNT = 4096;
+}
+
+void EasingBenchmark::initTestCase()
+{
+    std::mt19937 generator = BenchmarkUtils::generator(1);
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+
+    _samples.resize(SAMPLE_COUNT);
+    for (int i = 0; i < SAMPLE_COUNT; ++i) {
+        _samples[i] = distribution(generator);
+    }
+}
+
+void EasingBenchmark::stdFunction_data()
+{
+    QTest::addColumn<int>("type");
+    QTest::newRow("CubicOut") << (int)EasingType::CubicOut;
+    QTest::newRow("QuinticInOut") << (int)EasingType::QuinticInOut;
+}
+
+void EasingBenchmark::stdFunction()
+{
+    QFETCH(int, type);
+
+    // the path used before the easing library: a capturing lambda wrapped in a std::function,
+    // called through another std::function stored in TweenJS
+    TweenAction1Double inner;
+    if (type == EasingType::CubicOut) {
+        inner = [=](double k) {
+            return TweenJS::EasingCubicOut(k);
+        };
+    } else {
+        inner = [=](double k) {
+            return TweenJS::EasingQuinticInOut(k);
+        };
+    }
+    TweenAction1Double outer = [=](double k) {
+        return inner(k);
+    };
+
+    double sum = 0.0;
+    QBENCHMARK {
+        for (double k : _samples) {
+            sum += outer(k);
+        }
+    }
+    QVERIFY(sum > 0.0);
+}
+
+void EasingBenchmark::enumDispatch_data()
+{
+    QTest::addColumn<int>("type");
+    for (int i = 0; i < EasingType::TypeCount; ++i) {
+        QTest::newRow(QByteArray::number(i).constData()) << i;
+    }
+}
+
+void EasingBenchmark::enumDispatch()
+{
+    QFETCH(int, type);
+    EasingType::Type easingType = (EasingType::Type)type;
+
+    double sum = 0.0;
+    QBENCHMARK {
+        for (double k : _samples) {
+            sum += Easing::ease(easingType, k);
+        }
+    }
+    QVERIFY(sum == sum);
+}
+
+void EasingBenchmark::templateDispatch()
+{
+    double sum = 0.0;
+    QBENCHMARK {
+        for (double k : _samples) {
+            sum += Easing::ease<EasingType::QuinticInOut>(k);
+        }
+    }
+    QVERIFY(sum > 0.0);
+}
+
+void EasingBenchmark::tweenUpdate_data()
+{
+    QTest::addColumn<bool>("useFunction");
+    QTest::newRow("function") << true;
+    QTest::newRow("enum") << false;
+}
+
+void EasingBenchmark::tweenUpdate()
+{
+    QFETCH(bool, useFunction);
+
+    TweenJS tween(0.0);
+    tween.to(1.0, 1000.0);
+    if (useFunction) {
+        tween.easing([=](double k) {
+            return TweenJS::EasingQuinticInOut(k);
+        });
+    } else {
+        tween.easing(EasingType::QuinticInOut);
+    }
+    tween.start(0.0);
+
+    QBENCHMARK {
+        for (double k : _samples) {
+            tween.update(k * 999.0);
+        }
+    }
+}
@@ -0,0 +1,30 @@
+#ifndef EASINGBENCHMARK_H
+#define EASINGBENCHMARK_H
+
+#include <QObject>
+#include <QVector>
+
+/**
+ * @brief 比较插值函数的三种调用方式: std::function, 枚举分发, 模板参数
+ *
+ */
+class EasingBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void stdFunction_data();
+    void stdFunction();
+    void enumDispatch_data();
+    void enumDispatch();
+    void templateDispatch();
+    void tweenUpdate_data();
+    void tweenUpdate();
+
+private:
+    QVector<double> _samples;
+};
+
+#endif // EASINGBENCHMARK_H
@@ -0,0 +1,106 @@
+#include "grazingbenchmark.h"
+#include "intersectiontests.h"
+#include "screenspaceeventutils.h"
+#include "ellipsoid.h"
+#include "benchmarkutils.h"
+#include <QtTest>
+
+namespace {
+const int RAY_COUNT = 1024;
+}
+
+void GrazingBenchmark::initTestCase()
+{
+    // rays looking past the globe from 100 km to 100000 km, the case tilt3DOnEllipsoid hits every frame
+    std::mt19937 generator = BenchmarkUtils::generator(2);
+    std::uniform_real_distribution<double> exponent(5.0, 8.0);
+
+    Ellipsoid *ellipsoid = Ellipsoid::WGS84();
+    _rays.clear();
+    while (_rays.length() < RAY_COUNT) {
+        Cartesian3 origin = BenchmarkUtils::unitVector(generator) * (ellipsoid->maximumRadius() + pow(10.0, exponent(generator)));
+        Cartesian3 direction = BenchmarkUtils::unitVector(generator);
+        if (Cartesian3::dot(direction, origin) >= 0.0) {
+            direction = direction * -1.0;
+        }
+
+        Ray ray;
+        ray.origin = origin;
+        ray.direction = direction;
+        if (defined(IntersectionTests::rayEllipsoid(ray, ellipsoid))) {
+            continue;
+        }
+
+        _rays.append(ray);
+    }
+}
+
+void GrazingBenchmark::accuracy()
+{
+    Ellipsoid *ellipsoid = Ellipsoid::WGS84();
+
+    double maximumSurfaceDistance = 0.0;
+    double sumSurfaceDistance = 0.0;
+    double maximumHeightDifference = 0.0;
+
+    for (const Ray &ray : _rays) {
+        Cartesian3 general = IntersectionTests::grazingAltitudeLocationGeneral(ray, ellipsoid);
+        Cartesian3 specialized = IntersectionTests::grazingAltitudeLocation(ray, ellipsoid);
+
+        // tilt3DOnEllipsoid only uses the surface point under the grazing location
+        Cartographic generalCart = ellipsoid->cartesianToCartographic(general);
+        Cartographic specializedCart = ellipsoid->cartesianToCartographic(specialized);
+        double heightDifference = specializedCart.height - generalCart.height;
+        generalCart.height = 0.0;
+        specializedCart.height = 0.0;
+
+        double surfaceDistance = (ellipsoid->cartographicToCartesian(generalCart) - ellipsoid->cartographicToCartesian(specializedCart)).magnitude();
+        maximumSurfaceDistance = std::max(maximumSurfaceDistance, surfaceDistance);
+        sumSurfaceDistance += surfaceDistance;
+        maximumHeightDifference = std::max(maximumHeightDifference, heightDifference);
+    }
+
+    qInfo("surface distance to the general solution: max %.3f m, mean %.3f m", maximumSurfaceDistance, sumSurfaceDistance / _rays.length());
+    qInfo("altitude above the general solution: max %.6f m", maximumHeightDifference);
+
+    // the specialized solver minimizes the geodetic altitude itself, it must never be higher than the general one
+    // (1 mm allows for the rounding of cartesianToCartographic)
+    QVERIFY(maximumHeightDifference <= 0.001);
+}
+
+void GrazingBenchmark::triaxial()
+{
+    // the closed form only holds for rotational ellipsoids, other ellipsoids must get the general solution
+    Ellipsoid ellipsoid(6378137.0, 6370000.0, 6356752.3142451793);
+    for (const Ray &ray : _rays) {
+        Cartesian3 general = IntersectionTests::grazingAltitudeLocationGeneral(ray, &ellipsoid);
+        Cartesian3 specialized = IntersectionTests::grazingAltitudeLocation(ray, &ellipsoid);
+        QCOMPARE(specialized.x, general.x);
+        QCOMPARE(specialized.y, general.y);
+        QCOMPARE(specialized.z, general.z);
+    }
+}
+
+void GrazingBenchmark::general()
+{
+    Ellipsoid *ellipsoid = Ellipsoid::WGS84();
+    double sum = 0.0;
+    QBENCHMARK {
+        for (const Ray &ray : _rays) {
+            sum += IntersectionTests::grazingAltitudeLocationGeneral(ray, ellipsoid).x;
+        }
+    }
+    QVERIFY(sum == sum);
+}
+
+void GrazingBenchmark::specialized()
+{
+    Ellipsoid *ellipsoid = Ellipsoid::WGS84();
+    double sum = 0.0;
+    QBENCHMARK {
+        for (const Ray &ray : _rays) {
+            sum += IntersectionTests::grazingAltitudeLocation(ray, ellipsoid).x;
+        }
+    }
+    QVERIFY(sum == sum);
+}
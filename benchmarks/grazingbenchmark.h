@@ -0,0 +1,28 @@
+#ifndef GRAZINGBENCHMARK_H
+#define GRAZINGBENCHMARK_H
+
+#include <QObject>
+#include <QVector>
+#include "ray.h"
+
+/**
+ * @brief 比较IntersectionTests::grazingAltitudeLocation与通用算法的速度和精度
+ *
+ */
+class GrazingBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void accuracy();
+    void triaxial();
+    void general();
+    void specialized();
+
+private:
+    QVector<Ray> _rays;
+};
+
+#endif // GRAZINGBENCHMARK_H
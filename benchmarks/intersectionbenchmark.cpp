@@ -0,0 +1,130 @@
+#include "intersectionbenchmark.h"
+#include "intersectiontests.h"
+#include "screenspaceeventutils.h"
+#include "ellipsoid.h"
+#include "sphere.h"
+#include "plane.h"
+#include "benchmarkutils.h"
+#include <QtTest>
+
+namespace {
+const int RAY_COUNT = 1024;
+}
+
+void IntersectionBenchmark::initTestCase()
+{
+    std::mt19937 generator = BenchmarkUtils::generator(3);
+    std::uniform_real_distribution<double> exponent(3.0, 8.0);
+    std::uniform_real_distribution<double> fraction(0.0, 0.99);
+
+    Ellipsoid *ellipsoid = Ellipsoid::WGS84();
+    double radius = ellipsoid->maximumRadius();
+
+    _hitRays.clear();
+    _missRays.clear();
+    _insideRays.clear();
+    while (_hitRays.length() < RAY_COUNT || _missRays.length() < RAY_COUNT) {
+        Ray ray;
+        ray.origin = BenchmarkUtils::unitVector(generator) * (radius + pow(10.0, exponent(generator)));
+        ray.direction = BenchmarkUtils::unitVector(generator);
+
+        if (defined(IntersectionTests::rayEllipsoid(ray, ellipsoid))) {
+            if (_hitRays.length() < RAY_COUNT) {
+                _hitRays.append(ray);
+            }
+        } else if (_missRays.length() < RAY_COUNT) {
+            _missRays.append(ray);
+        }
+    }
+
+    for (int i = 0; i < RAY_COUNT; ++i) {
+        Ray ray;
+        ray.origin = BenchmarkUtils::unitVector(generator) * (ellipsoid->minimumRadius() * fraction(generator));
+        ray.direction = BenchmarkUtils::unitVector(generator);
+        _insideRays.append(ray);
+    }
+
+    _planePoints.clear();
+    _planeNormals.clear();
+    for (int i = 0; i < RAY_COUNT; ++i) {
+        _planePoints.append(BenchmarkUtils::unitVector(generator) * radius);
+        _planeNormals.append(BenchmarkUtils::unitVector(generator));
+    }
+}
+
+void IntersectionBenchmark::rayEllipsoid_data()
+{
+    QTest::addColumn<int>("kind");
+    QTest::newRow("hit") << 0;
+    QTest::newRow("miss") << 1;
+    QTest::newRow("inside") << 2;
+}
+
+void IntersectionBenchmark::rayEllipsoid()
+{
+    QFETCH(int, kind);
+    const QVector<Ray> &rays = kind == 0 ? _hitRays : (kind == 1 ? _missRays : _insideRays);
+
+    Ellipsoid *ellipsoid = Ellipsoid::WGS84();
+    double sum = 0.0;
+    QBENCHMARK {
+        for (const Ray &ray : rays) {
+            sum += IntersectionTests::rayEllipsoid(ray, ellipsoid).start;
+        }
+    }
+    QVERIFY(sum == sum);
+}
+
+void IntersectionBenchmark::raySphere_data()
+{
+    QTest::addColumn<int>("kind");
+    QTest::addColumn<bool>("temporaryEllipsoid");
+    QTest::newRow("hit-ellipsoid") << 0 << true;
+    QTest::newRow("hit-sphere") << 0 << false;
+    QTest::newRow("miss-ellipsoid") << 1 << true;
+    QTest::newRow("miss-sphere") << 1 << false;
+    QTest::newRow("inside-ellipsoid") << 2 << true;
+    QTest::newRow("inside-sphere") << 2 << false;
+}
+
+void IntersectionBenchmark::raySphere()
+{
+    QFETCH(int, kind);
+    QFETCH(bool, temporaryEllipsoid);
+    const QVector<Ray> &rays = kind == 0 ? _hitRays : (kind == 1 ? _missRays : _insideRays);
+
+    // 手势中每帧按拾取点的半径构造球面
+    double radius = Ellipsoid::WGS84()->maximumRadius();
+    double sum = 0.0;
+    if (temporaryEllipsoid) {
+        QBENCHMARK {
+            for (const Ray &ray : rays) {
+                Ellipsoid ellipsoid(radius, radius, radius);
+                sum += IntersectionTests::rayEllipsoid(ray, &ellipsoid).start;
+            }
+        }
+    } else {
+        QBENCHMARK {
+            for (const Ray &ray : rays) {
+                sum += IntersectionTests::raySphere(ray, Sphere(radius)).start;
+            }
+        }
+    }
+    QVERIFY(sum == sum);
+}
+
+void IntersectionBenchmark::rayPlane()
+{
+    QVector<Plane> planes;
+    for (int i = 0; i < _planePoints.length(); ++i) {
+        planes.append(Plane(_planePoints[i], _planeNormals[i]));
+    }
+
+    double sum = 0.0;
+    QBENCHMARK {
+        for (int i = 0; i < _hitRays.length(); ++i) {
+            sum += IntersectionTests::rayPlane(_hitRays[i], &planes[i]).x;
+        }
+    }
+    QVERIFY(sum == sum);
+}
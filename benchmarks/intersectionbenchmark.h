@@ -0,0 +1,33 @@
+#ifndef INTERSECTIONBENCHMARK_H
+#define INTERSECTIONBENCHMARK_H
+
+#include <QObject>
+#include <QVector>
+#include "ray.h"
+
+/**
+ * @brief IntersectionTests中射线与椭球, 球, 平面求交的基准测试
+ *
+ */
+class IntersectionBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void rayEllipsoid_data();
+    void rayEllipsoid();
+    void raySphere_data();
+    void raySphere();
+    void rayPlane();
+
+private:
+    QVector<Ray> _hitRays;
+    QVector<Ray> _missRays;
+    QVector<Ray> _insideRays;
+    QVector<Cartesian3> _planePoints;
+    QVector<Cartesian3> _planeNormals;
+};
+
+#endif // INTERSECTIONBENCHMARK_H
@@ -0,0 +1,81 @@
+#include <QCoreApplication>
+#include <QtTest>
+#include "easingbenchmark.h"
+#include "grazingbenchmark.h"
+#include "intersectionbenchmark.h"
+#include "polynomialbenchmark.h"
+#include "cameramathbenchmark.h"
+#include "pickbenchmark.h"
+#include "controllerbenchmark.h"
+#include "camerapathbenchmark.h"
+
+namespace {
+
+/**
+ * @brief 运行一个基准测试类; 指定了输出目录时, 额外把结果写入<目录>/<类名>.xml, 供compare_baseline.py比较
+ *
+ */
+int run(QObject *benchmark, const QStringList &arguments, const QString &outputDir)
+{
+    QStringList args = arguments;
+    if (!outputDir.isEmpty()) {
+        QString name = QString::fromLatin1(benchmark->metaObject()->className());
+        args << QStringLiteral("-o") << QDir(outputDir).filePath(name + QStringLiteral(".xml")) + QStringLiteral(",xml");
+        args << QStringLiteral("-o") << QStringLiteral("-,txt");
+    }
+    return QTest::qExec(benchmark, args);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    // --output-dir <dir> is handled here, everything else is passed to QTest (e.g. -median 5, -minimumvalue)
+    QStringList arguments = app.arguments();
+    QString outputDir;
+    int index = arguments.indexOf(QStringLiteral("--output-dir"));
+    if (index > 0 && index + 1 < arguments.length()) {
+        outputDir = arguments[index + 1];
+        arguments.removeAt(index + 1);
+        arguments.removeAt(index);
+        QDir().mkpath(outputDir);
+    }
+
+    int status = 0;
+    {
+        EasingBenchmark benchmark;
+        status |= run(&benchmark, arguments, outputDir);
+    }
+    {
+        GrazingBenchmark benchmark;
+        status |= run(&benchmark, arguments, outputDir);
+    }
+    {
+        IntersectionBenchmark benchmark;
+        status |= run(&benchmark, arguments, outputDir);
+    }
+    {
+        PolynomialBenchmark benchmark;
+        status |= run(&benchmark, arguments, outputDir);
+    }
+    {
+        CameraMathBenchmark benchmark;
+        status |= run(&benchmark, arguments, outputDir);
+    }
+    {
+        PickBenchmark benchmark;
+        status |= run(&benchmark, arguments, outputDir);
+    }
+    {
+        ControllerBenchmark benchmark;
+        status |= run(&benchmark, arguments, outputDir);
+    }
+    {
+        CameraPathBenchmark benchmark;
+        status |= run(&benchmark, arguments, outputDir);
+    }
+
+    return status;
+}
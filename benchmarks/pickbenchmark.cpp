@@ -0,0 +1,161 @@
+#include "pickbenchmark.h"
+#include "rtcellipsoidpicker.h"
+#include "ellipsoid.h"
+#include "benchmarkutils.h"
+#include <QtTest>
+
+namespace {
+const int WIDTH = 1920;
+const int HEIGHT = 1080;
+const double FOVY = 60.0;
+const int CAMERA_COUNT = 16;
+const int PIXEL_COUNT = 4096;
+
+/**
+ * @brief 在height高度随机放置相机, 随机朝向, pitch在-3度到-90度之间
+ *
+ */
+void randomCamera(std::mt19937 &generator, double height, RtcEllipsoidPicker &picker)
+{
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    Ellipsoid *ellipsoid = Ellipsoid::WGS84();
+
+    Cartographic cartographic((unit(generator) * 2.0 - 1.0) * M_PI, (unit(generator) - 0.5) * 3.0, height);
+    Cartesian3 position = ellipsoid->cartographicToCartesian(cartographic);
+    Cartesian3 normal = ellipsoid->geodeticSurfaceNormal(position);
+    Cartesian3 east = Cartesian3::cross(Cartesian3::UNIT_Z, normal).normalize();
+    Cartesian3 north = Cartesian3::cross(normal, east);
+
+    double heading = unit(generator) * 2.0 * M_PI;
+    double pitch = -Math::toRadians(3.0 + unit(generator) * 87.0);
+    Cartesian3 horizontal = north * cos(heading) + east * sin(heading);
+    Cartesian3 direction = horizontal * cos(pitch) + normal * sin(pitch);
+    Cartesian3 right = Cartesian3::cross(direction, normal).normalize();
+    Cartesian3 up = Cartesian3::cross(right, direction);
+
+    picker.setEllipsoid(ellipsoid);
+    picker.setFrame(position, direction, up, right, FOVY, double(WIDTH) / HEIGHT, WIDTH, HEIGHT);
+}
+
+QVector<Cartesian2> randomPixels(std::mt19937 &generator)
+{
+    std::uniform_real_distribution<double> x(0.0, WIDTH);
+    std::uniform_real_distribution<double> y(0.0, HEIGHT);
+    QVector<Cartesian2> pixels;
+    pixels.reserve(PIXEL_COUNT);
+    for (int i = 0; i < PIXEL_COUNT; ++i) {
+        pixels.append(Cartesian2(x(generator), y(generator)));
+    }
+    return pixels;
+}
+
+void heightRows()
+{
+    QTest::addColumn<double>("height");
+    QTest::newRow("2 m") << 2.0;
+    QTest::newRow("100 m") << 100.0;
+    QTest::newRow("1 km") << 1000.0;
+    QTest::newRow("10 km") << 10000.0;
+    QTest::newRow("100 km") << 100000.0;
+    QTest::newRow("1000 km") << 1000000.0;
+    QTest::newRow("10000 km") << 10000000.0;
+}
+}
+
+void PickBenchmark::accuracy_data()
+{
+    heightRows();
+}
+
+void PickBenchmark::accuracy()
+{
+    QFETCH(double, height);
+
+    std::mt19937 generator = BenchmarkUtils::generator(6);
+    double pixelAngle = 2.0 * tan(Math::toRadians(FOVY) * 0.5) / HEIGHT;
+
+    double maximumError = 0.0;
+    double maximumPixels = 0.0;
+    int fallback = 0;
+    int miss = 0;
+    int mismatch = 0;
+    int total = 0;
+
+    for (int camera = 0; camera < CAMERA_COUNT; ++camera) {
+        RtcEllipsoidPicker picker;
+        randomCamera(generator, height, picker);
+        QVector<Cartesian2> pixels = randomPixels(generator);
+
+        QVector<Cartesian3> reference;
+        QVector<Cartesian3> results;
+        picker.pickDouble(pixels, reference);
+        picker.pick(pixels, results);
+        fallback += picker.fallbackCount();
+        miss += picker.missCount();
+        total += pixels.length();
+
+        Ray ray = picker.pickRay(0.0, 0.0);
+        for (int i = 0; i < pixels.length(); ++i) {
+            if (defined(reference[i]) != defined(results[i])) {
+                ++mismatch;
+                continue;
+            }
+            if (!defined(reference[i])) {
+                continue;
+            }
+            double error = (reference[i] - results[i]).magnitude();
+            double distance = (reference[i] - ray.origin).magnitude();
+            maximumError = std::max(maximumError, error);
+            maximumPixels = std::max(maximumPixels, error / (distance * pixelAngle));
+        }
+    }
+
+    qInfo("height %.0f m: max error %.3g m, %.3g px (tolerance %.2f px), fallback %.3f%%, miss %.1f%%, hit/miss mismatch %d",
+          height, maximumError, maximumPixels, RtcEllipsoidPicker().tolerance(),
+          100.0 * fallback / total, 100.0 * miss / total, mismatch);
+
+    // the error estimate is first order, allow it to be off by a factor of a few
+    QVERIFY(maximumPixels < 0.5);
+}
+
+void PickBenchmark::doublePick_data()
+{
+    heightRows();
+}
+
+void PickBenchmark::doublePick()
+{
+    QFETCH(double, height);
+
+    std::mt19937 generator = BenchmarkUtils::generator(6);
+    RtcEllipsoidPicker picker;
+    randomCamera(generator, height, picker);
+    QVector<Cartesian2> pixels = randomPixels(generator);
+    QVector<Cartesian3> results;
+
+    QBENCHMARK {
+        picker.pickDouble(pixels, results);
+    }
+    QCOMPARE(results.length(), pixels.length());
+}
+
+void PickBenchmark::rtcPick_data()
+{
+    heightRows();
+}
+
+void PickBenchmark::rtcPick()
+{
+    QFETCH(double, height);
+
+    std::mt19937 generator = BenchmarkUtils::generator(6);
+    RtcEllipsoidPicker picker;
+    randomCamera(generator, height, picker);
+    QVector<Cartesian2> pixels = randomPixels(generator);
+    QVector<Cartesian3> results;
+
+    QBENCHMARK {
+        picker.pick(pixels, results);
+    }
+    QCOMPARE(results.length(), pixels.length());
+}
@@ -0,0 +1,24 @@
+#ifndef PICKBENCHMARK_H
+#define PICKBENCHMARK_H
+
+#include <QObject>
+
+/**
+ * @brief RtcEllipsoidPicker的精度报告和基准测试 (单精度模式与double比较)
+ *
+ */
+class PickBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void accuracy_data();
+    void accuracy();
+
+    void doublePick_data();
+    void doublePick();
+    void rtcPick_data();
+    void rtcPick();
+};
+
+#endif // PICKBENCHMARK_H
@@ -0,0 +1,75 @@
+#include "polynomialbenchmark.h"
+#include "quadraticrealpolynomial.h"
+#include "cubicrealpolynomial.h"
+#include "quarticrealpolynomial.h"
+#include "benchmarkutils.h"
+#include <QtTest>
+
+namespace {
+const int POLYNOMIAL_COUNT = 1024;
+}
+
+void PolynomialBenchmark::initTestCase()
+{
+    // half of the polynomials are built from real roots, the other half have random coefficients
+    // so that every branch of the solvers (no, repeated and distinct real roots) is exercised
+    std::mt19937 generator = BenchmarkUtils::generator(4);
+    std::uniform_real_distribution<double> value(-10.0, 10.0);
+
+    _quadratic.clear();
+    _cubic.clear();
+    _quartic.clear();
+    for (int i = 0; i < POLYNOMIAL_COUNT; ++i) {
+        bool fromRoots = (i % 2) == 0;
+        double r0 = value(generator);
+        double r1 = value(generator);
+        double r2 = value(generator);
+        double r3 = value(generator);
+
+        if (fromRoots) {
+            _quadratic << 1.0 << -(r0 + r1) << r0 * r1;
+            _cubic << 1.0 << -(r0 + r1 + r2) << (r0 * r1 + r0 * r2 + r1 * r2) << -r0 * r1 * r2;
+            _quartic << 1.0 << -(r0 + r1 + r2 + r3)
+                     << (r0 * r1 + r0 * r2 + r0 * r3 + r1 * r2 + r1 * r3 + r2 * r3)
+                     << -(r0 * r1 * r2 + r0 * r1 * r3 + r0 * r2 * r3 + r1 * r2 * r3)
+                     << r0 * r1 * r2 * r3;
+        } else {
+            _quadratic << r0 << r1 << r2;
+            _cubic << r0 << r1 << r2 << r3;
+            _quartic << r0 << r1 << r2 << r3 << value(generator);
+        }
+    }
+}
+
+void PolynomialBenchmark::quadratic()
+{
+    int count = 0;
+    QBENCHMARK {
+        for (int i = 0; i < _quadratic.length(); i += 3) {
+            count += QuadraticRealPolynomial::computeRealRoots(_quadratic[i], _quadratic[i + 1], _quadratic[i + 2]).length();
+        }
+    }
+    QVERIFY(count > 0);
+}
+
+void PolynomialBenchmark::cubic()
+{
+    int count = 0;
+    QBENCHMARK {
+        for (int i = 0; i < _cubic.length(); i += 4) {
+            count += CubicRealPolynomial::computeRealRoots(_cubic[i], _cubic[i + 1], _cubic[i + 2], _cubic[i + 3]).length();
+        }
+    }
+    QVERIFY(count > 0);
+}
+
+void PolynomialBenchmark::quartic()
+{
+    int count = 0;
+    QBENCHMARK {
+        for (int i = 0; i < _quartic.length(); i += 5) {
+            count += QuarticRealPolynomial::computeRealRoots(_quartic[i], _quartic[i + 1], _quartic[i + 2], _quartic[i + 3], _quartic[i + 4]).length();
+        }
+    }
+    QVERIFY(count > 0);
+}
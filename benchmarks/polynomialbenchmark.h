@@ -0,0 +1,28 @@
+#ifndef POLYNOMIALBENCHMARK_H
+#define POLYNOMIALBENCHMARK_H
+
+#include <QObject>
+#include <QVector>
+
+/**
+ * @brief 二次, 三次, 四次实系数多项式求根的基准测试
+ *
+ */
+class PolynomialBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void quadratic();
+    void cubic();
+    void quartic();
+
+private:
+    QVector<double> _quadratic; ///< 每3个为一组系数
+    QVector<double> _cubic; ///< 每4个为一组系数
+    QVector<double> _quartic; ///< 每5个为一组系数
+};
+
+#endif // POLYNOMIALBENCHMARK_H
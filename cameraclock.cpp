@@ -0,0 +1,38 @@
+#include "cameraclock.h"
+
+CameraClock::~CameraClock()
+{
+}
+
+SteadyCameraClock::SteadyCameraClock()
+{
+    _timer.start();
+}
+
+qint64 SteadyCameraClock::nanoseconds() const
+{
+    return _timer.nsecsElapsed();
+}
+
+ManualCameraClock::ManualCameraClock(qint64 nanoseconds)
+    : _nanoseconds(nanoseconds)
+{
+}
+
+qint64 ManualCameraClock::nanoseconds() const
+{
+    return _nanoseconds;
+}
+
+void ManualCameraClock::setNanoseconds(qint64 nanoseconds)
+{
+    // 保持单调
+    _nanoseconds = qMax(_nanoseconds, nanoseconds);
+}
+
+void ManualCameraClock::advance(qint64 nanoseconds)
+{
+    if (nanoseconds > 0) {
+        _nanoseconds += nanoseconds;
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef CAMERACLOCK_H
+#define CAMERACLOCK_H
+
+#include "sscc_global.h"
+#include <QElapsedTimer>
+
+/**
+ * @brief 单调时钟接口, 为动画, 惯性和键盘移动提供同一个时间源
+ *
+ * ScreenSpaceCameraController每帧只读一次时钟, 所有子系统使用同一个帧时间戳. 测试和回放可以注入ManualCameraClock使用模拟时间
+ */
+class CONTROLLER_EXPORT CameraClock
+{
+public:
+    virtual ~CameraClock();
+
+    /**
+     * @brief 获取当前时间
+     *
+     * @return qint64 单调递增的时间 (纳秒), 起点由实现决定
+     */
+    virtual qint64 nanoseconds() const = 0;
+
+    /**
+     * @brief 获取当前时间
+     *
+     * @return double 单调递增的时间 (毫秒, 保留纳秒精度)
+     */
+    double milliseconds() const { return toMilliseconds(nanoseconds()); }
+
+    /**
+     * @brief 纳秒转换为毫秒
+     *
+     * @param nanoseconds 纳秒
+     * @return double 毫秒
+     */
+    static double toMilliseconds(qint64 nanoseconds) { return nanoseconds / 1.0e6; }
+};
+
+/**
+ * @brief 基于QElapsedTimer的单调时钟 (默认时钟), 起点为构造的时刻
+ *
+ */
+class CONTROLLER_EXPORT SteadyCameraClock : public CameraClock
+{
+public:
+    SteadyCameraClock();
+
+    qint64 nanoseconds() const override;
+
+private:
+    QElapsedTimer _timer;
+};
+
+/**
+ * @brief 手动推进的时钟, 用于测试和回放
+ *
+ */
+class CONTROLLER_EXPORT ManualCameraClock : public CameraClock
+{
+public:
+    /**
+     * @brief 构造
+     *
+     * @param nanoseconds 初始时间 (纳秒)
+     */
+    explicit ManualCameraClock(qint64 nanoseconds = 0);
+
+    qint64 nanoseconds() const override;
+
+    /**
+     * @brief 设置当前时间, 不能早于当前时间
+     *
+     * @param nanoseconds 时间 (纳秒)
+     */
+    void setNanoseconds(qint64 nanoseconds);
+
+    /**
+     * @brief 时间向前推进
+     *
+     * @param nanoseconds 推进的时间 (纳秒), 小于0时忽略
+     */
+    void advance(qint64 nanoseconds);
+
+private:
+    qint64 _nanoseconds = 0;
+};
+
+#endif // CAMERACLOCK_H
@@ -0,0 +1,226 @@
+#include "cameracommandbuffer.h"
+
+namespace {
+struct CommandName {
+    const char *name;
+    CameraCommand::Type type;
+    int argumentCount; ///< 不包括操作名
+};
+
+const CommandName COMMAND_NAMES[] = {
+    { "rotate", CameraCommand::Rotate, 4 },
+    { "rotateUp", CameraCommand::RotateUp, 1 },
+    { "rotateDown", CameraCommand::RotateDown, 1 },
+    { "rotateLeft", CameraCommand::RotateLeft, 1 },
+    { "rotateRight", CameraCommand::RotateRight, 1 },
+    { "move", CameraCommand::Move, 4 },
+    { "moveForward", CameraCommand::MoveForward, 1 },
+    { "moveBackward", CameraCommand::MoveBackward, 1 },
+    { "moveUp", CameraCommand::MoveUp, 1 },
+    { "moveDown", CameraCommand::MoveDown, 1 },
+    { "moveLeft", CameraCommand::MoveLeft, 1 },
+    { "moveRight", CameraCommand::MoveRight, 1 },
+    { "look", CameraCommand::Look, 4 },
+    { "lookUp", CameraCommand::LookUp, 1 },
+    { "lookDown", CameraCommand::LookDown, 1 },
+    { "lookLeft", CameraCommand::LookLeft, 1 },
+    { "lookRight", CameraCommand::LookRight, 1 },
+    { "zoomIn", CameraCommand::ZoomIn, 1 },
+    { "zoomOut", CameraCommand::ZoomOut, 1 },
+    { "setView", CameraCommand::SetView, 6 }
+};
+}
+
+CameraCommandBuffer &CameraCommandBuffer::rotate(const Cartesian3 &axis, double angle)
+{
+    return appendCommand(CameraCommand::Rotate, axis, angle);
+}
+
+CameraCommandBuffer &CameraCommandBuffer::rotateUp(double angle)
+{
+    return appendCommand(CameraCommand::RotateUp, angle);
+}
+
+CameraCommandBuffer &CameraCommandBuffer::rotateDown(double angle)
+{
+    return appendCommand(CameraCommand::RotateDown, angle);
+}
+
+CameraCommandBuffer &CameraCommandBuffer::rotateLeft(double angle)
+{
+    return appendCommand(CameraCommand::RotateLeft, angle);
+}
+
+CameraCommandBuffer &CameraCommandBuffer::rotateRight(double angle)
+{
+    return appendCommand(CameraCommand::RotateRight, angle);
+}
+
+CameraCommandBuffer &CameraCommandBuffer::move(const Cartesian3 &direction, double amount)
+{
+    return appendCommand(CameraCommand::Move, direction, amount);
+}
+
+CameraCommandBuffer &CameraCommandBuffer::moveForward(double amount)
+{
+    return appendCommand(CameraCommand::MoveForward, amount);
+}
+
+CameraCommandBuffer &CameraCommandBuffer::moveBackward(double amount)
+{
+    return appendCommand(CameraCommand::MoveBackward, amount);
+}
+
+CameraCommandBuffer &CameraCommandBuffer::moveUp(double amount)
+{
+    return appendCommand(CameraCommand::MoveUp, amount);
+}
+
+CameraCommandBuffer &CameraCommandBuffer::moveDown(double amount)
+{
+    return appendCommand(CameraCommand::MoveDown, amount);
+}
+
+CameraCommandBuffer &CameraCommandBuffer::moveLeft(double amount)
+{
+    return appendCommand(CameraCommand::MoveLeft, amount);
+}
+
+CameraCommandBuffer &CameraCommandBuffer::moveRight(double amount)
+{
+    return appendCommand(CameraCommand::MoveRight, amount);
+}
+
+CameraCommandBuffer &CameraCommandBuffer::look(const Cartesian3 &axis, double angle)
+{
+    return appendCommand(CameraCommand::Look, axis, angle);
+}
+
+CameraCommandBuffer &CameraCommandBuffer::lookUp(double amount)
+{
+    return appendCommand(CameraCommand::LookUp, amount);
+}
+
+CameraCommandBuffer &CameraCommandBuffer::lookDown(double amount)
+{
+    return appendCommand(CameraCommand::LookDown, amount);
+}
+
+CameraCommandBuffer &CameraCommandBuffer::lookLeft(double amount)
+{
+    return appendCommand(CameraCommand::LookLeft, amount);
+}
+
+CameraCommandBuffer &CameraCommandBuffer::lookRight(double amount)
+{
+    return appendCommand(CameraCommand::LookRight, amount);
+}
+
+CameraCommandBuffer &CameraCommandBuffer::zoomIn(double amount)
+{
+    return appendCommand(CameraCommand::ZoomIn, amount);
+}
+
+CameraCommandBuffer &CameraCommandBuffer::zoomOut(double amount)
+{
+    return appendCommand(CameraCommand::ZoomOut, amount);
+}
+
+CameraCommandBuffer &CameraCommandBuffer::setView(const Cartesian3 &destination, double heading, double pitch, double roll)
+{
+    CameraCommand command;
+    command.type = CameraCommand::SetView;
+    command.axis = destination;
+    command.heading = heading;
+    command.pitch = pitch;
+    command.roll = roll;
+    _commands.append(command);
+    return *this;
+}
+
+bool CameraCommandBuffer::append(const QVariantList &commands, QString *error)
+{
+    QVector<CameraCommand> parsed;
+    parsed.reserve(commands.size());
+
+    for (int i = 0; i < commands.size(); ++i) {
+        QVariantList item = commands[i].toList();
+        QString name = item.isEmpty() ? QString() : item[0].toString();
+
+        const CommandName *entry = nullptr;
+        for (const CommandName &candidate : COMMAND_NAMES) {
+            if (name == QLatin1String(candidate.name)) {
+                entry = &candidate;
+                break;
+            }
+        }
+
+        if (!entry) {
+            if (error) {
+                *error = QString("command %1: unknown operation '%2'").arg(i).arg(name);
+            }
+            return false;
+        }
+        if (item.size() != entry->argumentCount + 1) {
+            if (error) {
+                *error = QString("command %1: '%2' expects %3 arguments").arg(i).arg(name).arg(entry->argumentCount);
+            }
+            return false;
+        }
+
+        double arguments[6];
+        for (int k = 0; k < entry->argumentCount; ++k) {
+            bool ok = false;
+            arguments[k] = item[k + 1].toDouble(&ok);
+            if (!ok) {
+                if (error) {
+                    *error = QString("command %1: argument %2 of '%3' is not a number").arg(i).arg(k + 1).arg(name);
+                }
+                return false;
+            }
+        }
+
+        CameraCommand command;
+        command.type = entry->type;
+        if (entry->argumentCount == 1) {
+            command.amount = arguments[0];
+        } else {
+            command.axis = Cartesian3(arguments[0], arguments[1], arguments[2]);
+            if (entry->type == CameraCommand::SetView) {
+                command.heading = arguments[3];
+                command.pitch = arguments[4];
+                command.roll = arguments[5];
+            } else {
+                command.amount = arguments[3];
+            }
+        }
+        parsed.append(command);
+    }
+
+    _commands += parsed;
+    return true;
+}
+
+void CameraCommandBuffer::append(const CameraCommandBuffer &other)
+{
+    _commands += other._commands;
+}
+
+CameraCommandBuffer &CameraCommandBuffer::appendCommand(CameraCommand::Type type, double amount)
+{
+    CameraCommand command;
+    command.type = type;
+    command.amount = amount;
+    _commands.append(command);
+    return *this;
+}
+
+CameraCommandBuffer &CameraCommandBuffer::appendCommand(CameraCommand::Type type, const Cartesian3 &axis, double amount)
+{
+    CameraCommand command;
+    command.type = type;
+    command.axis = axis;
+    command.amount = amount;
+    _commands.append(command);
+    return *this;
+}
@@ -0,0 +1,105 @@
+#ifndef CAMERACOMMANDBUFFER_H
+#define CAMERACOMMANDBUFFER_H
+
+#include "sscc_global.h"
+#include "cartesian3.h"
+
+/**
+ * @brief 一条相机操作
+ *
+ */
+struct CameraCommand {
+    /**
+     * @brief 操作类型, 与ScreenSpaceCameraController中同名的Q_INVOKABLE函数对应
+     *
+     */
+    enum Type {
+        Rotate, ///< axis, amount (弧度)
+        RotateUp,
+        RotateDown,
+        RotateLeft,
+        RotateRight,
+        Move, ///< axis, amount
+        MoveForward,
+        MoveBackward,
+        MoveUp,
+        MoveDown,
+        MoveLeft,
+        MoveRight,
+        Look, ///< axis, amount (弧度)
+        LookUp,
+        LookDown,
+        LookLeft,
+        LookRight,
+        ZoomIn,
+        ZoomOut,
+        SetView ///< axis为目标点, heading, pitch, roll (弧度)
+    };
+
+    Type type = MoveForward;
+    Cartesian3 axis; ///< 旋转轴, 平移方向或setView的目标点
+    double amount = 0.0; ///< 角度 (弧度) 或距离
+    double heading = 0.0;
+    double pitch = 0.0;
+    double roll = 0.0;
+};
+
+/**
+ * @brief 相机操作的缓冲区, 一次提交多条操作, 在下一次update中按顺序在一个事务里执行
+ *
+ * 可以用C++链式调用构造, 也可以从QML或脚本传入的紧凑列表构造, 每条操作是一个列表, 第一个元素为操作名:
+ * [["rotateLeft", 0.1], ["moveForward", 100], ["move", x, y, z, amount], ["setView", x, y, z, heading, pitch, roll]]
+ */
+class CONTROLLER_EXPORT CameraCommandBuffer
+{
+public:
+    CameraCommandBuffer &rotate(const Cartesian3 &axis, double angle);
+    CameraCommandBuffer &rotateUp(double angle);
+    CameraCommandBuffer &rotateDown(double angle);
+    CameraCommandBuffer &rotateLeft(double angle);
+    CameraCommandBuffer &rotateRight(double angle);
+    CameraCommandBuffer &move(const Cartesian3 &direction, double amount);
+    CameraCommandBuffer &moveForward(double amount);
+    CameraCommandBuffer &moveBackward(double amount);
+    CameraCommandBuffer &moveUp(double amount);
+    CameraCommandBuffer &moveDown(double amount);
+    CameraCommandBuffer &moveLeft(double amount);
+    CameraCommandBuffer &moveRight(double amount);
+    CameraCommandBuffer &look(const Cartesian3 &axis, double angle);
+    CameraCommandBuffer &lookUp(double amount);
+    CameraCommandBuffer &lookDown(double amount);
+    CameraCommandBuffer &lookLeft(double amount);
+    CameraCommandBuffer &lookRight(double amount);
+    CameraCommandBuffer &zoomIn(double amount);
+    CameraCommandBuffer &zoomOut(double amount);
+    CameraCommandBuffer &setView(const Cartesian3 &destination, double heading, double pitch, double roll);
+
+    /**
+     * @brief 从紧凑列表构造
+     *
+     * @param commands 操作列表, 格式见类的说明
+     * @param error 不为空时返回第一个错误的描述
+     * @return bool true: 全部解析成功, false: 有无法解析的操作 (缓冲区不变)
+     */
+    bool append(const QVariantList &commands, QString *error = nullptr);
+
+    /**
+     * @brief 追加另一个缓冲区的所有操作
+     *
+     * @param other 另一个缓冲区
+     */
+    void append(const CameraCommandBuffer &other);
+
+    const QVector<CameraCommand> &commands() const { return _commands; }
+    int size() const { return _commands.size(); }
+    bool isEmpty() const { return _commands.isEmpty(); }
+    void clear() { _commands.clear(); }
+
+private:
+    CameraCommandBuffer &appendCommand(CameraCommand::Type type, double amount);
+    CameraCommandBuffer &appendCommand(CameraCommand::Type type, const Cartesian3 &axis, double amount);
+
+    QVector<CameraCommand> _commands;
+};
+
+#endif // CAMERACOMMANDBUFFER_H
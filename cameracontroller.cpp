@@ -1,19 +1,17 @@
 #include "cameracontroller.h"
 #include "intersectiontests.h"
-#include "litransform.h"
 #include "screenspaceeventutils.h"
-#include "liraycasthit.h"
 #include "liutils.h"
 #include "cameraflightpath.h"
 #include "cesiummath.h"
 #include "cesiumcartesian3.h"
 #include "ellipsoidgeodesic.h"
-#include "liscene.h"
-#include "licamera.h"
 #include "ellipsoid.h"
-#include "globe.h"
 #include "tweencollection.h"
-#include "liwidget.h"
+#include "timestamp.h"
+#include "camerapathfile.h"
+#include "rtcellipsoidpicker.h"
+#include "cameraclock.h"
 
 CameraController::CameraController(QObject *parent) :QObject(parent)
 {
@@ -23,14 +21,14 @@ CameraController::~CameraController()
 {
 }
 
-CameraController::CameraController(LiScene *scene, LiCamera *camera, TweenCollection *tweens, QObject *parent)
+CameraController::CameraController(const CameraEnvironment &environment, TweenCollection *tweens, QObject *parent)
     : QObject(parent)
 {
-    m_scene = scene;
-    m_camera = camera;
+    m_canvas = environment.canvas;
+    m_camera = environment.camera;
     m_tweens = tweens;
-    m_globe = scene->globe();
-    m_cameraTrans = m_camera->transform();
+    m_globe = environment.globe;
+    m_ellipsoid = environment.ellipsoid ? environment.ellipsoid : Ellipsoid::WGS84();
 
     _position = Cartesian3(2033992.677662228, -15449708.24660572, 10948396.652844096);
     _positionWC = Cartesian3(2033992.677662228, -15449708.24660572, 10948396.652844096);
@@ -46,8 +44,7 @@ CameraController::CameraController(LiScene *scene, LiCamera *camera, TweenCollec
     _right = Cartesian3(0.9914448613738105, 0.13052619222005152, 0);
     _rightWC = Cartesian3(0.9914448613738105, 0.13052619222005152, 0);
 
-    m_cameraTrans->setWorldPosition(_position);
-    m_cameraTrans->setAxes(_right, _direction, _up);
+    m_camera->setPose(_position, _right, _direction, _up);
 }
 
 void CameraController::setView(const Cartesian3 &destination, double heading, double pitch, double roll)
@@ -71,8 +68,8 @@ void CameraController::_setTransform(const Matrix4 &transform)
     Cartesian3 up = multiplyByPointAsVector(_actualInvTransform, upCarte).normalize();
     Cartesian3 right = Cartesian3::cross(direction, up).normalize();
 
-    m_cameraTrans->setWorldPosition(multiplyByPoint(_actualInvTransform, positionCarte));
-    m_cameraTrans->setAxes(right, direction, up);
+    setCameraPosition(multiplyByPoint(_actualInvTransform, positionCarte));
+    setCameraAxes(right, direction, up);
 
     updateMembers();
 }
@@ -81,9 +78,9 @@ Cartesian3 CameraController::pickPoint(double x, double y/*, bool includeTerrain
 {
     Ray ray = getPickRay(x, y);
 
-    LiRaycastHit raycastHit;
-    if (m_scene->raycast(ray, &raycastHit)) {
-        return raycastHit.point();
+    Cartesian3 hit;
+    if (m_globe && m_globe->raycast(ray, &hit)) {
+        return hit;
     }
     else {
         Cartesian3 o;
@@ -107,10 +104,12 @@ Cartesian3 CameraController::pickEllipsoid(const Cartesian2 &windowPosition, Ell
     return result;
 }
 
-void CameraController::pickEllipsoid3D(const Cartesian2 &windowPosition, Ellipsoid *ellipsoid, Cartesian3 &result)
+namespace {
+// Shape为Ellipsoid*或Sphere, 由IntersectionTests::rayEllipsoid的重载在编译时选择求交方法
+template <typename Shape>
+void pickShape(const Ray &ray, const Shape &shape, Cartesian3 &result)
 {
-    Ray ray = getPickRay(windowPosition.x, windowPosition.y);
-    Interval intersection = IntersectionTests::rayEllipsoid(ray, ellipsoid);
+    Interval intersection = IntersectionTests::rayEllipsoid(ray, shape);
     if (!defined(intersection)) {
         result = Cartesian3(Math::EPSILON20, 0, 0);
         return;
@@ -118,22 +117,120 @@ void CameraController::pickEllipsoid3D(const Cartesian2 &windowPosition, Ellipso
     double t = intersection.start > 0.0 ? intersection.start : intersection.stop;
     result = ray.getPoint(t);
 }
+}
+
+void CameraController::pickEllipsoid3D(const Cartesian2 &windowPosition, Ellipsoid *ellipsoid, Cartesian3 &result)
+{
+    pickShape(getPickRay(windowPosition.x, windowPosition.y), ellipsoid, result);
+}
+
+Cartesian3 CameraController::pickEllipsoid(const Cartesian2 &windowPosition, const Sphere &sphere, Cartesian3 &result)
+{
+    pickEllipsoid3D(windowPosition, sphere, result);
+    return result;
+}
+
+void CameraController::pickEllipsoid3D(const Cartesian2 &windowPosition, const Sphere &sphere, Cartesian3 &result)
+{
+    pickShape(getPickRay(windowPosition.x, windowPosition.y), sphere, result);
+}
+
+void CameraController::pickEllipsoidBatch(const QVector<Cartesian2> &windowPositions, Ellipsoid *ellipsoid, QVector<Cartesian3> &results,
+                                          bool relativeToCenter, double tolerance)
+{
+    if (!relativeToCenter) {
+        results.resize(windowPositions.size());
+        for (int i = 0; i < windowPositions.size(); ++i) {
+            pickEllipsoid3D(windowPositions[i], ellipsoid, results[i]);
+        }
+        return;
+    }
+
+    CameraCanvas *canvas = m_canvas;
+
+    RtcEllipsoidPicker picker;
+    picker.setFrame(positionWC(), directionWC(), upWC(), rightWC(),
+                    m_camera->fovy(), m_camera->aspectRatio(), canvas->width(), canvas->height());
+    picker.setEllipsoid(ellipsoid);
+    picker.setTolerance(tolerance);
+    picker.pick(windowPositions, results);
+}
 
 Ray CameraController::getPickRay(double x, double y)
 {
     return getPickRayPerspective(x, y);
 }
 
+Cartesian2 CameraController::projectToWindow(const Cartesian3 &position, int *flags)
+{
+    return windowProjection().project(position, flags);
+}
+
+void CameraController::projectToWindow(const double *x, const double *y, const double *z,
+                                       double *windowX, double *windowY, quint8 *flags, int count)
+{
+    windowProjection().project(x, y, z, windowX, windowY, flags, count);
+}
+
+WindowProjection CameraController::windowProjection()
+{
+    BatchTransform worldToView = worldToViewTransform();
+
+    CameraCanvas *canvas = m_canvas;
+    double fovy = m_camera->fovy();
+    double aspectRatio = m_camera->aspectRatio();
+    double nearPlane = m_camera->nearPlane();
+    int width = canvas->width();
+    int height = canvas->height();
+
+    if (_windowProjectionEpoch != _worldToViewEpoch ||
+            _windowProjection.fovy() != fovy ||
+            _windowProjection.aspectRatio() != aspectRatio ||
+            _windowProjection.nearPlane() != nearPlane ||
+            _windowProjection.width() != width ||
+            _windowProjection.height() != height) {
+        _windowProjection = WindowProjection(worldToView, fovy, aspectRatio, nearPlane, width, height);
+        _windowProjectionEpoch = _worldToViewEpoch;
+    }
+    return _windowProjection;
+}
+
+CullingVolume CameraController::cullingVolume()
+{
+    updateMembers();
+
+    double fovy = m_camera->fovy();
+    double aspectRatio = m_camera->aspectRatio();
+    double nearPlane = m_camera->nearPlane();
+    double farPlane = m_camera->farPlane();
+
+    if (_cullingVolumeEpoch != _poseEpoch ||
+            _cullingVolume.fovy() != fovy ||
+            _cullingVolume.aspectRatio() != aspectRatio ||
+            _cullingVolume.nearPlane() != nearPlane ||
+            _cullingVolume.farPlane() != farPlane) {
+        _cullingVolume = CullingVolume(_positionWC, _directionWC, _upWC, _rightWC, fovy, aspectRatio, nearPlane, farPlane);
+        _cullingVolumeEpoch = _poseEpoch;
+    }
+    return _cullingVolume;
+}
+
+void CameraController::computeVisibility(const double *x, const double *y, const double *z, const double *radius,
+                                         qint8 *results, int count)
+{
+    cullingVolume().computeVisibility(x, y, z, radius, results, count);
+}
+
 void CameraController::rotate(const Vector3 &axis, double angle)
 {
     angle = Math::toDegrees(angle);
     Quaternion quaternion = Quaternion::fromAxisAndAngle(axis, -angle);
     Matrix3 rotation = quaternion.toRotationMatrix();
 
-    m_cameraTrans->setWorldPosition(rotation * m_cameraTrans->worldPosition());
+    setCameraPosition(rotation * cameraPosition());
 
-    Cartesian3 direction = m_cameraTrans->yaxis();
-    Cartesian3 up = m_cameraTrans->zaxis();
+    Cartesian3 direction = cameraDirection();
+    Cartesian3 up = cameraUp();
     Cartesian3 right;
 
     direction = (rotation * direction).normalize();
@@ -141,7 +238,7 @@ void CameraController::rotate(const Vector3 &axis, double angle)
     right = Cartesian3::cross(direction, up).normalize();
     up = Cartesian3::cross(right, direction).normalize();
 
-    m_cameraTrans->setAxes(right, direction, up);
+    setCameraAxes(right, direction, up);
 }
 
 void CameraController::rotateUp(double angle)
@@ -167,37 +264,37 @@ void CameraController::rotateLeft(double angle)
 void CameraController::move(const Vector3 &dir, double amount)
 {
     Cartesian3 moveScratch = dir * amount;
-    m_cameraTrans->setWorldPosition(m_cameraTrans->worldPosition() + moveScratch);
+    setCameraPosition(cameraPosition() + moveScratch);
 }
 
 void CameraController::moveForward(double amount)
 {
-    move(m_cameraTrans->yaxis(), amount);
+    move(cameraDirection(), amount);
 }
 
 void CameraController::moveBackward(double amount)
 {
-    move(m_cameraTrans->yaxis(), -amount);
+    move(cameraDirection(), -amount);
 }
 
 void CameraController::moveUp(double amount)
 {
-    move(m_cameraTrans->zaxis(), amount);
+    move(cameraUp(), amount);
 }
 
 void CameraController::moveDown(double amount)
 {
-    move(m_cameraTrans->zaxis(), -amount);
+    move(cameraUp(), -amount);
 }
 
 void CameraController::moveRight(double amount)
 {
-    move(m_cameraTrans->xaxis(), amount);
+    move(cameraRight(), amount);
 }
 
 void CameraController::moveLeft(double amount)
 {
-    move(m_cameraTrans->xaxis(), -amount);
+    move(cameraRight(), -amount);
 }
 
 void CameraController::look(const Vector3 &axis, double angle)
@@ -206,39 +303,39 @@ void CameraController::look(const Vector3 &axis, double angle)
     Quaternion quaternion = Quaternion::fromAxisAndAngle(axis, -angle);
     Matrix3 rotation = quaternion.toRotationMatrix();
 
-    Cartesian3 direction = m_cameraTrans->yaxis();
-    Cartesian3 up = m_cameraTrans->zaxis();
-    Cartesian3 right = m_cameraTrans->xaxis();
+    Cartesian3 direction = cameraDirection();
+    Cartesian3 up = cameraUp();
+    Cartesian3 right = cameraRight();
 
     direction = rotation * direction;
     up = rotation * up;
     right = rotation * right;
 
-    m_cameraTrans->setAxes(right.normalize(), direction.normalize(), up.normalize());
+    setCameraAxes(right.normalize(), direction.normalize(), up.normalize());
 }
 
 void CameraController::lookUp(double amount)
 {
     // only want view of map to change in 3D mode, 2D visual is incorrect when look changes
-    look(m_cameraTrans->xaxis(), -amount);
+    look(cameraRight(), -amount);
 }
 
 void CameraController::lookDown(double amount)
 {
     // only want view of map to change in 3D mode, 2D visual is incorrect when look changes
-    look(m_cameraTrans->xaxis(), amount);
+    look(cameraRight(), amount);
 }
 
 void CameraController::lookRight(double amount)
 {
     // only want view of map to change in 3D mode, 2D visual is incorrect when look changes
-    look(m_cameraTrans->zaxis(), amount);
+    look(cameraUp(), amount);
 }
 
 void CameraController::lookLeft(double amount)
 {
     // only want view of map to change in 3D mode, 2D visual is incorrect when look changes
-    look(m_cameraTrans->zaxis(), -amount);
+    look(cameraUp(), -amount);
 }
 
 void CameraController::zoomIn(double amount)
@@ -253,7 +350,7 @@ void CameraController::zoomOut(double amount)
 
 Cartesian3 CameraController::getRectangleCameraCoordinates(const LiRectangle &rectangle)
 {
-    return rectangleCameraPosition3D(rectangle);
+    return rectangleCameraPosition3D(rectangle, m_camera->fovy(), m_camera->aspectRatio());
 }
 
 void CameraController::cancelFlight()
@@ -265,6 +362,35 @@ void CameraController::cancelFlight()
     }
 }
 
+bool CameraController::isFlying() const
+{
+    return _currentFlight != nullptr;
+}
+
+QVector<CameraFlightSample> CameraController::sampleFlight(const QVector<double> &timeOffsets, bool withFootprint)
+{
+    QVector<CameraFlightSample> samples(timeOffsets.length());
+    double now = currentTime();
+
+    for (int i = 0; i < timeOffsets.length(); ++i) {
+        CameraFlightSample &sample = samples[i];
+        sample.timeOffset = timeOffsets[i];
+
+        if (!_currentFlight || !_currentFlight->samplePose(now + timeOffsets[i] * 1000.0, now, sample.pose)) {
+            continue;
+        }
+
+        sample.valid = true;
+        computeAxes(sample.pose, sample.direction, sample.up, sample.right);
+
+        if (withFootprint) {
+            computeFootprint(sample.pose.position, sample.direction, sample.up, sample.right, sample.footprint);
+        }
+    }
+
+    return samples;
+}
+
 void CameraController::flyTo(const Vector3 &destination, double duration, double heading, double pitch, double roll)
 {
     heading = Math::toRadians(heading);
@@ -283,7 +409,7 @@ void CameraController::flyTo(const Vector3 &destination, double duration, double
     newOptions.roll = roll;
     newOptions.duration = duration;
     newOptions.complete = [=]() {
-        emit m_camera->completeFlight();
+        m_camera->completeFlight();
         if(_currentFlight)
             _currentFlight = nullptr;
     };
@@ -304,6 +430,74 @@ void CameraController::flyTo(const LiRectangle &destination, double duration, do
     flyTo(cartesian, duration, heading, pitch, roll);
 }
 
+void CameraController::flyTour(const QVector<CameraWaypoint> &waypoints)
+{
+    cancelFlight();
+
+    if (waypoints.isEmpty()) {
+        return;
+    }
+
+    QVector<CameraWaypoint> path;
+    path.reserve(waypoints.length() + 1);
+    if (!defined(waypoints[0].time) || waypoints[0].time > 0.0) {
+        CameraWaypoint current;
+        current.position = positionWC();
+        current.heading = heading();
+        current.pitch = pitch();
+        current.roll = roll();
+        current.time = 0.0;
+        path.append(current);
+    }
+    path.append(waypoints);
+
+    if (path.length() < 2) {
+        // 只有一个时间为0的途经点, 不能构成漫游, 直接设置到该点
+        const CameraWaypoint &waypoint = path.last();
+        double heading = waypoint.heading;
+        double pitch = waypoint.pitch;
+        double roll = waypoint.roll;
+        if (defined(waypoint.target)) {
+            CameraTour::headingPitchToTarget(waypoint.position, waypoint.target, heading, pitch);
+            roll = 0.0;
+        }
+        setView(waypoint.position, heading, pitch, roll);
+        m_camera->completeFlight();
+        return;
+    }
+
+    QSharedPointer<CameraTour> tour(new CameraTour(path));
+
+    TweenAction complete = [=]() {
+        m_camera->completeFlight();
+        if(_currentFlight)
+            _currentFlight = nullptr;
+    };
+
+    _currentFlight = m_tweens->add(CameraFlightPath::createTourTween(this, tour, complete, nullptr));
+}
+
+void CameraController::playPath(const QSharedPointer<CameraPathFile> &path, double startTime, double speed, const TweenAction1 &fovCallback)
+{
+    cancelFlight();
+
+    if (!path || !path->isOpen()) {
+        return;
+    }
+
+    if (!defined(startTime)) {
+        startTime = path->startTime();
+    }
+
+    TweenAction complete = [=]() {
+        m_camera->completeFlight();
+        if(_currentFlight)
+            _currentFlight = nullptr;
+    };
+
+    _currentFlight = m_tweens->add(CameraFlightPath::createPathTween(this, path, startTime, speed, fovCallback, complete, nullptr));
+}
+
 Matrix4 CameraController::invTransform()
 {
     updateMembers();
@@ -346,13 +540,43 @@ void CameraController::worldToCameraCoordinates(Cartesian3 &cartesian)
     cartesian = _actualInvTransform * cartesian;
 }
 
+void CameraController::worldToCameraCoordinates(const double *x, const double *y, const double *z,
+                                                double *resultX, double *resultY, double *resultZ, int count)
+{
+    updateMembers();
+    _worldToCamera.transformPoints(x, y, z, resultX, resultY, resultZ, count);
+}
+
+void CameraController::worldToViewCoordinates(const double *x, const double *y, const double *z,
+                                              double *resultX, double *resultY, double *resultZ, int count)
+{
+    worldToViewTransform().transformPoints(x, y, z, resultX, resultY, resultZ, count);
+}
+
+BatchTransform CameraController::worldToCameraTransform()
+{
+    updateMembers();
+    return _worldToCamera;
+}
+
+BatchTransform CameraController::worldToViewTransform()
+{
+    updateMembers();
+    if (!_worldToViewValid || _worldToViewEpoch != _poseEpoch) {
+        _worldToView = BatchTransform::fromCameraAxes(_positionWC, _rightWC, _directionWC, _upWC);
+        _worldToViewEpoch = _poseEpoch;
+        _worldToViewValid = true;
+    }
+    return _worldToView;
+}
+
 double CameraController::heading()
 {
     Matrix4 oldTransform = _transform;
     Matrix4 transform = eastNorthUpToFixedFrame(positionWC());
     _setTransform(transform);
 
-    double heading = getHeading(m_cameraTrans->yaxis(), m_cameraTrans->zaxis());
+    double heading = getHeading(cameraDirection(), cameraUp());
 
     _setTransform(oldTransform);
 
@@ -365,7 +589,7 @@ double CameraController::pitch()
     Matrix4 transform = eastNorthUpToFixedFrame(positionWC());
     _setTransform(transform);
 
-    double pitch = getPitch(m_cameraTrans->yaxis());
+    double pitch = getPitch(cameraDirection());
 
     _setTransform(oldTransform);
 
@@ -378,18 +602,241 @@ double CameraController::roll()
     Matrix4 transform = eastNorthUpToFixedFrame(positionWC());
     _setTransform(transform);
 
-    double roll = getRoll(m_cameraTrans->yaxis(), m_cameraTrans->zaxis(), m_cameraTrans->xaxis());
+    double roll = getRoll(cameraDirection(), cameraUp(), cameraRight());
 
     _setTransform(oldTransform);
 
     return roll;
 }
 
+void CameraController::headingPitchRoll(double &heading, double &pitch, double &roll)
+{
+    // computeAxes的逆过程: 把世界坐标系的方向转到东北天坐标系, 不修改相机的变换
+    Matrix4 invTransform = eastNorthUpToFixedFrame(positionWC()).inverseTransformation();
+
+    Cartesian3 direction = multiplyByPointAsVector(invTransform, directionWC()).normalize();
+    Cartesian3 up = multiplyByPointAsVector(invTransform, upWC()).normalize();
+    Cartesian3 right = Cartesian3::cross(direction, up).normalize();
+    heading = getHeading(direction, up);
+    pitch = getPitch(direction);
+    roll = getRoll(direction, up, right);
+}
+
+void CameraController::beginTransaction()
+{
+    ++_transactionDepth;
+}
+
+void CameraController::commitTransaction()
+{
+    if (_transactionDepth == 0 || --_transactionDepth > 0) {
+        return;
+    }
+
+    // 位置和方向在一次setPose中写入, 每帧只通知一次
+    if (_pendingPositionChanged && _pendingAxesChanged) {
+        m_camera->setPose(_pendingPosition, _pendingRight, _pendingDirection, _pendingUp);
+    } else if (_pendingPositionChanged) {
+        m_camera->setWorldPosition(_pendingPosition);
+    } else if (_pendingAxesChanged) {
+        m_camera->setAxes(_pendingRight, _pendingDirection, _pendingUp);
+    }
+
+    _pendingPoseLoaded = false;
+    _pendingPositionChanged = false;
+    _pendingAxesChanged = false;
+
+    updateMembers();
+}
+
+bool CameraController::inTransaction() const
+{
+    return _transactionDepth > 0;
+}
+
+Cartesian3 CameraController::cameraPosition()
+{
+    if (_transactionDepth == 0) {
+        return m_camera->worldPosition();
+    }
+    loadPendingPose();
+    return _pendingPosition;
+}
+
+Cartesian3 CameraController::cameraDirection()
+{
+    if (_transactionDepth == 0) {
+        return m_camera->yaxis();
+    }
+    loadPendingPose();
+    return _pendingDirection;
+}
+
+Cartesian3 CameraController::cameraUp()
+{
+    if (_transactionDepth == 0) {
+        return m_camera->zaxis();
+    }
+    loadPendingPose();
+    return _pendingUp;
+}
+
+Cartesian3 CameraController::cameraRight()
+{
+    if (_transactionDepth == 0) {
+        return m_camera->xaxis();
+    }
+    loadPendingPose();
+    return _pendingRight;
+}
+
+void CameraController::setCameraPosition(const Cartesian3 &position)
+{
+    if (_transactionDepth == 0) {
+        m_camera->setWorldPosition(position);
+        return;
+    }
+    loadPendingPose();
+    _pendingPosition = position;
+    _pendingPositionChanged = true;
+}
+
+void CameraController::setCameraAxes(const Cartesian3 &right, const Cartesian3 &direction, const Cartesian3 &up)
+{
+    if (_transactionDepth == 0) {
+        m_camera->setAxes(right, direction, up);
+        return;
+    }
+    loadPendingPose();
+    _pendingRight = right;
+    _pendingDirection = direction;
+    _pendingUp = up;
+    _pendingAxesChanged = true;
+}
+
+void CameraController::applyCommands(const QVector<CameraCommand> &commands)
+{
+    for (const CameraCommand &command : commands) {
+        switch (command.type) {
+        case CameraCommand::Rotate:
+            rotate(command.axis, command.amount);
+            break;
+        case CameraCommand::RotateUp:
+            rotateUp(command.amount);
+            break;
+        case CameraCommand::RotateDown:
+            rotateDown(command.amount);
+            break;
+        case CameraCommand::RotateLeft:
+            rotateLeft(command.amount);
+            break;
+        case CameraCommand::RotateRight:
+            rotateRight(command.amount);
+            break;
+        case CameraCommand::Move:
+            move(command.axis, command.amount);
+            break;
+        case CameraCommand::MoveForward:
+            moveForward(command.amount);
+            break;
+        case CameraCommand::MoveBackward:
+            moveBackward(command.amount);
+            break;
+        case CameraCommand::MoveUp:
+            moveUp(command.amount);
+            break;
+        case CameraCommand::MoveDown:
+            moveDown(command.amount);
+            break;
+        case CameraCommand::MoveLeft:
+            moveLeft(command.amount);
+            break;
+        case CameraCommand::MoveRight:
+            moveRight(command.amount);
+            break;
+        case CameraCommand::Look:
+            look(command.axis, command.amount);
+            break;
+        case CameraCommand::LookUp:
+            lookUp(command.amount);
+            break;
+        case CameraCommand::LookDown:
+            lookDown(command.amount);
+            break;
+        case CameraCommand::LookLeft:
+            lookLeft(command.amount);
+            break;
+        case CameraCommand::LookRight:
+            lookRight(command.amount);
+            break;
+        case CameraCommand::ZoomIn:
+            zoomIn(command.amount);
+            break;
+        case CameraCommand::ZoomOut:
+            zoomOut(command.amount);
+            break;
+        case CameraCommand::SetView:
+            setView(command.axis, command.heading, command.pitch, command.roll);
+            break;
+        }
+    }
+}
+
+void CameraController::loadPendingPose()
+{
+    if (_pendingPoseLoaded) {
+        return;
+    }
+    _pendingPosition = m_camera->worldPosition();
+    _pendingDirection = m_camera->yaxis();
+    _pendingUp = m_camera->zaxis();
+    _pendingRight = m_camera->xaxis();
+    _pendingPoseLoaded = true;
+}
+
+quint64 CameraController::poseEpoch()
+{
+    updateMembers();
+    return _poseEpoch;
+}
+
+CameraMotionMetrics CameraController::motionMetrics()
+{
+    updateMembers();
+    return _motionMetrics;
+}
+
+void CameraController::updateMotionMetrics(double time)
+{
+    updateMembers();
+    sampleMotion(time);
+}
+
+void CameraController::setClock(CameraClock *clock)
+{
+    _clock = clock;
+}
+
+double CameraController::currentTime() const
+{
+    return _clock ? _clock->milliseconds() : double(getTimestamp());
+}
+
+double CameraController::fastMotionThreshold() const
+{
+    return _fastMotionThreshold;
+}
+
+void CameraController::setFastMotionThreshold(double threshold)
+{
+    _fastMotionThreshold = threshold;
+}
+
 Ray CameraController::getPickRayPerspective(double wx, double wy)
 {
     Ray ray;
 
-    LiWidget *canvas = m_scene->canvas();
+    CameraCanvas *canvas = m_canvas;
     int width = canvas->width();
     int height = canvas->height();
 
@@ -417,7 +864,7 @@ Ray CameraController::getPickRayPerspective(double wx, double wy)
 
 void CameraController::rotateVertical(double angle)
 {
-    Cartesian3 p = m_cameraTrans->worldPosition().normalize();
+    Cartesian3 p = cameraPosition().normalize();
     if (defined(constrainedAxis)) {
         bool northParallel = CesiumCartesian3::equalsEpsilon(p, constrainedAxis, Math::EPSILON2);
         bool southParallel = CesiumCartesian3::equalsEpsilon(p, -constrainedAxis, Math::EPSILON2);
@@ -439,10 +886,10 @@ void CameraController::rotateVertical(double angle)
             Cartesian3 tangent = Cartesian3::cross(constrainedAxis1, p);
             rotate(tangent, angle);
         } else if ((northParallel && angle < 0) || (southParallel && angle > 0)) {
-            rotate(m_cameraTrans->xaxis(), angle);
+            rotate(cameraRight(), angle);
         }
     } else {
-        rotate(m_cameraTrans->xaxis(), angle);
+        rotate(cameraRight(), angle);
     }
 }
 
@@ -451,21 +898,21 @@ void CameraController::rotateHorizontal(double angle)
     if (defined(constrainedAxis)) {
         rotate(constrainedAxis, angle);
     } else {
-        rotate(m_cameraTrans->zaxis(), angle);
+        rotate(cameraUp(), angle);
     }
 }
 
 void CameraController::zoom3D(double amount)
 {
-    move(m_cameraTrans->yaxis(), amount);
+    move(cameraDirection(), amount);
 }
 
 void CameraController::updateMembers()
 {
-    Cartesian3 position = m_cameraTrans->worldPosition();
-    Cartesian3 direction = m_cameraTrans->yaxis();
-    Cartesian3 up = m_cameraTrans->zaxis();
-    Cartesian3 right = m_cameraTrans->xaxis();
+    Cartesian3 position = cameraPosition();
+    Cartesian3 direction = cameraDirection();
+    Cartesian3 up = cameraUp();
+    Cartesian3 right = cameraRight();
 
     bool positionChanged = _position != position;
     if (positionChanged) {
@@ -475,21 +922,21 @@ void CameraController::updateMembers()
     bool directionChanged = _direction != direction;
     if (directionChanged) {
 //        direction.normalize();
-//        m_cameraTrans->setAxes(right, direction, up);
+//        setCameraAxes(right, direction, up);
         _direction = direction;
     }
 
     bool upChanged = _up != up;
     if (upChanged) {
 //        up.normalize();
-//        m_cameraTrans->setAxes(right, direction, up);
+//        setCameraAxes(right, direction, up);
         _up = up;
     }
 
     bool rightChanged = _right != right;
     if (rightChanged) {
 //        right.normalize();
-//        m_cameraTrans->setAxes(right, direction, up);
+//        setCameraAxes(right, direction, up);
         _right = right;
     }
 
@@ -500,6 +947,7 @@ void CameraController::updateMembers()
         _invTransform = _transform.inverseTransformation();
         _actualTransform = _transform;
         _actualInvTransform = _actualTransform.inverseTransformation();
+        _worldToCamera = BatchTransform::fromMatrix(_actualInvTransform);
     }
 
     if (positionChanged || transformChanged) {
@@ -519,7 +967,7 @@ void CameraController::updateMembers()
             _up = (_up - w0).normalize();
             _right = Cartesian3::cross(_direction, _up).normalize();
 
-            m_cameraTrans->setAxes(_right, direction, _up);
+            setCameraAxes(_right, direction, _up);
         }
     }
 
@@ -537,6 +985,72 @@ void CameraController::updateMembers()
         _rightWC = multiplyByPointAsVector(_actualTransform, _right);
         _rightWC.normalize();
     }
+
+    if (positionChanged || directionChanged || upChanged || rightChanged || transformChanged) {
+        // only a change of the world pose counts, switching the reference frame alone does not
+        if (_positionWC != _epochPositionWC || _directionWC != _epochDirectionWC || _upWC != _epochUpWC) {
+            _epochPositionWC = _positionWC;
+            _epochDirectionWC = _directionWC;
+            _epochUpWC = _upWC;
+            // 只记录位姿变化, 运动指标在updateMotionMetrics中按帧时间采样
+            ++_poseEpoch;
+        }
+    }
+}
+
+void CameraController::sampleMotion(double now)
+{
+    // 同一帧内的多次位姿变化合并到下一次采样
+    const double minimumInterval = 4.0;
+    // 指数平滑的时间常数 (秒)
+    const double smoothingTime = 0.15;
+
+    if (_motionSampleTime < 0.0) {
+        _motionSampleTime = now;
+        _motionPositionWC = _positionWC;
+        _motionDirectionWC = _directionWC;
+        _motionUpWC = _upWC;
+        return;
+    }
+
+    double elapsed = now - _motionSampleTime;
+    if (elapsed < minimumInterval) {
+        return;
+    }
+    double dt = elapsed / 1000.0;
+
+    double distance = (_positionWC - _motionPositionWC).magnitude();
+    double angle = qMax(CesiumMath::acosClamped(Cartesian3::dot(_directionWC, _motionDirectionWC)),
+                        CesiumMath::acosClamped(Cartesian3::dot(_upWC, _motionUpWC)));
+
+    _motionSampleTime = now;
+    _motionPositionWC = _positionWC;
+    _motionDirectionWC = _directionWC;
+    _motionUpWC = _upWC;
+
+    // 平移在屏幕上的角速度按相机到椭球面的高度估算
+    double depth = qMax(abs(_positionCartographic.height), 1.0);
+    double pixelsPerRadian = 0.0;
+    if (m_canvas && m_camera) {
+        pixelsPerRadian = m_canvas->height() / (2.0 * tan(Math::toRadians(m_camera->fovy()) * 0.5));
+    }
+
+    double linearVelocity = distance / dt;
+    double angularVelocity = angle / dt;
+    double screenMotionRate = (angle + distance / depth) * pixelsPerRadian / dt;
+
+    double alpha = 1.0 - exp(-dt / smoothingTime);
+    _motionMetrics.linearVelocity += alpha * (linearVelocity - _motionMetrics.linearVelocity);
+    _motionMetrics.angularVelocity += alpha * (angularVelocity - _motionMetrics.angularVelocity);
+    _motionMetrics.screenMotionRate += alpha * (screenMotionRate - _motionMetrics.screenMotionRate);
+
+    bool fastMotion = _motionMetrics.fastMotion ?
+                _motionMetrics.screenMotionRate > _fastMotionThreshold * 0.5 :
+                _motionMetrics.screenMotionRate > _fastMotionThreshold;
+    if (fastMotion != _motionMetrics.fastMotion) {
+        _motionMetrics.fastMotion = fastMotion;
+        emit fastMotionChanged(fastMotion);
+    }
 }
 
 double CameraController::getHeading(const Cartesian3 &direction, const Cartesian3 &up)
@@ -582,13 +1096,54 @@ void CameraController::setView3D(const Cartesian3 &destination, double heading,
     Cartesian3 up = rotMat.column(2).normalize();
     Cartesian3 right = Cartesian3::cross(direction, up).normalize();
 
-    m_cameraTrans->setWorldPosition(Vector3(0, 0, 0));
-    m_cameraTrans->setAxes(right, direction, up);
+    setCameraPosition(Vector3(0, 0, 0));
+    setCameraAxes(right, direction, up);
 
     _setTransform(currentTransform);
 }
 
-Cartesian3 CameraController::rectangleCameraPosition3D(const LiRectangle &rectangle)
+void CameraController::computeAxes(const CameraPose &pose, Cartesian3 &direction, Cartesian3 &up, Cartesian3 &right)
+{
+    // same as setView3D, without touching the camera transform
+    Matrix4 localTransform = eastNorthUpToFixedFrame(pose.position);
+
+    Quaternion rotQuat = CesiumMath::fromHeadingPitchRoll(pose.heading - M_PI_2, pose.pitch, pose.roll);
+    Matrix3 rotMat = rotQuat.toRotationMatrix();
+
+    direction = multiplyByPointAsVector(localTransform, rotMat.column(0)).normalize();
+    up = multiplyByPointAsVector(localTransform, rotMat.column(2)).normalize();
+    right = Cartesian3::cross(direction, up).normalize();
+}
+
+void CameraController::computeFootprint(const Cartesian3 &position, const Cartesian3 &direction, const Cartesian3 &up, const Cartesian3 &right, QVector<Cartesian3> &footprint)
+{
+    double tanPhi = tan(Math::toRadians(m_camera->fovy()) * 0.5);
+    double tanTheta = m_camera->aspectRatio() * tanPhi;
+
+    const double corners[4][2] = {
+        { -1.0, -1.0 },
+        {  1.0, -1.0 },
+        {  1.0,  1.0 },
+        { -1.0,  1.0 }
+    };
+
+    footprint.resize(4);
+    for (int i = 0; i < 4; ++i) {
+        Ray ray;
+        ray.origin = position;
+        ray.direction = direction + right * (corners[i][0] * tanTheta) + up * (corners[i][1] * tanPhi);
+        ray.direction.normalize();
+
+        Interval intersection = IntersectionTests::rayEllipsoid(ray, m_ellipsoid);
+        if (defined(intersection)) {
+            footprint[i] = ray.getPoint(intersection.start > 0.0 ? intersection.start : intersection.stop);
+        } else {
+            footprint[i] = Cartesian3(Math::EPSILON20, 0, 0);
+        }
+    }
+}
+
+Cartesian3 CameraController::rectangleCameraPosition3D(const LiRectangle &rectangle, double fovy, double aspectRatio)
 {
     CameraRF cameraRF;
 
@@ -668,15 +1223,15 @@ Cartesian3 CameraController::rectangleCameraPosition3D(const LiRectangle &rectan
     northCenter -= center;
     southCenter -= center;
 
-    cameraRF.direction = Ellipsoid::WGS84()->geodeticSurfaceNormal(center);
+    cameraRF.direction = m_ellipsoid->geodeticSurfaceNormal(center);
     cameraRF.direction = -cameraRF.direction;
     cameraRF.right = Cartesian3::cross(cameraRF.direction, Cartesian3::UNIT_Z);
     cameraRF.right.normalize();
     cameraRF.up = Cartesian3::cross(cameraRF.right, cameraRF.direction);
 
     double d;
-    double tanPhi = tan(Math::toRadians(m_camera->fovy()) * 0.5);
-    double tanTheta = m_camera->aspectRatio() * tanPhi;
+    double tanPhi = tan(Math::toRadians(fovy) * 0.5);
+    double tanTheta = aspectRatio * tanPhi;
 
     d = std::max(computeD(cameraRF.direction, cameraRF.up, northWest, tanPhi),
                  computeD(cameraRF.direction, cameraRF.up, southEast, tanPhi));
@@ -7,14 +7,45 @@
 #include "ray.h"
 #include "cartographic.h"
 #include "rectangle.h"
+#include "screenspaceeventutils.h"
+#include "cameratour.h"
+#include "batchtransform.h"
+#include "windowprojection.h"
+#include "cullingvolume.h"
+#include "sphere.h"
+#include "cameracommandbuffer.h"
+#include "cameraenvironment.h"
 
-class LiScene;
-class LiCamera;
 class Ellipsoid;
-class Globe;
 class Tween;
 class TweenCollection;
-class LiTransform;
+class CameraPathFile;
+class CameraClock;
+
+/**
+ * @brief 飞行过程中预测的相机状态
+ *
+ */
+struct CameraFlightSample {
+    double timeOffset = 0.0; ///< 相对当前时刻的时间偏移 (秒)
+    bool valid = false; ///< 该时刻是否处于飞行中
+    CameraPose pose; ///< 相机的位姿
+    Cartesian3 direction; ///< 相机的y轴方向 (世界坐标)
+    Cartesian3 up; ///< 相机的z轴方向 (世界坐标)
+    Cartesian3 right; ///< 相机的x轴方向 (世界坐标)
+    QVector<Cartesian3> footprint; ///< 视锥四个角的射线与椭球的交点(左下, 右下, 右上, 左上), 没有交点时为Cartesian3(Math::EPSILON20, 0, 0)
+};
+
+/**
+ * @brief 相机的运动指标 (平滑后的值), 用于在快速运动时降低渲染质量
+ *
+ */
+struct CameraMotionMetrics {
+    double linearVelocity = 0.0; ///< 线速度 (米/秒, 世界坐标)
+    double angularVelocity = 0.0; ///< 角速度 (弧度/秒)
+    double screenMotionRate = 0.0; ///< 屏幕内容的运动速率 (像素/秒)
+    bool fastMotion = false; ///< 是否处于快速运动
+};
 
 /**
  * @brief 相机的相关操作类
@@ -40,12 +71,11 @@ public:
     /**
      * @brief 带参构造
      *
-     * @param scene 场景
-     * @param camera 相机
+     * @param environment 窗口, 地球和相机 (camera和canvas不能为空)
      * @param tweens 动画合集
-     * @param parent 父类指针
+     * @param parent 父类指针, 飞行时通过它禁用ScreenSpaceCameraController的输入
      */
-    CameraController(LiScene *scene, LiCamera *camera, TweenCollection *tweens, QObject *parent = nullptr);
+    CameraController(const CameraEnvironment &environment, TweenCollection *tweens, QObject *parent = nullptr);
 
     /**
      * @brief 改变相机的状态(位置, 偏转角度等)
@@ -64,6 +94,76 @@ public:
      */
     void _setTransform(const Matrix4 &transform);
 
+    /**
+     * @brief 开始一次相机位姿的事务, 事务期间对相机位姿的读写都在本地的位姿上进行, 可以嵌套
+     *
+     */
+    void beginTransaction();
+
+    /**
+     * @brief 提交事务, 最外层的提交把位姿写入LiTransform (只写改变了的部分) 并更新成员变量
+     *
+     */
+    void commitTransaction();
+
+    /**
+     * @brief 是否处于事务中
+     *
+     * @return bool true: 处于事务中
+     */
+    bool inTransaction() const;
+
+    /**
+     * @brief 获取相机在transform坐标系下的位置 (事务中返回本地位姿)
+     *
+     * @return Cartesian3 位置
+     */
+    Cartesian3 cameraPosition();
+
+    /**
+     * @brief 获取相机在transform坐标系下的y轴方向 (事务中返回本地位姿)
+     *
+     * @return Cartesian3 y轴方向
+     */
+    Cartesian3 cameraDirection();
+
+    /**
+     * @brief 获取相机在transform坐标系下的z轴方向 (事务中返回本地位姿)
+     *
+     * @return Cartesian3 z轴方向
+     */
+    Cartesian3 cameraUp();
+
+    /**
+     * @brief 获取相机在transform坐标系下的x轴方向 (事务中返回本地位姿)
+     *
+     * @return Cartesian3 x轴方向
+     */
+    Cartesian3 cameraRight();
+
+    /**
+     * @brief 设置相机在transform坐标系下的位置, 事务中在提交时才写入LiTransform
+     *
+     * @param position 位置
+     */
+    void setCameraPosition(const Cartesian3 &position);
+
+    /**
+     * @brief 设置相机在transform坐标系下的方向, 事务中在提交时才写入LiTransform
+     *
+     * @param right x轴方向
+     * @param direction y轴方向
+     * @param up z轴方向
+     */
+    void setCameraAxes(const Cartesian3 &right, const Cartesian3 &direction, const Cartesian3 &up);
+
+    /**
+     * @brief 按顺序执行一组相机操作, 在事务中调用时只在提交时写一次LiTransform
+     *
+     * @param commands 相机操作
+     */
+    void applyCommands(const QVector<CameraCommand> &commands);
+
     /**
      * @brief 拾取
      *
@@ -92,6 +192,37 @@ public:
      */
     void pickEllipsoid3D(const Cartesian2 &windowPosition, Ellipsoid *ellipsoid, Cartesian3 &result);
 
+    /**
+     * @brief 在球上拾取 (闭式解), 用于手势中按拾取点半径构造的球面
+     *
+     * @param windowPosition 屏幕坐标
+     * @param sphere 球
+     * @param result 按引用传递一个参数
+     * @return Cartesian3 三维场景里的一个点 (世界坐标)
+     */
+    Cartesian3 pickEllipsoid(const Cartesian2 &windowPosition, const Sphere &sphere, Cartesian3 &result);
+
+    /**
+     * @brief 在球上拾取 (闭式解)
+     *
+     * @param windowPosition 屏幕坐标
+     * @param sphere 球
+     * @param result 按引用传递一个参数, 最后变成拾取的结果
+     */
+    void pickEllipsoid3D(const Cartesian2 &windowPosition, const Sphere &sphere, Cartesian3 &result);
+
+    /**
+     * @brief 批量在椭球上拾取, 用于按屏幕采样的批处理
+     *
+     * @param windowPositions 屏幕坐标
+     * @param ellipsoid 椭球
+     * @param results 拾取的结果 (世界坐标), 没有交点时为Cartesian3(Math::EPSILON20, 0, 0)
+     * @param relativeToCenter true: 以相机为中心在float中求交, 误差估计超过tolerance时回退到double (见RtcEllipsoidPicker); false: 逐点调用pickEllipsoid3D
+     * @param tolerance 单精度模式允许的误差, 以交点处一个像素的大小为单位
+     */
+    void pickEllipsoidBatch(const QVector<Cartesian2> &windowPositions, Ellipsoid *ellipsoid, QVector<Cartesian3> &results,
+                            bool relativeToCenter = false, double tolerance = 0.05);
+
     /**
      * @brief 从相机向一个屏幕点(x, y)发射一条射线 (相机拾取)
      *
@@ -101,6 +232,56 @@ public:
      */
     Q_INVOKABLE Ray getPickRay(double x, double y);
 
+    /**
+     * @brief 将世界坐标投影到屏幕坐标 (getPickRay的逆运算)
+     *
+     * @param position 世界坐标
+     * @param flags 不为空时返回WindowProjection::Flag (在屏幕内, 在相机背后, 在屏幕外)
+     * @return Cartesian2 屏幕坐标, 在相机背后时为Cartesian2(Math::EPSILON20, 0)
+     */
+    Cartesian2 projectToWindow(const Cartesian3 &position, int *flags = nullptr);
+
+    /**
+     * @brief 批量将世界坐标投影到屏幕坐标 (SoA数组)
+     *
+     * @param x 世界坐标的x数组
+     * @param y 世界坐标的y数组
+     * @param z 世界坐标的z数组
+     * @param windowX 屏幕坐标的x数组, 在相机背后时为Math::EPSILON20
+     * @param windowY 屏幕坐标的y数组
+     * @param flags 每个点的WindowProjection::Flag, 可以为空
+     * @param count 点的数量
+     */
+    void projectToWindow(const double *x, const double *y, const double *z,
+                         double *windowX, double *windowY, quint8 *flags, int count);
+
+    /**
+     * @brief 获取当前的投影 (在poseEpoch, 视角, 宽高比, 近裁剪面或窗口大小改变时重新计算)
+     *
+     * @return WindowProjection 投影
+     */
+    WindowProjection windowProjection();
+
+    /**
+     * @brief 获取当前的裁剪体 (在poseEpoch, 视角, 宽高比或近/远裁剪面改变时重新计算)
+     *
+     * @return CullingVolume 裁剪体
+     */
+    CullingVolume cullingVolume();
+
+    /**
+     * @brief 批量测试包围球的可见性 (SoA数组)
+     *
+     * @param x 球心的x数组 (世界坐标)
+     * @param y 球心的y数组
+     * @param z 球心的z数组
+     * @param radius 半径数组
+     * @param results 每个包围球的CullingVolume::Visibility (在内, 相交, 在外)
+     * @param count 包围球的数量
+     */
+    void computeVisibility(const double *x, const double *y, const double *z, const double *radius,
+                           qint8 *results, int count);
+
     /**
      * @brief  相机围绕axis轴旋转
      *
@@ -245,12 +426,38 @@ public:
      */
     Cartesian3 getRectangleCameraCoordinates(const LiRectangle &rectangle);
 
+    /**
+     * @brief 计算能看到整个矩形范围的相机位置 (静态函数)
+     *
+     * @param rectangle 矩形范围 (弧度)
+     * @param fovy 相机的视角 (度)
+     * @param aspectRatio 相机的宽高比
+     * @return Cartesian3 相机的世界坐标
+     */
+    static Cartesian3 rectangleCameraPosition3D(const LiRectangle &rectangle, double fovy, double aspectRatio);
+
     /**
      * @brief 取消相机的飞行
      *
      */
     void cancelFlight();
 
+    /**
+     * @brief 相机是否正在飞行
+     *
+     * @return bool true: 是, false: 否
+     */
+    bool isFlying() const;
+
+    /**
+     * @brief 预测当前飞行在未来若干时刻的相机状态, 用于提前加载地形和影像
+     *
+     * @param timeOffsets 相对当前时刻的时间偏移 (秒)
+     * @param withFootprint 是否计算视锥在椭球上的覆盖范围
+     * @return QVector<CameraFlightSample> 与timeOffsets一一对应, 没有飞行时返回的结果均为无效, 超过飞行结束时间的结果也无效
+     */
+    QVector<CameraFlightSample> sampleFlight(const QVector<double> &timeOffsets, bool withFootprint = false);
+
     /**
      * @brief 相机飞到目标点 (Vector3类型)
      *
@@ -284,6 +491,26 @@ public:
      */
     Q_INVOKABLE void flyTo(const LiRectangle &destination, double duration  = Math::EPSILON20, double heading = 0, double pitch = -90, double roll = 0);
 
+    /**
+     * @brief 相机沿多个途经点连续漫游, 整个漫游只创建一个动画, 途经点之间不会停顿或重新起飞
+     *
+     * 第一个途经点的时间无效或大于0时, 先从相机当前的位姿飞到第一个途经点.
+     * 只有一个时间为0的途经点时直接设置到该点, 不创建动画
+     *
+     * @param waypoints 途经点, 时间相对漫游开始 (秒)
+     */
+    void flyTour(const QVector<CameraWaypoint> &waypoints);
+
+    /**
+     * @brief 回放相机路径文件, 通过动画时钟驱动setView, 可以用cancelFlight停止
+     *
+     * @param path 已打开的相机路径文件, 回放期间保持打开
+     * @param startTime 回放的起始时间 (秒, 路径文件的时间), 无效时从第一个关键帧开始
+     * @param speed 回放速度, 1.0为原速
+     * @param fovCallback 视角回调函数 (度), 路径文件包含视角时每一帧调用
+     */
+    void playPath(const QSharedPointer<CameraPathFile> &path, double startTime = Math::EPSILON20, double speed = 1.0, const TweenAction1 &fovCallback = nullptr);
+
     /**
      * @brief 获取相机更新后的转置矩阵
      *
@@ -333,6 +560,48 @@ public:
      */
     void worldToCameraCoordinates(Cartesian3 &cartesian);
 
+    /**
+     * @brief 批量将世界坐标点转换到相机坐标系 (与worldToCameraCoordinates相同), 输入输出可以是同一组数组
+     *
+     * @param x 世界坐标的x数组
+     * @param y 世界坐标的y数组
+     * @param z 世界坐标的z数组
+     * @param resultX 相机坐标系的x数组
+     * @param resultY 相机坐标系的y数组
+     * @param resultZ 相机坐标系的z数组
+     * @param count 点的数量
+     */
+    void worldToCameraCoordinates(const double *x, const double *y, const double *z,
+                                  double *resultX, double *resultY, double *resultZ, int count);
+
+    /**
+     * @brief 批量将世界坐标点转换到相机局部坐标系 (原点为相机位置, x: right, y: direction, z: up), 输入输出可以是同一组数组
+     *
+     * @param x 世界坐标的x数组
+     * @param y 世界坐标的y数组
+     * @param z 世界坐标的z数组
+     * @param resultX 相机局部坐标的x数组
+     * @param resultY 相机局部坐标的y数组
+     * @param resultZ 相机局部坐标的z数组
+     * @param count 点的数量
+     */
+    void worldToViewCoordinates(const double *x, const double *y, const double *z,
+                                double *resultX, double *resultY, double *resultZ, int count);
+
+    /**
+     * @brief 获取世界坐标到相机坐标系的变换 (只在相机的矩阵改变时重新计算)
+     *
+     * @return BatchTransform 变换
+     */
+    BatchTransform worldToCameraTransform();
+
+    /**
+     * @brief 获取世界坐标到相机局部坐标系的变换 (只在poseEpoch改变时重新计算)
+     *
+     * @return BatchTransform 变换
+     */
+    BatchTransform worldToViewTransform();
+
     /**
      * @brief 获取相机的 heading
      *
@@ -354,6 +623,57 @@ public:
      */
     double roll();
 
+    /**
+     * @brief 一次计算相机的heading, pitch和roll, 不修改相机的位姿
+     *
+     * @param heading 按引用传递一个参数, 最后变成heading
+     * @param pitch 按引用传递一个参数, 最后变成pitch
+     * @param roll 按引用传递一个参数, 最后变成roll
+     */
+    void headingPitchRoll(double &heading, double &pitch, double &roll);
+
+    /**
+     * @brief 获取相机位姿的版本号, 相机在世界坐标系下的位置或方向每改变一次加1
+     *
+     * @return quint64 版本号
+     */
+    quint64 poseEpoch();
+
+    /**
+     * @brief 获取相机的运动指标
+     *
+     * @return CameraMotionMetrics 运动指标
+     */
+    CameraMotionMetrics motionMetrics();
+
+    /**
+     * @brief 每帧调用一次, 按该帧的时间采样相机位姿, 相机静止时运动指标随时间衰减
+     *
+     * @param time 当前帧的时间 (毫秒)
+     */
+    void updateMotionMetrics(double time);
+
+    /**
+     * @brief 设置时钟, 用于飞行预测, 为空时使用getTimestamp()
+     *
+     * @param clock 时钟 (不拥有), 应与TweenCollection::update的时间来自同一时钟
+     */
+    void setClock(CameraClock *clock);
+
+    /**
+     * @brief 获取进入快速运动的阈值
+     *
+     * @return double 屏幕内容的运动速率 (像素/秒)
+     */
+    double fastMotionThreshold() const;
+
+    /**
+     * @brief 设置进入快速运动的阈值, 默认500像素/秒, 速率降到阈值的一半以下时退出快速运动
+     *
+     * @param threshold 屏幕内容的运动速率 (像素/秒)
+     */
+    void setFastMotionThreshold(double threshold);
+
     Matrix4 _transform; ///< 相机的矩阵
     Matrix4 _invTransform; ///< 相机的转置矩阵
     Matrix4 _actualTransform; ///< 相机的实际矩阵
@@ -376,6 +696,14 @@ public:
     Cartesian3 constrainedAxis = Cartesian3(Math::EPSILON20, 0, 0); ///< 相机的默认旋转轴
     double _minimumCollisionTerrainHeight = 15000.0; ///< 测试与地形碰撞前相机必须达到的最小高度, 可由ScreenSpaceCameraController修改
 
+signals:
+    /**
+     * @brief 进入或退出快速运动时发出
+     *
+     * @param fastMotion true: 进入快速运动, false: 相机已稳定
+     */
+    void fastMotionChanged(bool fastMotion);
+
 private:
     Ray getPickRayPerspective(double wx, double wy);
 
@@ -385,6 +713,9 @@ private:
     void zoom3D(double amount);
 
     void updateMembers();
+    void loadPendingPose();
+    void sampleMotion(double now);
+    double currentTime() const;
 
     double getHeading(const Cartesian3 &direction, const Cartesian3 &up);
     double getPitch(const Cartesian3 &direction);
@@ -392,20 +723,49 @@ private:
 
     void setView3D(const Cartesian3 &destination, double heading, double pitch, double roll);
 
-    Cartesian3 rectangleCameraPosition3D(const LiRectangle &rectangle);
+    void computeAxes(const CameraPose &pose, Cartesian3 &direction, Cartesian3 &up, Cartesian3 &right);
+    void computeFootprint(const Cartesian3 &position, const Cartesian3 &direction, const Cartesian3 &up, const Cartesian3 &right, QVector<Cartesian3> &footprint);
 
-    double computeD(const Cartesian3 &direction, const Cartesian3 &upOrRight, const Cartesian3 &corner, double tanThetaOrPhi);
+    static double computeD(const Cartesian3 &direction, const Cartesian3 &upOrRight, const Cartesian3 &corner, double tanThetaOrPhi);
 
     Cartesian3 multiplyByPoint(const Matrix4 &matrix, const Cartesian3 &cartesian);
     Cartesian3 multiplyByPointAsVector(const Matrix4 &matrix, const Cartesian3 &cartesian);
 
-    LiScene *m_scene;
-    Globe *m_globe;
-    LiCamera *m_camera;
-    LiTransform *m_cameraTrans;
+    CameraCanvas *m_canvas = nullptr;
+    CameraGlobe *m_globe = nullptr;
+    CameraRig *m_camera = nullptr;
+    Ellipsoid *m_ellipsoid = nullptr;
     TweenCollection *m_tweens;
     Tween *_currentFlight = nullptr;
     bool _suspendTerrainAdjustment = false;
+    int _transactionDepth = 0;
+    bool _pendingPoseLoaded = false; ///< 事务中是否已经从LiTransform读入本地位姿
+    bool _pendingPositionChanged = false;
+    bool _pendingAxesChanged = false;
+    Cartesian3 _pendingPosition; ///< 事务中的本地位姿
+    Cartesian3 _pendingDirection;
+    Cartesian3 _pendingUp;
+    Cartesian3 _pendingRight;
+    quint64 _poseEpoch = 0;
+    BatchTransform _worldToCamera; ///< _actualInvTransform的刚体部分
+    BatchTransform _worldToView;
+    quint64 _worldToViewEpoch = 0;
+    bool _worldToViewValid = false;
+    WindowProjection _windowProjection;
+    quint64 _windowProjectionEpoch = 0;
+    CullingVolume _cullingVolume;
+    quint64 _cullingVolumeEpoch = 0;
+    Cartesian3 _epochPositionWC;
+    Cartesian3 _epochDirectionWC;
+    Cartesian3 _epochUpWC;
+
+    CameraMotionMetrics _motionMetrics;
+    double _fastMotionThreshold = 500.0;
+    CameraClock *_clock = nullptr;
+    double _motionSampleTime = -1.0; ///< 上一次采样的时间戳 (毫秒), 小于0时还没有采样
+    Cartesian3 _motionPositionWC; ///< 上一次采样时的相机位姿
+    Cartesian3 _motionDirectionWC;
+    Cartesian3 _motionUpWC;
 
     struct CameraRF {
         Cartesian3 direction;
@@ -414,4 +774,28 @@ private:
     };
 };
 
+/**
+ * @brief 相机位姿事务的作用域, 构造时开始事务, 析构时提交
+ *
+ */
+class CameraTransaction
+{
+public:
+    explicit CameraTransaction(CameraController *controller)
+        : _controller(controller)
+    {
+        _controller->beginTransaction();
+    }
+
+    ~CameraTransaction()
+    {
+        _controller->commitTransaction();
+    }
+
+private:
+    Q_DISABLE_COPY(CameraTransaction)
+
+    CameraController *_controller;
+};
+
 #endif // CAMERACONTROLLER_H
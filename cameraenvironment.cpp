@@ -0,0 +1,206 @@
+#include "cameraenvironment.h"
+#include "intersectiontests.h"
+#include "screenspaceeventutils.h"
+#include "ellipsoid.h"
+#include "liviewer.h"
+#include "liengine.h"
+#include "liinputsystem.h"
+#include "liscene.h"
+#include "liwidget.h"
+#include "licamera.h"
+#include "litransform.h"
+#include "liraycasthit.h"
+#include "globe.h"
+
+CameraCanvas::~CameraCanvas()
+{
+}
+
+CameraInput::~CameraInput()
+{
+}
+
+CameraGlobe::~CameraGlobe()
+{
+}
+
+bool CameraGlobe::raycast(const Ray &ray, Cartesian3 *result)
+{
+    Cartesian3 intersection;
+    pick(ray, &intersection);
+    if (intersection.isNull()) {
+        return false;
+    }
+    *result = intersection;
+    return true;
+}
+
+CameraRig::~CameraRig()
+{
+}
+
+void CameraRig::setPose(const Cartesian3 &position, const Cartesian3 &xaxis, const Cartesian3 &yaxis, const Cartesian3 &zaxis)
+{
+    setWorldPosition(position);
+    setAxes(xaxis, yaxis, zaxis);
+}
+
+EllipsoidCameraGlobe::EllipsoidCameraGlobe(Ellipsoid *ellipsoid)
+    : _ellipsoid(ellipsoid)
+{
+}
+
+void EllipsoidCameraGlobe::pick(const Ray &ray, Cartesian3 *result)
+{
+    Interval intersection = IntersectionTests::rayEllipsoid(ray, _ellipsoid);
+    if (!defined(intersection)) {
+        return;
+    }
+    *result = ray.getPoint(intersection.start > 0.0 ? intersection.start : intersection.stop);
+}
+
+double EllipsoidCameraGlobe::getHeight(const Cartographic &cartographic)
+{
+    Q_UNUSED(cartographic)
+    return 0.0;
+}
+
+SimpleCameraRig::SimpleCameraRig()
+    : _right(1.0, 0.0, 0.0)
+    , _direction(0.0, 1.0, 0.0)
+    , _up(0.0, 0.0, 1.0)
+{
+}
+
+void SimpleCameraRig::setAxes(const Cartesian3 &xaxis, const Cartesian3 &yaxis, const Cartesian3 &zaxis)
+{
+    _right = xaxis;
+    _direction = yaxis;
+    _up = zaxis;
+}
+
+void SimpleCameraRig::setPose(const Cartesian3 &position, const Cartesian3 &xaxis, const Cartesian3 &yaxis, const Cartesian3 &zaxis)
+{
+    _position = position;
+    _right = xaxis;
+    _direction = yaxis;
+    _up = zaxis;
+}
+
+void SimpleCameraRig::setFrustum(double fovy, double aspectRatio, double nearPlane, double farPlane)
+{
+    _fovy = fovy;
+    _aspectRatio = aspectRatio;
+    _nearPlane = nearPlane;
+    _farPlane = farPlane;
+}
+
+class LiCameraEnvironment::CanvasAdapter : public CameraCanvas
+{
+public:
+    explicit CanvasAdapter(LiWidget *canvas) : _canvas(canvas) {}
+
+    int width() const override { return _canvas->width(); }
+    int height() const override { return _canvas->height(); }
+
+private:
+    LiWidget *_canvas;
+};
+
+class LiCameraEnvironment::InputAdapter : public CameraInput
+{
+public:
+    explicit InputAdapter(LiInputSystem *input) : _input(input) {}
+
+    bool getKey(int key) const override { return _input->getKey(key); }
+    LiInputSystem *inputSystem() const override { return _input; }
+
+private:
+    LiInputSystem *_input;
+};
+
+class LiCameraEnvironment::GlobeAdapter : public CameraGlobe
+{
+public:
+    explicit GlobeAdapter(LiScene *scene) : _scene(scene) {}
+
+    void pick(const Ray &ray, Cartesian3 *result) override
+    {
+        // 场景的地球可能被替换, 每次从场景获取
+        if (Globe *globe = _scene->globe()) {
+            globe->pick(ray, result);
+        }
+    }
+
+    double getHeight(const Cartographic &cartographic) override
+    {
+        Globe *globe = _scene->globe();
+        return globe ? globe->getHeight(cartographic) : 0.0;
+    }
+
+    bool raycast(const Ray &ray, Cartesian3 *result) override
+    {
+        LiRaycastHit raycastHit;
+        if (!_scene->raycast(ray, &raycastHit)) {
+            return false;
+        }
+        *result = raycastHit.point();
+        return true;
+    }
+
+private:
+    LiScene *_scene;
+};
+
+class LiCameraEnvironment::RigAdapter : public CameraRig
+{
+public:
+    explicit RigAdapter(LiCamera *camera) : _camera(camera), _transform(camera->transform()) {}
+
+    Cartesian3 worldPosition() const override { return _transform->worldPosition(); }
+    Cartesian3 xaxis() const override { return _transform->xaxis(); }
+    Cartesian3 yaxis() const override { return _transform->yaxis(); }
+    Cartesian3 zaxis() const override { return _transform->zaxis(); }
+    void setWorldPosition(const Cartesian3 &position) override { _transform->setWorldPosition(position); }
+    void setAxes(const Cartesian3 &xaxis, const Cartesian3 &yaxis, const Cartesian3 &zaxis) override { _transform->setAxes(xaxis, yaxis, zaxis); }
+    // LiTransform没有同时设置位置和方向的接口, setPose使用默认实现 (两次写入)
+
+    double fovy() const override { return _camera->fovy(); }
+    double aspectRatio() const override { return _camera->aspectRatio(); }
+    double nearPlane() const override { return _camera->nearPlane(); }
+    double farPlane() const override { return _camera->farPlane(); }
+
+    void completeFlight() override { emit _camera->completeFlight(); }
+
+private:
+    LiCamera *_camera;
+    LiTransform *_transform;
+};
+
+LiCameraEnvironment::LiCameraEnvironment(LiViewer *viewer)
+{
+    LiScene *scene = viewer->scene();
+    _canvas = new CanvasAdapter(scene->canvas());
+    _input = new InputAdapter(viewer->engine()->inputSystem());
+    _globe = new GlobeAdapter(scene);
+    _camera = new RigAdapter(scene->mainCamera());
+}
+
+LiCameraEnvironment::~LiCameraEnvironment()
+{
+    delete _canvas;
+    delete _input;
+    delete _globe;
+    delete _camera;
+}
+
+CameraEnvironment LiCameraEnvironment::environment() const
+{
+    CameraEnvironment environment;
+    environment.canvas = _canvas;
+    environment.input = _input;
+    environment.globe = _globe;
+    environment.camera = _camera;
+    environment.ellipsoid = Ellipsoid::WGS84();
+    return environment;
+}
@@ -0,0 +1,241 @@
+#ifndef CAMERAENVIRONMENT_H
+#define CAMERAENVIRONMENT_H
+
+#include "sscc_global.h"
+#include "cartesian3.h"
+#include "cartographic.h"
+#include "ray.h"
+
+class LiViewer;
+class LiInputSystem;
+class Ellipsoid;
+
+/**
+ * @brief 窗口大小
+ *
+ */
+class CONTROLLER_EXPORT CameraCanvas
+{
+public:
+    virtual ~CameraCanvas();
+
+    virtual int width() const = 0;
+    virtual int height() const = 0;
+};
+
+/**
+ * @brief 键盘和鼠标输入
+ *
+ */
+class CONTROLLER_EXPORT CameraInput
+{
+public:
+    virtual ~CameraInput();
+
+    /**
+     * @brief 按键是否按下
+     *
+     * @param key Qt::Key
+     * @return bool true: 按下, false: 没有按下
+     */
+    virtual bool getKey(int key) const = 0;
+
+    /**
+     * @brief 鼠标事件的来源
+     *
+     * @return LiInputSystem* 为空时只能通过handleTouchEvent, submitCommands和相机操作的接口驱动相机
+     */
+    virtual LiInputSystem *inputSystem() const { return nullptr; }
+};
+
+/**
+ * @brief 地球的拾取和高程
+ *
+ */
+class CONTROLLER_EXPORT CameraGlobe
+{
+public:
+    virtual ~CameraGlobe();
+
+    /**
+     * @brief 拾取地球表面 (包括地形)
+     *
+     * @param ray 射线
+     * @param result 交点, 没有交点时不修改
+     */
+    virtual void pick(const Ray &ray, Cartesian3 *result) = 0;
+
+    /**
+     * @brief 获取地形高度
+     *
+     * @param cartographic 位置 (忽略高度)
+     * @return double 地形高度
+     */
+    virtual double getHeight(const Cartographic &cartographic) = 0;
+
+    /**
+     * @brief 拾取场景 (模型和地球), 默认只拾取地球
+     *
+     * @param ray 射线
+     * @param result 交点
+     * @return bool true: 有交点, false: 没有交点
+     */
+    virtual bool raycast(const Ray &ray, Cartesian3 *result);
+};
+
+/**
+ * @brief 相机的变换和视锥
+ *
+ */
+class CONTROLLER_EXPORT CameraRig
+{
+public:
+    virtual ~CameraRig();
+
+    virtual Cartesian3 worldPosition() const = 0;
+    virtual Cartesian3 xaxis() const = 0; ///< right
+    virtual Cartesian3 yaxis() const = 0; ///< direction
+    virtual Cartesian3 zaxis() const = 0; ///< up
+    virtual void setWorldPosition(const Cartesian3 &position) = 0;
+    virtual void setAxes(const Cartesian3 &xaxis, const Cartesian3 &yaxis, const Cartesian3 &zaxis) = 0;
+
+    /**
+     * @brief 同时设置位置和三个轴, CameraController的事务每帧只调用一次. 默认依次调用setWorldPosition和setAxes
+     *
+     * @param position 位置
+     * @param xaxis right
+     * @param yaxis direction
+     * @param zaxis up
+     */
+    virtual void setPose(const Cartesian3 &position, const Cartesian3 &xaxis, const Cartesian3 &yaxis, const Cartesian3 &zaxis);
+
+    virtual double fovy() const = 0; ///< 视角 (度)
+    virtual double aspectRatio() const = 0;
+    virtual double nearPlane() const = 0;
+    virtual double farPlane() const = 0;
+
+    /**
+     * @brief 飞行结束时调用 (LiCamera发出completeFlight信号)
+     *
+     */
+    virtual void completeFlight() {}
+};
+
+/**
+ * @brief ScreenSpaceCameraController依赖的外部对象 (都不拥有)
+ *
+ * canvas和camera不能为空. input为空时没有鼠标和键盘输入, globe为空时使用没有地形的EllipsoidCameraGlobe,
+ * ellipsoid为空时使用Ellipsoid::WGS84()
+ */
+struct CameraEnvironment {
+    CameraCanvas *canvas = nullptr;
+    CameraInput *input = nullptr;
+    CameraGlobe *globe = nullptr;
+    CameraRig *camera = nullptr;
+    Ellipsoid *ellipsoid = nullptr;
+};
+
+/**
+ * @brief 固定大小的窗口, 用于没有窗口的服务端和离线计算
+ *
+ */
+class CONTROLLER_EXPORT FixedCameraCanvas : public CameraCanvas
+{
+public:
+    FixedCameraCanvas(int width, int height) : _width(width), _height(height) {}
+
+    int width() const override { return _width; }
+    int height() const override { return _height; }
+    void resize(int width, int height) { _width = width; _height = height; }
+
+private:
+    int _width;
+    int _height;
+};
+
+/**
+ * @brief 没有地形的地球, 拾取椭球, 高度为0
+ *
+ */
+class CONTROLLER_EXPORT EllipsoidCameraGlobe : public CameraGlobe
+{
+public:
+    explicit EllipsoidCameraGlobe(Ellipsoid *ellipsoid);
+
+    void pick(const Ray &ray, Cartesian3 *result) override;
+    double getHeight(const Cartographic &cartographic) override;
+
+private:
+    Ellipsoid *_ellipsoid;
+};
+
+/**
+ * @brief 只保存位姿和视锥的相机
+ *
+ */
+class CONTROLLER_EXPORT SimpleCameraRig : public CameraRig
+{
+public:
+    SimpleCameraRig();
+
+    Cartesian3 worldPosition() const override { return _position; }
+    Cartesian3 xaxis() const override { return _right; }
+    Cartesian3 yaxis() const override { return _direction; }
+    Cartesian3 zaxis() const override { return _up; }
+    void setWorldPosition(const Cartesian3 &position) override { _position = position; }
+    void setAxes(const Cartesian3 &xaxis, const Cartesian3 &yaxis, const Cartesian3 &zaxis) override;
+    void setPose(const Cartesian3 &position, const Cartesian3 &xaxis, const Cartesian3 &yaxis, const Cartesian3 &zaxis) override;
+
+    double fovy() const override { return _fovy; }
+    double aspectRatio() const override { return _aspectRatio; }
+    double nearPlane() const override { return _nearPlane; }
+    double farPlane() const override { return _farPlane; }
+
+    /**
+     * @brief 设置视锥
+     *
+     * @param fovy 视角 (度)
+     * @param aspectRatio 宽高比
+     * @param nearPlane 近裁剪面
+     * @param farPlane 远裁剪面
+     */
+    void setFrustum(double fovy, double aspectRatio, double nearPlane, double farPlane);
+
+private:
+    Cartesian3 _position;
+    Cartesian3 _right;
+    Cartesian3 _direction;
+    Cartesian3 _up;
+    double _fovy = 60.0;
+    double _aspectRatio = 16.0 / 9.0;
+    double _nearPlane = 1.0;
+    double _farPlane = 500000000.0;
+};
+
+/**
+ * @brief 从LiViewer (窗口, 输入系统, 场景和主相机) 构造的CameraEnvironment, 是默认构造的ScreenSpaceCameraController使用的环境
+ *
+ */
+class CONTROLLER_EXPORT LiCameraEnvironment
+{
+public:
+    explicit LiCameraEnvironment(LiViewer *viewer);
+    ~LiCameraEnvironment();
+
+    CameraEnvironment environment() const;
+
+private:
+    Q_DISABLE_COPY(LiCameraEnvironment)
+
+    class CanvasAdapter;
+    class InputAdapter;
+    class GlobeAdapter;
+    class RigAdapter;
+
+    CanvasAdapter *_canvas;
+    InputAdapter *_input;
+    GlobeAdapter *_globe;
+    RigAdapter *_camera;
+};
+
+#endif // CAMERAENVIRONMENT_H
@@ -2,16 +2,16 @@
 #include "screenspaceeventhandler.h"
 #include "timestamp.h"
 #include "limath.h"
-#include "liwidget.h"
-#include "liviewer.h"
-#include "liengine.h"
+#include "cameraenvironment.h"
 #include "liinputsystem.h"
+#include "cameraclock.h"
+#include <array>
 
-CameraEventAggregator::CameraEventAggregator(LiWidget *canvas, QObject *parent) :  QObject(parent)
+CameraEventAggregator::CameraEventAggregator(CameraCanvas *canvas, LiInputSystem *inputSystem, QObject *parent) :  QObject(parent)
 {
     _canvas = canvas;
 
-    inputSystem = GlobalViewer()->engine()->inputSystem();
+    this->inputSystem = inputSystem;
 
     _eventHandler = new ScreenSpaceEventHandler();
     _eventHandler->setInputSystem(inputSystem);
@@ -78,16 +78,26 @@ Cartesian2 CameraEventAggregator::getStartMousePosition(CameraEventType::Type ty
     return _eventData[getKey((int)type, modifier)]->eventStartPosition;
 }
 
-quint64 CameraEventAggregator::getButtonPressTime(CameraEventType::Type type, int modifier) const
+double CameraEventAggregator::getButtonPressTime(CameraEventType::Type type, int modifier) const
 {
     return _eventData[getKey((int)type, modifier)]->pressTime;
 }
 
-quint64 CameraEventAggregator::getButtonReleaseTime(CameraEventType::Type type, int modifier) const
+double CameraEventAggregator::getButtonReleaseTime(CameraEventType::Type type, int modifier) const
 {
     return _eventData[getKey((int)type, modifier)]->releaseTime;
 }
 
+void CameraEventAggregator::setClock(CameraClock *clock)
+{
+    _clock = clock;
+}
+
+double CameraEventAggregator::currentTime() const
+{
+    return _clock ? _clock->milliseconds() : double(getTimestamp());
+}
+
 void CameraEventAggregator::reset()
 {
     for(CameraEventData *data : _eventData) {
@@ -95,12 +105,33 @@ void CameraEventAggregator::reset()
     }
 }
 
+bool CameraEventAggregator::processTouchEvent(QTouchEvent *event)
+{
+    return _eventHandler->processTouchEvent(event);
+}
+
+void CameraEventAggregator::processWheel(const Cartesian2 &position, int deltaY)
+{
+    _eventHandler->mouseMove(position);
+    _eventHandler->wheel(deltaY);
+}
+
+void CameraEventAggregator::flushInputEvents()
+{
+    _eventHandler->flushInputEvents();
+}
+
+InputEventCounters CameraEventAggregator::inputEventCounters() const
+{
+    return _eventHandler->inputEventCounters();
+}
+
 quint64 CameraEventAggregator::getKey(int type, int modifier) const
 {
     return quint64(type) | (quint64(modifier) << 32);
 }
 
-void CameraEventAggregator::listenToPinch(int modifier, LiWidget *canvas)
+void CameraEventAggregator::listenToPinch(int modifier, CameraCanvas *canvas)
 {
     quint64 key = getKey((int)CameraEventType::PINCH, modifier);
 
@@ -120,7 +151,7 @@ void CameraEventAggregator::listenToPinch(int modifier, LiWidget *canvas)
     _eventHandler->setInputAction([=](ScreenSpaceMouseEventPtr event) {
         _buttonsDown++;
         data->isDown = true;
-        data->pressTime = getTimestamp();
+        data->pressTime = currentTime();
 
         // Compute center position and store as start point.
 //        Cartesian2.lerp(event->position1, event->position2, 0.5, data->eventStartPosition);
@@ -132,7 +163,7 @@ void CameraEventAggregator::listenToPinch(int modifier, LiWidget *canvas)
     _eventHandler->setInputAction([=](ScreenSpaceMouseEventPtr event) {
         _buttonsDown = std::max(_buttonsDown - 1, 0);
         data->isDown = false;
-        data->releaseTime = getTimestamp();
+        data->releaseTime = currentTime();
     }, ScreenSpaceEventType::PINCH_END, modifier);
 
     _eventHandler->setInputAction([=](ScreenSpaceMouseEventPtr event) {
@@ -214,30 +245,30 @@ void CameraEventAggregator::listenMouseButtonDownUp(int modifier, CameraEventTyp
         _buttonsDown++;
         data->lastMovement.valid = false;
         data->isDown = true;
-        data->pressTime = getTimestamp();
+        data->pressTime = currentTime();
         data->eventStartPosition = event->position;
     }, down, modifier);
 
     _eventHandler->setInputAction([=](ScreenSpaceMouseEventPtr event) {
         _buttonsDown = std::max(_buttonsDown - 1, 0);
         data->isDown = false;
-        data->releaseTime = getTimestamp();
+        data->releaseTime = currentTime();
     }, up, modifier);
 }
 
 void CameraEventAggregator::listenMouseMove(int modifier)
 {
+    // 事件数据在构造后不再改变, 直接保存指针, 移动时不再查找_eventData
+    std::array<CameraEventData*, 4> eventData;
     for (int i = 0; i < 4; ++i) {
         quint64 key = getKey(i, modifier);
         CameraEventData *data = getOrCreateEventData(key);
         data->update = true;
+        eventData[i] = data;
     }
 
     _eventHandler->setInputAction([=](ScreenSpaceMouseEventPtr event) {
-        for (int i = 0; i < 4; ++i) {
-            quint64 key = getKey(i, modifier);
-            CameraEventData *data = _eventData[key];
-
+        for (CameraEventData *data : eventData) {
             if (data->isDown) {
                 if (!data->update) {
                     data->movement.endPosition = event->movement.endPosition;
@@ -265,7 +296,7 @@ CameraEventData *CameraEventAggregator::getOrCreateEventData(quint64 key)
     return data;
 }
 
-void CameraEventAggregator::clonePinchMovement(CameraMovement pinchMovement, CameraMovement &result)
+void CameraEventAggregator::clonePinchMovement(const CameraMovement &pinchMovement, CameraMovement &result)
 {
     result.distance.startPosition = pinchMovement.distance.startPosition;
     result.distance.endPosition = pinchMovement.distance.endPosition;
@@ -274,7 +305,7 @@ void CameraEventAggregator::clonePinchMovement(CameraMovement pinchMovement, Cam
     result.angleAndHeight.endPosition = pinchMovement.angleAndHeight.endPosition;
 }
 
-void CameraEventAggregator::cloneMouseMovement(CameraMovement mouseMovement, CameraMovement &result)
+void CameraEventAggregator::cloneMouseMovement(const CameraMovement &mouseMovement, CameraMovement &result)
 {
     result.startPosition = mouseMovement.startPosition;
     result.endPosition = mouseMovement.endPosition;
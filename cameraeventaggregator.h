@@ -5,10 +5,12 @@
 #include "screenspaceeventutils.h"
 #include "cartesian2.h"
 
-class LiWidget;
+class CameraCanvas;
 class LiEngine;
 class LiInputSystem;
 class ScreenSpaceEventHandler;
+class QTouchEvent;
+class CameraClock;
 
 /**
  * @brief 相机输入事件结构体
@@ -20,8 +22,8 @@ struct CameraEventData {
     CameraMovement movement; ///< 鼠标移动信息
     CameraMovement lastMovement; ///< 鼠标最后的移动信息
     Cartesian2 eventStartPosition; ///< 鼠标事件触发的初始位置 (屏幕坐标)
-    quint64 pressTime = 0; ///< 鼠标按下的时间戳
-    quint64 releaseTime = 0; ///< 鼠标释放的时间戳
+    double pressTime = 0.0; ///< 鼠标按下的时间戳 (毫秒), 为0时没有按下过
+    double releaseTime = 0.0; ///< 鼠标释放的时间戳 (毫秒), 为0时没有释放过
 };
 
 /**
@@ -35,10 +37,11 @@ public:
     /**
      * @brief 构造函数
      *
-     * @param canvas LiWidget窗口
+     * @param canvas 窗口
+     * @param inputSystem 鼠标事件的来源, 可以为空 (只接收触摸事件)
      * @param parent 父类指针
      */
-    explicit CameraEventAggregator(LiWidget *canvas, QObject *parent = nullptr);
+    CameraEventAggregator(CameraCanvas *canvas, LiInputSystem *inputSystem, QObject *parent = nullptr);
 
     /**
      * @brief 析构函数
@@ -110,18 +113,18 @@ public:
      *
      * @param type 鼠标事件的类型 (左键拖拽, 右键拖拽, 中键拖拽...)
      * @param modifier 键盘按下的键 (shitf, ctrl...默认为0, 表示不按下任何键)
-     * @return quint64 时间戳
+     * @return double 时间戳 (毫秒)
      */
-    quint64 getButtonPressTime(CameraEventType::Type type, int modifier) const;
+    double getButtonPressTime(CameraEventType::Type type, int modifier) const;
 
     /**
      * @brief 获取鼠标释放的时间戳
      *
      * @param type 鼠标事件的类型 (左键拖拽, 右键拖拽, 中键拖拽...)
      * @param modifier 键盘按下的键 (shitf, ctrl...默认为0, 表示不按下任何键)
-     * @return quint64 时间戳
+     * @return double 时间戳 (毫秒)
      */
-    quint64 getButtonReleaseTime(CameraEventType::Type type, int modifier) const;
+    double getButtonReleaseTime(CameraEventType::Type type, int modifier) const;
 
     /**
      * @brief 执行完一帧后, 重置结构体CameraEventData里面的update变量为true
@@ -129,26 +132,64 @@ public:
      */
     void reset();
 
+    /**
+     * @brief 处理Qt的触摸事件 (转发给ScreenSpaceEventHandler)
+     *
+     * @param event 触摸事件
+     * @return bool true: 已处理, false: 不是触摸事件
+     */
+    bool processTouchEvent(QTouchEvent *event);
+
+    /**
+     * @brief 处理滚轮事件 (转发给ScreenSpaceEventHandler), 鼠标先移动到position
+     *
+     * @param position 鼠标位置 (屏幕坐标)
+     * @param deltaY 滚动量
+     */
+    void processWheel(const Cartesian2 &position, int deltaY);
+
+    /**
+     * @brief 每一帧处理相机输入之前调用, 把本帧合并的鼠标移动和触摸移动转换成一次相机移动
+     *
+     */
+    void flushInputEvents();
+
+    /**
+     * @brief 获取输入事件计数
+     *
+     * @return InputEventCounters 收到的和合并后触发的事件数量
+     */
+    InputEventCounters inputEventCounters() const;
+
+    /**
+     * @brief 设置记录按下和释放时间的时钟, 为空时使用getTimestamp()
+     *
+     * @param clock 时钟 (不拥有)
+     */
+    void setClock(CameraClock *clock);
+
     LiInputSystem *inputSystem; ///< 输入系统
 
 private:
     quint64 getKey(int type, int modifier = 0) const;
+    double currentTime() const;
 
-    void listenToPinch(int modifier, LiWidget *canvas);
+    void listenToPinch(int modifier, CameraCanvas *canvas);
     void listenToWheel(int modifier);
     void listenMouseButtonDownUp(int modifier, CameraEventType::Type type);
     void listenMouseMove(int modifier);
-    void clonePinchMovement(CameraMovement pinchMovement, CameraMovement &result);
-    void cloneMouseMovement(CameraMovement mouseMovement, CameraMovement &result);
+    void clonePinchMovement(const CameraMovement &pinchMovement, CameraMovement &result);
+    void cloneMouseMovement(const CameraMovement &mouseMovement, CameraMovement &result);
 
     CameraEventData *getOrCreateEventData(quint64 key);
 
     ScreenSpaceEventHandler *_eventHandler = nullptr;
     QHash<quint64, CameraEventData*> _eventData;
-    LiWidget *_canvas;
+    CameraCanvas *_canvas;
 
     Cartesian2 _currentMousePosition;
     int _buttonsDown = 0;
+    CameraClock *_clock = nullptr;
 };
 
 #endif // CAMERAEVENTAGGREGATOR_H
@@ -4,41 +4,38 @@
 #include "cesiummath.h"
 #include "cesiumcartesian3.h"
 #include "tweenjs.h"
-#include "litransform.h"
 #include "tweencollection.h"
 #include "cameracontroller.h"
 #include "screenspacecameracontroller.h"
-#include "licamera.h"
+#include "cameratour.h"
+#include "camerapathfile.h"
 
 CameraFlightPath::CameraFlightPath()
 {
 }
 
-Tween *CameraFlightPath::createTween(LiCamera *camera, CameraController *controller, const CameraNewOptions &options)
+Tween *CameraFlightPath::createTween(CameraRig *camera, CameraController *controller, const CameraNewOptions &options)
 {
-    LiTransform *cameraTrans = camera->transform();
-
     Tween *tween;
     Cartesian3 destination = options.destination;
-    TweenAction1Double easingFunction = options.easingFunction;
 
     double duration = options.duration;
     if(!defined(duration)) {
-        duration = ceil((cameraTrans->worldPosition() - destination).magnitude() / 1000000.0) + 2.0;
+        duration = ceil((controller->cameraPosition() - destination).magnitude() / 1000000.0) + 2.0;
         duration = std::min(duration, 3.0);
     }
     double heading = options.heading;
     double pitch = options.pitch;
     double roll = options.roll;
 
-    ScreenSpaceCameraController *screenSpaceCameraController = qobject_cast<ScreenSpaceCameraController*>(camera->cameraController());
+    ScreenSpaceCameraController *screenSpaceCameraController = qobject_cast<ScreenSpaceCameraController*>(controller->parent());
     screenSpaceCameraController->_enableInputs = false;
 
     TweenAction complete = wrapCallback(screenSpaceCameraController, options.complete);
     TweenAction cancel = wrapCallback(screenSpaceCameraController, options.cancel);
 
     bool empty = false;
-    empty = empty || (CesiumCartesian3::equalsEpsilon(destination, cameraTrans->worldPosition(), Math::EPSILON10));
+    empty = empty || (CesiumCartesian3::equalsEpsilon(destination, controller->cameraPosition(), Math::EPSILON10));
 
     empty = empty &&
             CesiumMath::equalsEpsilon(CesiumMath::negativePiToPi(heading), CesiumMath::negativePiToPi(controller->heading()), Math::EPSILON10) &&
@@ -54,7 +51,8 @@ Tween *CameraFlightPath::createTween(LiCamera *camera, CameraController *control
 
     if (duration <= 0.0) {
         TweenAction newOnComplete = [=]() {
-            TweenAction1 update = createUpdate3D(camera, controller, 1.0, destination, heading, pitch, roll);
+            TweenActionPose pose = createPose3D(camera, controller, 1.0, destination, heading, pitch, roll);
+            TweenAction1 update = createUpdate3D(controller, pose);
             update(1.0);
 
             if(complete)
@@ -66,33 +64,94 @@ Tween *CameraFlightPath::createTween(LiCamera *camera, CameraController *control
         return tween;
     }
 
-    TweenAction1 update = createUpdate3D(camera, controller, duration, destination, heading, pitch, roll);
+    TweenActionPose pose = createPose3D(camera, controller, duration, destination, heading, pitch, roll);
+    TweenAction1 update = createUpdate3D(controller, pose);
 
     double startHeight = controller->positionCartographic().height;
     double endHeight = cartesianToCartographic(destination).height;
 
+    EasingType::Type easingType;
     if (startHeight > endHeight && startHeight > 11500.0) {
-        easingFunction = [=](double k) {
-            return TweenJS::EasingCubicOut(k);
-        };
+        easingType = EasingType::CubicOut;
     } else {
-        easingFunction = [=](double k) {
-            return TweenJS::EasingQuinticInOut(k);
-        };
+        easingType = EasingType::QuinticInOut;
     }
 
     tween = new Tween();
     tween->_duration = duration;
-    tween->_easingFunction = easingFunction;
+    tween->_easingType = easingType;
     tween->_startObject = 0.0;
     tween->_stopObject = duration;
     tween->_update = update;
+    tween->_sample = pose;
     tween->_complete = complete;
     tween->_cancle = cancel;
 
     return tween;
 }
 
+Tween *CameraFlightPath::createTourTween(CameraController *controller, const QSharedPointer<CameraTour> &tour,
+                                         const TweenAction &complete, const TweenAction &cancel)
+{
+    // the tween value is the tour time in seconds; timing and easing are already baked into the tour
+    TweenActionPose pose = [=](double value) {
+        return tour->evaluate(value);
+    };
+
+    double duration = tour->duration();
+    return createPoseTween(controller, 0.0, duration, duration, pose, createUpdate3D(controller, pose), complete, cancel);
+}
+
+Tween *CameraFlightPath::createPathTween(CameraController *controller, const QSharedPointer<CameraPathFile> &path,
+                                         double startTime, double speed, const TweenAction1 &fovCallback,
+                                         const TweenAction &complete, const TweenAction &cancel)
+{
+    double endTime = path->endTime();
+    startTime = std::max(startTime, path->startTime());
+
+    // the tween value is the path file time in seconds, each frame seeks from the previous record
+    TweenActionPose pose = [=](double value) {
+        return path->sample(value);
+    };
+
+    bool hasFov = path->hasFov() && fovCallback;
+    TweenAction1 update = [=](double value) {
+        CameraPose result = pose(value);
+        controller->setView(result.position, result.heading, result.pitch, result.roll);
+        if (hasFov) {
+            fovCallback(result.fovy);
+        }
+    };
+
+    double duration = speed > 0.0 ? (endTime - startTime) / speed : 0.0;
+    return createPoseTween(controller, startTime, endTime, duration, pose, update, complete, cancel);
+}
+
+Tween *CameraFlightPath::createPoseTween(CameraController *controller, double startValue, double stopValue, double duration,
+                                         const TweenActionPose &pose, const TweenAction1 &update,
+                                         const TweenAction &complete, const TweenAction &cancel)
+{
+    ScreenSpaceCameraController *screenSpaceCameraController = qobject_cast<ScreenSpaceCameraController*>(controller->parent());
+    screenSpaceCameraController->_enableInputs = false;
+
+    Tween *tween = new Tween();
+    tween->_complete = wrapCallback(screenSpaceCameraController, complete);
+    tween->_cancle = wrapCallback(screenSpaceCameraController, cancel);
+
+    if (duration <= 0.0) {
+        return tween;
+    }
+
+    tween->_duration = duration;
+    tween->_easingType = EasingType::LinearNone;
+    tween->_startObject = startValue;
+    tween->_stopObject = stopValue;
+    tween->_update = update;
+    tween->_sample = pose;
+
+    return tween;
+}
+
 TweenAction CameraFlightPath::wrapCallback(ScreenSpaceCameraController *controller, const TweenAction &action)
 {
     TweenAction result = [=]() {
@@ -103,7 +162,7 @@ TweenAction CameraFlightPath::wrapCallback(ScreenSpaceCameraController *controll
     return result;
 }
 
-TweenAction1 CameraFlightPath::createUpdate3D(LiCamera *camera, CameraController *controller, double duration, const Cartesian3 &destination, double heading, double pitch, double roll)
+TweenActionPose CameraFlightPath::createPose3D(CameraRig *camera, CameraController *controller, double duration, const Cartesian3 &destination, double heading, double pitch, double roll)
 {
     Cartographic startCart = controller->positionCartographic();
     double startPitch = controller->pitch();
@@ -136,18 +195,27 @@ TweenAction1 CameraFlightPath::createUpdate3D(LiCamera *camera, CameraController
     double startLatitude = startCart.latitude;
     double destLatitude = destCart.latitude;
 
-    TweenAction1 update = [=](double value) {
+    TweenActionPose pose = [=](double value) {
         double time = value / duration;
-        Cartesian3 position = CesiumCartesian3::fromRadians(
+        CameraPose result;
+        result.position = CesiumCartesian3::fromRadians(
                     CesiumMath::lerp(startLongitude, destLongitude, time),
                     CesiumMath::lerp(startLatitude, destLatitude, time),
                     heightFunction(time)
                     );
+        result.heading = CesiumMath::lerp(startHeading, heading, time);
+        result.pitch = CesiumMath::lerp(startPitch, pitch, time);
+        result.roll = CesiumMath::lerp(startRoll, roll, time);
+        return result;
+    };
+    return pose;
+}
 
-        controller->setView(position,
-                            CesiumMath::lerp(startHeading, heading, time),
-                            CesiumMath::lerp(startPitch, pitch, time),
-                            CesiumMath::lerp(startRoll, roll, time));
+TweenAction1 CameraFlightPath::createUpdate3D(CameraController *controller, const TweenActionPose &pose)
+{
+    TweenAction1 update = [=](double value) {
+        CameraPose result = pose(value);
+        controller->setView(result.position, result.heading, result.pitch, result.roll);
     };
     return update;
 }
@@ -168,16 +236,14 @@ double CameraFlightPath::adjustAngleForLERP(double startAngle, double endAngle)
     return startAngle;
 }
 
-TweenAction1Double CameraFlightPath::createHeightFunction(LiCamera *camera, const Cartesian3 &destination, double startHeight, double endHeight)
+TweenAction1Double CameraFlightPath::createHeightFunction(CameraRig *camera, const Cartesian3 &destination, double startHeight, double endHeight)
 {
-    LiTransform *cameraTrans = camera->transform();
-
     double maxHeight = std::max(startHeight, endHeight);
 
-    Cartesian3 start = cameraTrans->worldPosition();
+    Cartesian3 start = camera->worldPosition();
     Cartesian3 end = destination;
-    Cartesian3 up = cameraTrans->zaxis();
-    Cartesian3 right = cameraTrans->xaxis();
+    Cartesian3 up = camera->zaxis();
+    Cartesian3 right = camera->xaxis();
 
     Cartesian3 diff = start - end;
     double verticalDistance = (up * Cartesian3::dot(diff, up)).magnitude();
@@ -205,7 +271,7 @@ TweenAction1Double CameraFlightPath::createHeightFunction(LiCamera *camera, cons
     return result;
 }
 
-double CameraFlightPath::getAltitude(LiCamera *camera, double dx, double dy)
+double CameraFlightPath::getAltitude(CameraRig *camera, double dx, double dy)
 {
     double near1;
     double top;
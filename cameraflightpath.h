@@ -5,9 +5,11 @@
 #include "screenspaceeventutils.h"
 
 class Tween;
-class LiCamera;
+class CameraRig;
 class CameraController;
 class ScreenSpaceCameraController;
+class CameraTour;
+class CameraPathFile;
 
 /**
  * @brief  相机的飞行路径
@@ -26,14 +28,46 @@ public:
      * @param newOptions 结构体, 包含相机的位置, 偏转角度等信息
      * @return Tween 返回Tween对象指针
      */
-    static Tween *createTween(LiCamera *camera, CameraController *controller, const CameraNewOptions &newOptions);
+    static Tween *createTween(CameraRig *camera, CameraController *controller, const CameraNewOptions &newOptions);
+
+    /**
+     * @brief 创建沿漫游路径飞行的Tween对象 (静态函数), 整个漫游只使用一个Tween
+     *
+     * @param controller 相机控制类
+     * @param tour 漫游路径
+     * @param complete 完成函数
+     * @param cancel 取消函数
+     * @return Tween 返回Tween对象指针
+     */
+    static Tween *createTourTween(CameraController *controller, const QSharedPointer<CameraTour> &tour,
+                                  const TweenAction &complete, const TweenAction &cancel);
+
+    /**
+     * @brief 创建回放相机路径文件的Tween对象 (静态函数), 动画的值即路径文件的时间
+     *
+     * @param controller 相机控制类
+     * @param path 已打开的相机路径文件
+     * @param startTime 回放的起始时间 (秒, 路径文件的时间)
+     * @param speed 回放速度, 1.0为原速
+     * @param fovCallback 视角回调函数 (度), 路径文件包含视角时调用
+     * @param complete 完成函数
+     * @param cancel 取消函数
+     * @return Tween 返回Tween对象指针
+     */
+    static Tween *createPathTween(CameraController *controller, const QSharedPointer<CameraPathFile> &path,
+                                  double startTime, double speed, const TweenAction1 &fovCallback,
+                                  const TweenAction &complete, const TweenAction &cancel);
 
 private:
     static TweenAction wrapCallback(ScreenSpaceCameraController *controller, const TweenAction &action);
-    static TweenAction1 createUpdate3D(LiCamera *camera, CameraController *controller, double duration, const Cartesian3 &destination, double heading, double pitch, double roll);
+    static Tween *createPoseTween(CameraController *controller, double startValue, double stopValue, double duration,
+                                  const TweenActionPose &pose, const TweenAction1 &update,
+                                  const TweenAction &complete, const TweenAction &cancel);
+    static TweenActionPose createPose3D(CameraRig *camera, CameraController *controller, double duration, const Cartesian3 &destination, double heading, double pitch, double roll);
+    static TweenAction1 createUpdate3D(CameraController *controller, const TweenActionPose &pose);
     static double adjustAngleForLERP(double startAngle, double endAngle);
-    static TweenAction1Double createHeightFunction(LiCamera *camera, const Cartesian3 &destination, double startHeight, double endHeight);
-    static double getAltitude(LiCamera *camera, double dx, double dy);
+    static TweenAction1Double createHeightFunction(CameraRig *camera, const Cartesian3 &destination, double startHeight, double endHeight);
+    static double getAltitude(CameraRig *camera, double dx, double dy);
 };
 
 #endif // CAMERAFLIGHTPATH_H
@@ -0,0 +1,383 @@
+#include "camerapathfile.h"
+
+Q_STATIC_ASSERT(sizeof(CameraPathHeader) == 64);
+Q_STATIC_ASSERT(sizeof(CameraPathRecord) == 56);
+
+namespace {
+
+const quint32 RECORD_SIZE_WITHOUT_FOV = 48;
+const quint32 RECORD_SIZE_WITH_FOV = 56;
+
+struct QuaternionD {
+    double x;
+    double y;
+    double z;
+    double w;
+};
+
+QuaternionD multiply(const QuaternionD &left, const QuaternionD &right)
+{
+    QuaternionD result;
+    result.x = left.w * right.x + left.x * right.w + left.y * right.z - left.z * right.y;
+    result.y = left.w * right.y - left.x * right.z + left.y * right.w + left.z * right.x;
+    result.z = left.w * right.z + left.x * right.y - left.y * right.x + left.z * right.w;
+    result.w = left.w * right.w - left.x * right.x - left.y * right.y - left.z * right.z;
+    return result;
+}
+
+}
+
+const char CameraPathFile::MAGIC[8] = { 'L', 'I', 'C', 'A', 'M', 'P', 'T', 'H' };
+
+CameraPathFile::CameraPathFile()
+{
+    memset(&_header, 0, sizeof(_header));
+}
+
+CameraPathFile::~CameraPathFile()
+{
+    close();
+}
+
+bool CameraPathFile::open(const QString &fileName)
+{
+    close();
+
+    if (QSysInfo::ByteOrder != QSysInfo::LittleEndian) {
+        _errorString = QStringLiteral("camera path files are little-endian only");
+        return false;
+    }
+
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::ReadOnly)) {
+        _errorString = _file.errorString();
+        return false;
+    }
+
+    qint64 size = _file.size();
+    if (size < static_cast<qint64>(sizeof(CameraPathHeader))) {
+        _errorString = QStringLiteral("file is too small");
+        _file.close();
+        return false;
+    }
+
+    _data = _file.map(0, size);
+    if (!_data) {
+        _errorString = _file.errorString();
+        _file.close();
+        return false;
+    }
+
+    memcpy(&_header, _data, sizeof(_header));
+
+    quint32 minimumRecordSize = (_header.flags & HasFov) ? RECORD_SIZE_WITH_FOV : RECORD_SIZE_WITHOUT_FOV;
+    quint64 fileSize = static_cast<quint64>(size);
+
+    // 文件头的值不可信, 用除法比较范围, 避免加法和乘法溢出
+    bool valid = memcmp(_header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+            _header.version == VERSION &&
+            _header.count > 0 &&
+            _header.indexStride > 0 &&
+            _header.recordSize >= minimumRecordSize &&
+            _header.recordSize % 8 == 0 &&
+            _header.recordsOffset % 8 == 0 &&
+            _header.indexOffset % 8 == 0 &&
+            _header.recordsOffset >= sizeof(CameraPathHeader) &&
+            _header.recordsOffset <= fileSize &&
+            _header.indexOffset <= fileSize &&
+            _header.count <= (fileSize - _header.recordsOffset) / _header.recordSize &&
+            _header.indexCount <= (fileSize - _header.indexOffset) / sizeof(double);
+    if (valid) {
+        quint64 expectedIndexCount = _header.count / _header.indexStride + (_header.count % _header.indexStride != 0);
+        valid = _header.indexCount == expectedIndexCount;
+    }
+    if (!valid) {
+        _errorString = QStringLiteral("invalid camera path header");
+        close();
+        return false;
+    }
+
+    _index = reinterpret_cast<const double *>(_data + _header.indexOffset);
+    _hint = 0;
+    _errorString.clear();
+    return true;
+}
+
+void CameraPathFile::close()
+{
+    if (_data) {
+        _file.unmap(const_cast<uchar *>(_data));
+        _data = nullptr;
+    }
+    if (_file.isOpen()) {
+        _file.close();
+    }
+    _index = nullptr;
+    memset(&_header, 0, sizeof(_header));
+}
+
+bool CameraPathFile::isOpen() const
+{
+    return _data != nullptr;
+}
+
+QString CameraPathFile::errorString() const
+{
+    return _errorString;
+}
+
+bool CameraPathFile::hasFov() const
+{
+    return (_header.flags & HasFov) != 0;
+}
+
+qint64 CameraPathFile::count() const
+{
+    return static_cast<qint64>(_header.count);
+}
+
+double CameraPathFile::startTime() const
+{
+    return isOpen() ? timeAt(0) : 0.0;
+}
+
+double CameraPathFile::endTime() const
+{
+    return isOpen() ? timeAt(count() - 1) : 0.0;
+}
+
+CameraPathRecord CameraPathFile::record(qint64 index) const
+{
+    CameraPathRecord result;
+    memset(&result, 0, sizeof(result));
+    if (!isOpen() || index < 0 || index >= count()) {
+        return result;
+    }
+
+    quint32 size = hasFov() ? RECORD_SIZE_WITH_FOV : RECORD_SIZE_WITHOUT_FOV;
+    memcpy(&result, _data + _header.recordsOffset + index * _header.recordSize, size);
+    return result;
+}
+
+qint64 CameraPathFile::seek(double time) const
+{
+    if (!isOpen()) {
+        return 0;
+    }
+
+    qint64 last = count() - 1;
+
+    // sequential playback: the answer is almost always the previous record or the one after it
+    qint64 hint = _hint;
+    if (timeAt(hint) <= time && (hint == last || time < timeAt(hint + 1))) {
+        return hint;
+    }
+    if (hint < last && timeAt(hint + 1) <= time && (hint + 1 == last || time < timeAt(hint + 2))) {
+        _hint = hint + 1;
+        return _hint;
+    }
+
+    qint64 block = static_cast<qint64>(std::upper_bound(_index, _index + _header.indexCount, time) - _index) - 1;
+    if (block < 0) {
+        _hint = 0;
+        return 0;
+    }
+
+    // last record with timeAt(record) <= time, searched only inside the block
+    qint64 low = block * _header.indexStride;
+    qint64 high = std::min(low + static_cast<qint64>(_header.indexStride), count());
+    while (high - low > 1) {
+        qint64 middle = low + (high - low) / 2;
+        if (timeAt(middle) <= time) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+
+    _hint = low;
+    return low;
+}
+
+CameraPose CameraPathFile::sample(double time) const
+{
+    CameraPose pose;
+    if (!isOpen()) {
+        return pose;
+    }
+
+    qint64 index = seek(time);
+    CameraPathRecord start = record(index);
+
+    if (time <= start.time || index == count() - 1) {
+        pose.position = Cartesian3(start.x, start.y, start.z);
+        quaternionToHeadingPitchRoll(start.qx, start.qy, start.qz, start.qw, pose);
+        if (hasFov()) {
+            pose.fovy = start.fovy;
+        }
+        return pose;
+    }
+
+    CameraPathRecord end = record(index + 1);
+    double span = end.time - start.time;
+    double t = span > 0.0 ? (time - start.time) / span : 0.0;
+
+    pose.position = Cartesian3(start.x + (end.x - start.x) * t,
+                               start.y + (end.y - start.y) * t,
+                               start.z + (end.z - start.z) * t);
+
+    double x0 = start.qx, y0 = start.qy, z0 = start.qz, w0 = start.qw;
+    double x1 = end.qx, y1 = end.qy, z1 = end.qz, w1 = end.qw;
+    double cosine = x0 * x1 + y0 * y1 + z0 * z1 + w0 * w1;
+    if (cosine < 0.0) {
+        cosine = -cosine;
+        x1 = -x1;
+        y1 = -y1;
+        z1 = -z1;
+        w1 = -w1;
+    }
+
+    double s0 = 1.0 - t;
+    double s1 = t;
+    if (cosine < 0.9995) {
+        double angle = acos(cosine);
+        double sine = sin(angle);
+        s0 = sin((1.0 - t) * angle) / sine;
+        s1 = sin(t * angle) / sine;
+    }
+
+    double qx = s0 * x0 + s1 * x1;
+    double qy = s0 * y0 + s1 * y1;
+    double qz = s0 * z0 + s1 * z1;
+    double qw = s0 * w0 + s1 * w1;
+    double length = sqrt(qx * qx + qy * qy + qz * qz + qw * qw);
+    quaternionToHeadingPitchRoll(qx / length, qy / length, qz / length, qw / length, pose);
+
+    if (hasFov()) {
+        pose.fovy = start.fovy + (end.fovy - start.fovy) * t;
+    }
+
+    return pose;
+}
+
+void CameraPathFile::headingPitchRollToQuaternion(double heading, double pitch, double roll, CameraPathRecord &record)
+{
+    QuaternionD rollQuaternion = { sin(roll * 0.5), 0.0, 0.0, cos(roll * 0.5) };
+    QuaternionD pitchQuaternion = { 0.0, sin(-pitch * 0.5), 0.0, cos(-pitch * 0.5) };
+    QuaternionD headingQuaternion = { 0.0, 0.0, sin(-heading * 0.5), cos(-heading * 0.5) };
+    QuaternionD result = multiply(headingQuaternion, multiply(pitchQuaternion, rollQuaternion));
+
+    record.qx = static_cast<float>(result.x);
+    record.qy = static_cast<float>(result.y);
+    record.qz = static_cast<float>(result.z);
+    record.qw = static_cast<float>(result.w);
+}
+
+void CameraPathFile::quaternionToHeadingPitchRoll(double qx, double qy, double qz, double qw, CameraPose &pose)
+{
+    double test = 2.0 * (qw * qy - qz * qx);
+    double denominatorRoll = 1.0 - 2.0 * (qx * qx + qy * qy);
+    double numeratorRoll = 2.0 * (qw * qx + qy * qz);
+    double denominatorHeading = 1.0 - 2.0 * (qy * qy + qz * qz);
+    double numeratorHeading = 2.0 * (qw * qz + qx * qy);
+
+    pose.heading = -atan2(numeratorHeading, denominatorHeading);
+    pose.roll = atan2(numeratorRoll, denominatorRoll);
+    pose.pitch = -asin(std::max(-1.0, std::min(test, 1.0)));
+}
+
+double CameraPathFile::timeAt(qint64 index) const
+{
+    double time;
+    memcpy(&time, _data + _header.recordsOffset + index * _header.recordSize, sizeof(time));
+    return time;
+}
+
+CameraPathWriter::CameraPathWriter()
+{
+    memset(&_header, 0, sizeof(_header));
+}
+
+CameraPathWriter::~CameraPathWriter()
+{
+    close();
+}
+
+bool CameraPathWriter::open(const QString &fileName, bool hasFov, quint32 indexStride)
+{
+    close();
+
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    memset(&_header, 0, sizeof(_header));
+    memcpy(_header.magic, CameraPathFile::MAGIC, sizeof(_header.magic));
+    _header.version = CameraPathFile::VERSION;
+    _header.flags = hasFov ? CameraPathFile::HasFov : 0;
+    _header.recordSize = hasFov ? RECORD_SIZE_WITH_FOV : RECORD_SIZE_WITHOUT_FOV;
+    _header.indexStride = std::max(indexStride, 1u);
+    _header.recordsOffset = sizeof(CameraPathHeader);
+
+    _index.clear();
+    _lastTime = -std::numeric_limits<double>::infinity();
+
+    // placeholder, rewritten by close() once count and index are known
+    return _file.write(reinterpret_cast<const char *>(&_header), sizeof(_header)) == sizeof(_header);
+}
+
+bool CameraPathWriter::append(double time, const Cartesian3 &position, double heading, double pitch, double roll, double fovy)
+{
+    CameraPathRecord record;
+    memset(&record, 0, sizeof(record));
+    record.time = time;
+    record.x = position.x;
+    record.y = position.y;
+    record.z = position.z;
+    CameraPathFile::headingPitchRollToQuaternion(heading, pitch, roll, record);
+    if (defined(fovy)) {
+        record.fovy = static_cast<float>(fovy);
+    }
+
+    return append(record);
+}
+
+bool CameraPathWriter::append(const CameraPathRecord &record)
+{
+    if (!_file.isOpen() || record.time < _lastTime) {
+        return false;
+    }
+
+    if (_file.write(reinterpret_cast<const char *>(&record), _header.recordSize) != _header.recordSize) {
+        return false;
+    }
+
+    // 写入成功后再记录索引, 避免索引指向没有写入的关键帧
+    if (_header.count % _header.indexStride == 0) {
+        _index.append(record.time);
+    }
+
+    _lastTime = record.time;
+    ++_header.count;
+    return true;
+}
+
+bool CameraPathWriter::close()
+{
+    if (!_file.isOpen()) {
+        return false;
+    }
+
+    _header.indexOffset = static_cast<quint64>(_file.pos());
+    _header.indexCount = static_cast<quint64>(_index.length());
+
+    qint64 indexSize = static_cast<qint64>(_index.length() * sizeof(double));
+    bool ok = _file.write(reinterpret_cast<const char *>(_index.constData()), indexSize) == indexSize;
+    ok = ok && _file.seek(0);
+    ok = ok && _file.write(reinterpret_cast<const char *>(&_header), sizeof(_header)) == sizeof(_header);
+
+    _file.close();
+    _index.clear();
+    return ok;
+}
@@ -0,0 +1,255 @@
+#ifndef CAMERAPATHFILE_H
+#define CAMERAPATHFILE_H
+
+#include "sscc_global.h"
+#include "cartesian3.h"
+#include "screenspaceeventutils.h"
+
+/**
+ * @brief 相机路径文件的文件头 (64字节, 小端)
+ *
+ * 文件布局: 文件头 | count个关键帧 (每个recordSize字节, 按时间递增) | indexCount个double (每indexStride个关键帧记录一次时间)
+ */
+struct CameraPathHeader {
+    char magic[8]; ///< 文件标识 "LICAMPTH"
+    quint32 version; ///< 版本号
+    quint32 flags; ///< 标志位, 见CameraPathFile::Flag
+    quint64 count; ///< 关键帧数量
+    quint32 recordSize; ///< 每个关键帧的字节数
+    quint32 indexStride; ///< 索引的间隔 (关键帧数量)
+    quint64 recordsOffset; ///< 关键帧在文件中的偏移
+    quint64 indexOffset; ///< 索引在文件中的偏移
+    quint64 indexCount; ///< 索引数量
+    quint64 reserved; ///< 保留
+};
+
+/**
+ * @brief 相机路径文件中的关键帧
+ *
+ * 四元数为相机在所在位置东北天(ENU)坐标系下的姿态, 与CesiumMath::fromHeadingPitchRoll的约定一致
+ */
+struct CameraPathRecord {
+    double time; ///< 时间 (秒)
+    double x; ///< 世界坐标x
+    double y; ///< 世界坐标y
+    double z; ///< 世界坐标z
+    float qx; ///< 四元数x
+    float qy; ///< 四元数y
+    float qz; ///< 四元数z
+    float qw; ///< 四元数w
+    float fovy; ///< 视角 (度), 仅在文件包含视角时有效
+    float reserved; ///< 保留, 用于8字节对齐
+};
+
+/**
+ * @brief 相机路径文件 (只读), 通过内存映射访问, 打开文件时不解析关键帧
+ *
+ * 查找时先在稀疏索引上二分, 再在索引间隔内二分, 复杂度O(log n); 顺序播放时直接从上一次的位置开始查找
+ */
+class CONTROLLER_EXPORT CameraPathFile
+{
+public:
+    /**
+     * @brief 标志位
+     *
+     */
+    enum Flag {
+        HasFov = 0x1 ///< 关键帧包含视角
+    };
+
+    /**
+     * @brief 默认构造
+     *
+     */
+    CameraPathFile();
+
+    /**
+     * @brief 析构函数, 解除内存映射
+     *
+     */
+    ~CameraPathFile();
+
+    /**
+     * @brief 打开并映射路径文件
+     *
+     * @param fileName 文件名
+     * @return bool true: 成功, false: 失败, 原因见errorString()
+     */
+    bool open(const QString &fileName);
+
+    /**
+     * @brief 关闭文件
+     *
+     */
+    void close();
+
+    /**
+     * @brief 文件是否已打开
+     *
+     * @return bool true: 是, false: 否
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief 获取最近一次的错误信息
+     *
+     * @return QString 错误信息
+     */
+    QString errorString() const;
+
+    /**
+     * @brief 关键帧是否包含视角
+     *
+     * @return bool true: 是, false: 否
+     */
+    bool hasFov() const;
+
+    /**
+     * @brief 获取关键帧数量
+     *
+     * @return qint64 关键帧数量
+     */
+    qint64 count() const;
+
+    /**
+     * @brief 获取第一个关键帧的时间
+     *
+     * @return double 时间 (秒)
+     */
+    double startTime() const;
+
+    /**
+     * @brief 获取最后一个关键帧的时间
+     *
+     * @return double 时间 (秒)
+     */
+    double endTime() const;
+
+    /**
+     * @brief 获取指定的关键帧
+     *
+     * @param index 关键帧序号
+     * @return CameraPathRecord 关键帧
+     */
+    CameraPathRecord record(qint64 index) const;
+
+    /**
+     * @brief 查找时间不大于time的最后一个关键帧, O(log n)
+     *
+     * @param time 时间 (秒)
+     * @return qint64 关键帧序号, time早于第一个关键帧时返回0
+     */
+    qint64 seek(double time) const;
+
+    /**
+     * @brief 计算指定时间的相机位姿 (位置线性插值, 姿态球面插值)
+     *
+     * @param time 时间 (秒), 超出范围时取首尾关键帧
+     * @return CameraPose 相机位姿, 文件不包含视角时fovy无效
+     */
+    CameraPose sample(double time) const;
+
+    /**
+     * @brief heading/pitch/roll转换为四元数 (ENU坐标系, 与CesiumMath::fromHeadingPitchRoll一致)
+     *
+     * @param heading heading (弧度)
+     * @param pitch pitch (弧度)
+     * @param roll roll (弧度)
+     * @param record 按引用传递一个参数, 写入qx/qy/qz/qw
+     */
+    static void headingPitchRollToQuaternion(double heading, double pitch, double roll, CameraPathRecord &record);
+
+    /**
+     * @brief 四元数转换为heading/pitch/roll
+     *
+     * @param qx 四元数x
+     * @param qy 四元数y
+     * @param qz 四元数z
+     * @param qw 四元数w
+     * @param pose 按引用传递一个参数, 写入heading/pitch/roll
+     */
+    static void quaternionToHeadingPitchRoll(double qx, double qy, double qz, double qw, CameraPose &pose);
+
+    static const char MAGIC[8];
+    static const quint32 VERSION = 1;
+
+private:
+    Q_DISABLE_COPY(CameraPathFile)
+
+    double timeAt(qint64 index) const;
+
+    QFile _file;
+    const uchar *_data = nullptr;
+    CameraPathHeader _header;
+    const double *_index = nullptr;
+    mutable qint64 _hint = 0;
+    QString _errorString;
+};
+
+/**
+ * @brief 相机路径文件的写入类, 关键帧直接顺序写入文件, 只在内存中保留稀疏索引
+ *
+ */
+class CONTROLLER_EXPORT CameraPathWriter
+{
+public:
+    /**
+     * @brief 默认构造
+     *
+     */
+    CameraPathWriter();
+
+    /**
+     * @brief 析构函数, 未关闭时自动关闭
+     *
+     */
+    ~CameraPathWriter();
+
+    /**
+     * @brief 创建路径文件
+     *
+     * @param fileName 文件名
+     * @param hasFov 关键帧是否包含视角
+     * @param indexStride 索引的间隔 (关键帧数量)
+     * @return bool true: 成功, false: 失败
+     */
+    bool open(const QString &fileName, bool hasFov = false, quint32 indexStride = 1024);
+
+    /**
+     * @brief 写入一个关键帧, 时间必须不小于上一个关键帧
+     *
+     * @param time 时间 (秒)
+     * @param position 世界坐标
+     * @param heading heading (弧度)
+     * @param pitch pitch (弧度)
+     * @param roll roll (弧度)
+     * @param fovy 视角 (度), 文件不包含视角时忽略
+     * @return bool true: 成功, false: 失败
+     */
+    bool append(double time, const Cartesian3 &position, double heading, double pitch, double roll, double fovy = Math::EPSILON20);
+
+    /**
+     * @brief 写入一个关键帧 (四元数已经填好)
+     *
+     * @param record 关键帧
+     * @return bool true: 成功, false: 失败
+     */
+    bool append(const CameraPathRecord &record);
+
+    /**
+     * @brief 写入索引和文件头并关闭文件
+     *
+     * @return bool true: 成功, false: 失败
+     */
+    bool close();
+
+private:
+    Q_DISABLE_COPY(CameraPathWriter)
+
+    QFile _file;
+    CameraPathHeader _header;
+    QVector<double> _index;
+    double _lastTime = -std::numeric_limits<double>::infinity();
+};
+
+#endif // CAMERAPATHFILE_H
@@ -0,0 +1,79 @@
+#include "camerasimulation.h"
+#include "screenspacecameracontroller.h"
+#include "cameraenvironment.h"
+#include "cameraclock.h"
+#include "ellipsoid.h"
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSemaphore>
+
+namespace {
+
+class SimulationTask : public QRunnable
+{
+public:
+    SimulationTask(const CameraSimulationScript &script, const CameraSimulationOptions &options,
+                   QVector<CameraState> *result, QSemaphore *finished)
+        : _script(script), _options(options), _result(result), _finished(finished)
+    {
+    }
+
+    void run() override
+    {
+        // 每个任务只写自己的结果, 不需要加锁
+        *_result = CameraSimulation::runScript(_script, _options);
+        _finished->release();
+    }
+
+private:
+    const CameraSimulationScript &_script;
+    const CameraSimulationOptions &_options;
+    QVector<CameraState> *_result;
+    QSemaphore *_finished;
+};
+
+}
+
+QVector<CameraState> CameraSimulation::runScript(const CameraSimulationScript &script, const CameraSimulationOptions &options)
+{
+    FixedCameraCanvas canvas(options.width, options.height);
+    SimpleCameraRig camera;
+    camera.setFrustum(options.fovy, double(options.width) / options.height, options.nearPlane, options.farPlane);
+    EllipsoidCameraGlobe globe(Ellipsoid::WGS84());
+
+    CameraEnvironment environment;
+    environment.canvas = &canvas;
+    environment.globe = &globe;
+    environment.camera = &camera;
+
+    ManualCameraClock clock;
+    ScreenSpaceCameraController controller(environment);
+    controller.setClock(&clock);
+    controller.setView(script.destination, script.heading, script.pitch, script.roll);
+
+    QVector<CameraState> states;
+    states.reserve(script.frames.size());
+    for (const CameraCommandBuffer &commands : script.frames) {
+        controller.submitCommands(commands);
+        clock.advance(options.frameNanoseconds);
+        controller.update();
+        states.append(controller.cameraState());
+    }
+    return states;
+}
+
+QVector<QVector<CameraState>> CameraSimulation::run(const QVector<CameraSimulationScript> &scripts,
+                                                    const CameraSimulationOptions &options, QThreadPool *pool)
+{
+    if (!pool) {
+        pool = QThreadPool::globalInstance();
+    }
+
+    QVector<QVector<CameraState>> results(scripts.size());
+    QSemaphore finished;
+    for (int i = 0; i < scripts.size(); ++i) {
+        pool->start(new SimulationTask(scripts[i], options, &results[i], &finished));
+    }
+    finished.acquire(scripts.size());
+    return results;
+}
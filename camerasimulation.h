@@ -0,0 +1,67 @@
+#ifndef CAMERASIMULATION_H
+#define CAMERASIMULATION_H
+
+#include "sscc_global.h"
+#include "cameracommandbuffer.h"
+#include "camerastate.h"
+
+class QThreadPool;
+
+/**
+ * @brief 一条离线模拟的相机轨迹: 初始视角和每帧提交的相机操作
+ *
+ */
+struct CameraSimulationScript {
+    Cartesian3 destination; ///< 初始位置 (世界坐标)
+    double heading = 0.0; ///< 初始heading (弧度)
+    double pitch = -M_PI / 2.0; ///< 初始pitch (弧度)
+    double roll = 0.0; ///< 初始roll (弧度)
+    QVector<CameraCommandBuffer> frames; ///< 每帧的相机操作, 帧数为轨迹的长度
+};
+
+/**
+ * @brief 模拟使用的窗口, 视锥和帧间隔
+ *
+ */
+struct CameraSimulationOptions {
+    int width = 1920;
+    int height = 1080;
+    double fovy = 60.0; ///< 视角 (度)
+    double nearPlane = 1.0;
+    double farPlane = 500000000.0;
+    qint64 frameNanoseconds = 16666667; ///< 每帧推进的模拟时间 (纳秒)
+};
+
+/**
+ * @brief 并行的离线相机轨迹模拟
+ *
+ * 每条轨迹使用独立的ScreenSpaceCameraController, 窗口, 相机, 没有地形的地球和ManualCameraClock,
+ * 控制器之间不共享可变状态, 不同的轨迹可以在不同的线程中同时运行. 一个控制器只能在一个线程中使用
+ */
+class CONTROLLER_EXPORT CameraSimulation
+{
+public:
+    /**
+     * @brief 在当前线程中模拟一条轨迹
+     *
+     * @param script 轨迹
+     * @param options 模拟参数
+     * @return QVector<CameraState> 每帧update之后的相机状态
+     */
+    static QVector<CameraState> runScript(const CameraSimulationScript &script,
+                                          const CameraSimulationOptions &options = CameraSimulationOptions());
+
+    /**
+     * @brief 在线程池中并行模拟多条轨迹, 等待全部完成后返回. 不能在pool的线程中调用
+     *
+     * @param scripts 轨迹
+     * @param options 模拟参数
+     * @param pool 线程池, 为空时使用QThreadPool::globalInstance(), 并行度由它的maxThreadCount决定
+     * @return QVector<QVector<CameraState>> 与scripts按顺序对应的结果
+     */
+    static QVector<QVector<CameraState>> run(const QVector<CameraSimulationScript> &scripts,
+                                             const CameraSimulationOptions &options = CameraSimulationOptions(),
+                                             QThreadPool *pool = nullptr);
+};
+
+#endif // CAMERASIMULATION_H
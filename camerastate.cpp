@@ -0,0 +1,138 @@
+#include "camerastate.h"
+
+namespace {
+
+inline quint64 toWord(double value)
+{
+    quint64 word;
+    memcpy(&word, &value, sizeof(word));
+    return word;
+}
+
+inline double toDouble(quint64 word)
+{
+    double value;
+    memcpy(&value, &word, sizeof(value));
+    return value;
+}
+
+}
+
+CameraStatePublisher::CameraStatePublisher()
+{
+    for (Slot &slot : _slots) {
+        slot.sequence.store(0, std::memory_order_relaxed);
+        for (std::atomic<quint64> &word : slot.words) {
+            word.store(0, std::memory_order_relaxed);
+        }
+    }
+    _epoch.store(0, std::memory_order_release);
+}
+
+void CameraStatePublisher::publish(const CameraState &state)
+{
+    quint64 words[WORD_COUNT];
+    quint64 epoch = _epoch.load(std::memory_order_relaxed) + 1;
+
+    CameraState published = state;
+    published.epoch = epoch;
+    pack(published, words);
+
+    // odd sequence: the slot is being written
+    Slot &slot = _slots[epoch % SLOT_COUNT];
+    quint64 sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (int i = 0; i < WORD_COUNT; ++i) {
+        slot.words[i].store(words[i], std::memory_order_relaxed);
+    }
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    _epoch.store(epoch, std::memory_order_release);
+}
+
+CameraState CameraStatePublisher::snapshot() const
+{
+    CameraState state;
+    quint64 words[WORD_COUNT];
+
+    for (;;) {
+        quint64 epoch = _epoch.load(std::memory_order_acquire);
+        if (epoch == 0) {
+            return state;
+        }
+
+        const Slot &slot = _slots[epoch % SLOT_COUNT];
+        quint64 before = slot.sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            // the writer has lapped the ring and is rewriting this slot, take the newer one
+            continue;
+        }
+
+        for (int i = 0; i < WORD_COUNT; ++i) {
+            words[i] = slot.words[i].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == before) {
+            break;
+        }
+    }
+
+    unpack(words, state);
+    return state;
+}
+
+quint64 CameraStatePublisher::epoch() const
+{
+    return _epoch.load(std::memory_order_acquire);
+}
+
+void CameraStatePublisher::pack(const CameraState &state, quint64 *words)
+{
+    words[0] = state.epoch;
+    words[1] = state.flying ? 1 : 0;
+    words[2] = toWord(state.timestamp);
+    words[3] = toWord(state.position.x);
+    words[4] = toWord(state.position.y);
+    words[5] = toWord(state.position.z);
+    words[6] = toWord(state.direction.x);
+    words[7] = toWord(state.direction.y);
+    words[8] = toWord(state.direction.z);
+    words[9] = toWord(state.up.x);
+    words[10] = toWord(state.up.y);
+    words[11] = toWord(state.up.z);
+    words[12] = toWord(state.right.x);
+    words[13] = toWord(state.right.y);
+    words[14] = toWord(state.right.z);
+    words[15] = toWord(state.positionCartographic.longitude);
+    words[16] = toWord(state.positionCartographic.latitude);
+    words[17] = toWord(state.positionCartographic.height);
+    words[18] = toWord(state.heading);
+    words[19] = toWord(state.pitch);
+    words[20] = toWord(state.roll);
+    words[21] = toWord(state.fovy);
+    words[22] = toWord(state.aspectRatio);
+    words[23] = toWord(state.nearPlane);
+    words[24] = toWord(state.farPlane);
+}
+
+void CameraStatePublisher::unpack(const quint64 *words, CameraState &state)
+{
+    state.epoch = words[0];
+    state.flying = words[1] != 0;
+    state.timestamp = toDouble(words[2]);
+    state.position = Cartesian3(toDouble(words[3]), toDouble(words[4]), toDouble(words[5]));
+    state.direction = Cartesian3(toDouble(words[6]), toDouble(words[7]), toDouble(words[8]));
+    state.up = Cartesian3(toDouble(words[9]), toDouble(words[10]), toDouble(words[11]));
+    state.right = Cartesian3(toDouble(words[12]), toDouble(words[13]), toDouble(words[14]));
+    state.positionCartographic = Cartographic(toDouble(words[15]), toDouble(words[16]), toDouble(words[17]));
+    state.heading = toDouble(words[18]);
+    state.pitch = toDouble(words[19]);
+    state.roll = toDouble(words[20]);
+    state.fovy = toDouble(words[21]);
+    state.aspectRatio = toDouble(words[22]);
+    state.nearPlane = toDouble(words[23]);
+    state.farPlane = toDouble(words[24]);
+}
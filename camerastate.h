@@ -0,0 +1,90 @@
+#ifndef CAMERASTATE_H
+#define CAMERASTATE_H
+
+#include <QtCore>
+#include <atomic>
+#include "cartesian3.h"
+#include "cartographic.h"
+
+/**
+ * @brief 相机状态快照, 每一帧由ScreenSpaceCameraController发布一次, 发布后不再修改
+ *
+ */
+struct CameraState {
+    quint64 epoch = 0; ///< 发布序号, 相机状态每改变一次加1, 0表示尚未发布
+    double timestamp = 0.0; ///< 发布时的帧时间 (毫秒, ScreenSpaceCameraController的时钟)
+    bool flying = false; ///< 相机是否正在飞行
+
+    Cartesian3 position; ///< 相机的世界坐标
+    Cartesian3 direction; ///< 相机的y轴方向 (世界坐标)
+    Cartesian3 up; ///< 相机的z轴方向 (世界坐标)
+    Cartesian3 right; ///< 相机的x轴方向 (世界坐标)
+    Cartographic positionCartographic; ///< 相机的Cartographic坐标
+
+    double heading = 0.0; ///< 相机的heading (弧度)
+    double pitch = 0.0; ///< 相机的pitch (弧度)
+    double roll = 0.0; ///< 相机的roll (弧度)
+
+    double fovy = 0.0; ///< 视角 (度)
+    double aspectRatio = 0.0; ///< 宽高比
+    double nearPlane = 0.0; ///< 近裁剪面
+    double farPlane = 0.0; ///< 远裁剪面
+};
+
+/**
+ * @brief 相机状态的发布类, 一个线程发布, 任意线程读取
+ *
+ * 使用多个槽位的seqlock: 发布时写入下一个槽位, 读取时复制最新的槽位并校验序号.
+ * 读取方不加锁也不等待发布方, 只有在一次读取期间发布方连续发布了SLOT_COUNT次才需要重新读取
+ */
+class CameraStatePublisher
+{
+public:
+    /**
+     * @brief 默认构造
+     *
+     */
+    CameraStatePublisher();
+
+    /**
+     * @brief 发布新的相机状态 (只能在一个线程中调用), epoch由发布类生成
+     *
+     * @param state 相机状态
+     */
+    void publish(const CameraState &state);
+
+    /**
+     * @brief 读取最新发布的相机状态 (线程安全)
+     *
+     * @return CameraState 相机状态, 尚未发布时epoch为0
+     */
+    CameraState snapshot() const;
+
+    /**
+     * @brief 获取最新发布的序号 (线程安全), 可用于判断相机是否发生变化
+     *
+     * @return quint64 发布序号
+     */
+    quint64 epoch() const;
+
+private:
+    Q_DISABLE_COPY(CameraStatePublisher)
+
+    enum {
+        WORD_COUNT = 25,
+        SLOT_COUNT = 4
+    };
+
+    struct Slot {
+        std::atomic<quint64> sequence;
+        std::atomic<quint64> words[WORD_COUNT];
+    };
+
+    static void pack(const CameraState &state, quint64 *words);
+    static void unpack(const quint64 *words, CameraState &state);
+
+    Slot _slots[SLOT_COUNT];
+    std::atomic<quint64> _epoch;
+};
+
+#endif // CAMERASTATE_H
@@ -0,0 +1,271 @@
+#include "camerasync.h"
+#include <QtEndian>
+#include <cmath>
+
+namespace {
+
+const double POSITION_SCALE = 1000.0; ///< 增量帧的位置单位为毫米
+const int COMPONENT_BITS = 20;
+const quint64 COMPONENT_MASK = (quint64(1) << COMPONENT_BITS) - 1;
+const double COMPONENT_RANGE = 0.70710678118654752440; ///< 非最大分量的绝对值不超过1/sqrt(2)
+
+void writeDouble(uchar *data, double value)
+{
+    quint64 word;
+    memcpy(&word, &value, sizeof(word));
+    qToLittleEndian<quint64>(word, data);
+}
+
+double readDouble(const uchar *data)
+{
+    quint64 word = qFromLittleEndian<quint64>(data);
+    double value;
+    memcpy(&value, &word, sizeof(value));
+    return value;
+}
+
+quint64 quantizeComponent(double value)
+{
+    double normalized = (value + COMPONENT_RANGE) / (2.0 * COMPONENT_RANGE);
+    normalized = std::min(std::max(normalized, 0.0), 1.0);
+    return quint64(std::lround(normalized * COMPONENT_MASK));
+}
+
+double dequantizeComponent(quint64 bits)
+{
+    return double(bits) / COMPONENT_MASK * (2.0 * COMPONENT_RANGE) - COMPONENT_RANGE;
+}
+
+bool toMillimeters(double value, qint32 &result)
+{
+    double scaled = std::round(value * POSITION_SCALE);
+    if (!(std::abs(scaled) <= 2147483647.0)) {
+        return false;
+    }
+    result = qint32(scaled);
+    return true;
+}
+
+}
+
+QByteArray CameraSyncEncoder::encode(const CameraSyncPose &pose)
+{
+    qint32 offset[3];
+    bool keyframe = _framesSinceKeyframe < 0 || _framesSinceKeyframe + 1 >= _keyframeInterval;
+    if (!keyframe) {
+        Cartesian3 delta = pose.position - _keyframePosition;
+        keyframe = !toMillimeters(delta.x, offset[0]) || !toMillimeters(delta.y, offset[1]) || !toMillimeters(delta.z, offset[2]);
+    }
+
+    if (keyframe) {
+        _framesSinceKeyframe = 0;
+        _keyframeId = quint8(_keyframeId + 1);
+        _keyframePosition = pose.position;
+    } else {
+        ++_framesSinceKeyframe;
+    }
+
+    QByteArray packet(keyframe ? KEYFRAME_SIZE : DELTA_SIZE, Qt::Uninitialized);
+    uchar *data = reinterpret_cast<uchar *>(packet.data());
+    data[0] = keyframe ? Keyframe : Delta;
+    data[1] = _keyframeId;
+    qToLittleEndian<quint32>(pose.frame, data + 2);
+
+    uchar *orientation;
+    if (keyframe) {
+        writeDouble(data + 6, pose.position.x);
+        writeDouble(data + 14, pose.position.y);
+        writeDouble(data + 22, pose.position.z);
+        orientation = data + 30;
+    } else {
+        for (int i = 0; i < 3; ++i) {
+            qToLittleEndian<qint32>(offset[i], data + 6 + i * 4);
+        }
+        orientation = data + 18;
+    }
+    qToLittleEndian<quint64>(encodeOrientation(pose.direction, pose.up, pose.right), orientation);
+
+    return packet;
+}
+
+void CameraSyncEncoder::setKeyframeInterval(int interval)
+{
+    _keyframeInterval = std::max(interval, 1);
+}
+
+quint64 CameraSyncEncoder::encodeOrientation(const Cartesian3 &direction, const Cartesian3 &up, const Cartesian3 &right)
+{
+    // 旋转矩阵的列为相机的x, y, z轴 (right, direction, up)
+    double m00 = right.x, m01 = direction.x, m02 = up.x;
+    double m10 = right.y, m11 = direction.y, m12 = up.y;
+    double m20 = right.z, m21 = direction.z, m22 = up.z;
+
+    double q[4]; // x, y, z, w
+    double trace = m00 + m11 + m22;
+    if (trace > 0.0) {
+        double s = 0.5 / sqrt(trace + 1.0);
+        q[3] = 0.25 / s;
+        q[0] = (m21 - m12) * s;
+        q[1] = (m02 - m20) * s;
+        q[2] = (m10 - m01) * s;
+    } else if (m00 > m11 && m00 > m22) {
+        double s = 2.0 * sqrt(1.0 + m00 - m11 - m22);
+        q[3] = (m21 - m12) / s;
+        q[0] = 0.25 * s;
+        q[1] = (m01 + m10) / s;
+        q[2] = (m02 + m20) / s;
+    } else if (m11 > m22) {
+        double s = 2.0 * sqrt(1.0 + m11 - m00 - m22);
+        q[3] = (m02 - m20) / s;
+        q[0] = (m01 + m10) / s;
+        q[1] = 0.25 * s;
+        q[2] = (m12 + m21) / s;
+    } else {
+        double s = 2.0 * sqrt(1.0 + m22 - m00 - m11);
+        q[3] = (m10 - m01) / s;
+        q[0] = (m02 + m20) / s;
+        q[1] = (m12 + m21) / s;
+        q[2] = 0.25 * s;
+    }
+
+    double length = sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    int largest = 0;
+    for (int i = 1; i < 4; ++i) {
+        if (std::abs(q[i]) > std::abs(q[largest])) {
+            largest = i;
+        }
+    }
+
+    // q和-q表示同一个旋转, 保证省略的最大分量为正
+    double scale = (q[largest] < 0.0 ? -1.0 : 1.0) / length;
+    quint64 bits = quint64(largest);
+    for (int i = 0; i < 4; ++i) {
+        if (i != largest) {
+            bits = (bits << COMPONENT_BITS) | quantizeComponent(q[i] * scale);
+        }
+    }
+    return bits;
+}
+
+void CameraSyncEncoder::decodeOrientation(quint64 bits, Cartesian3 &direction, Cartesian3 &up, Cartesian3 &right)
+{
+    int largest = int((bits >> (3 * COMPONENT_BITS)) & 0x3);
+
+    double q[4];
+    double sum = 0.0;
+    int shift = 2 * COMPONENT_BITS;
+    for (int i = 0; i < 4; ++i) {
+        if (i == largest) {
+            continue;
+        }
+        q[i] = dequantizeComponent((bits >> shift) & COMPONENT_MASK);
+        sum += q[i] * q[i];
+        shift -= COMPONENT_BITS;
+    }
+    q[largest] = sqrt(std::max(1.0 - sum, 0.0));
+
+    double length = sqrt(sum + q[largest] * q[largest]);
+    double x = q[0] / length, y = q[1] / length, z = q[2] / length, w = q[3] / length;
+
+    right = Cartesian3(1.0 - 2.0 * (y * y + z * z), 2.0 * (x * y + z * w), 2.0 * (x * z - y * w));
+    direction = Cartesian3(2.0 * (x * y - z * w), 1.0 - 2.0 * (x * x + z * z), 2.0 * (y * z + x * w));
+    up = Cartesian3(2.0 * (x * z + y * w), 2.0 * (y * z - x * w), 1.0 - 2.0 * (x * x + y * y));
+}
+
+bool CameraSyncDecoder::decode(const QByteArray &packet, CameraSyncPose &pose, bool *restarted)
+{
+    if (restarted) {
+        *restarted = false;
+    }
+    if (packet.isEmpty()) {
+        return false;
+    }
+
+    const uchar *data = reinterpret_cast<const uchar *>(packet.constData());
+    quint8 type = data[0];
+    if (!(type == CameraSyncEncoder::Keyframe && packet.size() == CameraSyncEncoder::KEYFRAME_SIZE) &&
+            !(type == CameraSyncEncoder::Delta && packet.size() == CameraSyncEncoder::DELTA_SIZE)) {
+        return false;
+    }
+
+    quint8 keyframeId = data[1];
+    quint32 frame = qFromLittleEndian<quint32>(data + 2);
+    const uchar *orientation;
+
+    if (type == CameraSyncEncoder::Keyframe) {
+        Cartesian3 position(readDouble(data + 6), readDouble(data + 14), readDouble(data + 22));
+        // UDP可能乱序, 迟到的旧关键帧不替换当前的关键帧; 早得多的关键帧来自重启的主控节点
+        qint32 age = qint32(frame - _keyframeFrame);
+        bool restart = _hasKeyframe && age < -MAXIMUM_REORDER;
+        if (!_hasKeyframe || age > 0 || restart) {
+            if (restarted) {
+                *restarted = restart;
+            }
+            _hasKeyframe = true;
+            _keyframeId = keyframeId;
+            _keyframeFrame = frame;
+            _keyframePosition = position;
+        }
+        pose.position = position;
+        orientation = data + 30;
+    } else {
+        if (!_hasKeyframe || keyframeId != _keyframeId) {
+            return false;
+        }
+        pose.position = Cartesian3(_keyframePosition.x + qFromLittleEndian<qint32>(data + 6) / POSITION_SCALE,
+                                   _keyframePosition.y + qFromLittleEndian<qint32>(data + 10) / POSITION_SCALE,
+                                   _keyframePosition.z + qFromLittleEndian<qint32>(data + 14) / POSITION_SCALE);
+        orientation = data + 18;
+    }
+
+    pose.frame = frame;
+    CameraSyncEncoder::decodeOrientation(qFromLittleEndian<quint64>(orientation), pose.direction, pose.up, pose.right);
+    return true;
+}
+
+CameraSyncTransport::CameraSyncTransport(QObject *parent)
+    : QObject(parent)
+{
+}
+
+UdpCameraSyncTransport::UdpCameraSyncTransport(QObject *parent)
+    : CameraSyncTransport(parent)
+{
+    connect(&_socket, &QUdpSocket::readyRead, this, &UdpCameraSyncTransport::readPendingDatagrams);
+}
+
+void UdpCameraSyncTransport::setDestination(const QHostAddress &address, quint16 port)
+{
+    _destination = address;
+    _port = port;
+}
+
+bool UdpCameraSyncTransport::bind(const QHostAddress &address, quint16 port, const QHostAddress &multicastGroup)
+{
+    if (!_socket.bind(address, port, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint)) {
+        return false;
+    }
+    if (!multicastGroup.isNull()) {
+        return _socket.joinMulticastGroup(multicastGroup);
+    }
+    return true;
+}
+
+bool UdpCameraSyncTransport::send(const QByteArray &packet)
+{
+    if (_destination.isNull() || _port == 0) {
+        return false;
+    }
+    return _socket.writeDatagram(packet, _destination, _port) == packet.size();
+}
+
+void UdpCameraSyncTransport::readPendingDatagrams()
+{
+    while (_socket.hasPendingDatagrams()) {
+        QByteArray packet;
+        packet.resize(int(_socket.pendingDatagramSize()));
+        if (_socket.readDatagram(packet.data(), packet.size()) == packet.size()) {
+            emit packetReceived(packet);
+        }
+    }
+}
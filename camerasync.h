@@ -0,0 +1,198 @@
+#ifndef CAMERASYNC_H
+#define CAMERASYNC_H
+
+#include "sscc_global.h"
+#include <QHostAddress>
+#include <QUdpSocket>
+#include "cartesian3.h"
+
+/**
+ * @brief 一帧的相机位姿 (世界坐标), 由主控节点发布, 跟随节点按帧号应用
+ *
+ */
+struct CameraSyncPose {
+    quint32 frame = 0; ///< 主控节点的帧号
+    Cartesian3 position; ///< 相机位置
+    Cartesian3 direction; ///< 相机的y轴方向
+    Cartesian3 up; ///< 相机的z轴方向
+    Cartesian3 right; ///< 相机的x轴方向
+};
+
+/**
+ * @brief 相机位姿数据包的编码
+ *
+ * 关键帧保存完整的位置 (3个double), 其余帧保存相对最近一个关键帧的位置偏移 (3个qint32, 单位毫米),
+ * 偏移只相对关键帧, 丢失的增量包不会累积误差. 方向用smallest-three量化的四元数保存 (8字节).
+ * 关键帧38字节, 增量帧26字节 (小端)
+ */
+class CONTROLLER_EXPORT CameraSyncEncoder
+{
+public:
+    /**
+     * @brief 数据包的类型, 每个数据包的第一个字节
+     *
+     */
+    enum PacketType {
+        Keyframe = 0x4B,
+        Delta = 0x44
+    };
+
+    enum {
+        KEYFRAME_SIZE = 38,
+        DELTA_SIZE = 26
+    };
+
+    /**
+     * @brief 编码一帧
+     *
+     * @param pose 相机位姿
+     * @return QByteArray 数据包
+     */
+    QByteArray encode(const CameraSyncPose &pose);
+
+    /**
+     * @brief 获取关键帧间隔
+     *
+     * @return int 帧数
+     */
+    int keyframeInterval() const { return _keyframeInterval; }
+
+    /**
+     * @brief 设置关键帧间隔, 默认60帧. 偏移超过qint32的范围时也会发送关键帧
+     *
+     * @param interval 帧数
+     */
+    void setKeyframeInterval(int interval);
+
+    /**
+     * @brief 下一帧强制发送关键帧 (例如有新的跟随节点加入)
+     *
+     */
+    void reset() { _framesSinceKeyframe = -1; }
+
+    /**
+     * @brief 方向 (相机的三个轴) 编码成smallest-three四元数 (2位最大分量的索引, 其余3个分量各20位)
+     *
+     * @param direction 相机的y轴方向
+     * @param up 相机的z轴方向
+     * @param right 相机的x轴方向
+     * @return quint64 编码结果
+     */
+    static quint64 encodeOrientation(const Cartesian3 &direction, const Cartesian3 &up, const Cartesian3 &right);
+
+    /**
+     * @brief 解码smallest-three四元数
+     *
+     * @param bits encodeOrientation的结果
+     * @param direction 按引用传递一个参数, 最后变成相机的y轴方向
+     * @param up 按引用传递一个参数, 最后变成相机的z轴方向
+     * @param right 按引用传递一个参数, 最后变成相机的x轴方向
+     */
+    static void decodeOrientation(quint64 bits, Cartesian3 &direction, Cartesian3 &up, Cartesian3 &right);
+
+private:
+    int _keyframeInterval = 60;
+    int _framesSinceKeyframe = -1; ///< 小于0时下一帧发送关键帧
+    quint8 _keyframeId = 0;
+    Cartesian3 _keyframePosition;
+};
+
+/**
+ * @brief 相机位姿数据包的解码, 与CameraSyncEncoder对应
+ *
+ */
+class CONTROLLER_EXPORT CameraSyncDecoder
+{
+public:
+    enum {
+        MAXIMUM_REORDER = 64 ///< 关键帧比当前关键帧早超过这个帧数时, 认为主控节点已重启 (帧号从0开始), 而不是乱序迟到
+    };
+
+    /**
+     * @brief 解码一个数据包
+     *
+     * @param packet 数据包
+     * @param pose 按引用传递一个参数, 最后变成相机位姿
+     * @param restarted 不为空时返回这个数据包是否是主控节点重启后的关键帧
+     * @return bool true: 成功, false: 数据包无效或还没有收到对应的关键帧
+     */
+    bool decode(const QByteArray &packet, CameraSyncPose &pose, bool *restarted = nullptr);
+
+    /**
+     * @brief 丢弃已收到的关键帧
+     *
+     */
+    void reset() { _hasKeyframe = false; }
+
+private:
+    bool _hasKeyframe = false;
+    quint8 _keyframeId = 0;
+    quint32 _keyframeFrame = 0;
+    Cartesian3 _keyframePosition;
+};
+
+/**
+ * @brief 相机同步数据包的传输接口
+ *
+ * 实现在收到数据包时发出packetReceived (在所属线程中)
+ */
+class CONTROLLER_EXPORT CameraSyncTransport : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CameraSyncTransport(QObject *parent = nullptr);
+
+    /**
+     * @brief 发送一个数据包
+     *
+     * @param packet 数据包
+     * @return bool true: 已发送, false: 发送失败
+     */
+    virtual bool send(const QByteArray &packet) = 0;
+
+signals:
+    void packetReceived(const QByteArray &packet);
+};
+
+/**
+ * @brief 基于UDP的传输, 主控节点发送到广播, 组播或单个地址, 跟随节点绑定端口接收. 可以在本机回环地址上测试
+ *
+ */
+class CONTROLLER_EXPORT UdpCameraSyncTransport : public CameraSyncTransport
+{
+    Q_OBJECT
+
+public:
+    explicit UdpCameraSyncTransport(QObject *parent = nullptr);
+
+    /**
+     * @brief 设置发送的目标地址 (主控节点)
+     *
+     * @param address 目标地址, 例如QHostAddress::LocalHost, 广播地址或组播地址
+     * @param port 目标端口
+     */
+    void setDestination(const QHostAddress &address, quint16 port);
+
+    /**
+     * @brief 绑定端口接收数据包 (跟随节点)
+     *
+     * @param address 绑定的地址
+     * @param port 绑定的端口
+     * @param multicastGroup 不为空时加入这个组播组
+     * @return bool true: 成功, false: 失败
+     */
+    bool bind(const QHostAddress &address, quint16 port, const QHostAddress &multicastGroup = QHostAddress());
+
+    bool send(const QByteArray &packet) override;
+
+private slots:
+    void readPendingDatagrams();
+
+private:
+    QUdpSocket _socket;
+    QHostAddress _destination;
+    quint16 _port = 0;
+};
+
+#endif // CAMERASYNC_H
@@ -0,0 +1,274 @@
+#include "cameratour.h"
+#include "liutils.h"
+#include "ellipsoid.h"
+#include "cesiummath.h"
+#include "cesiumcartesian3.h"
+
+namespace {
+
+double unwrapAngle(double previous, double angle)
+{
+    double twoPI = 2.0 * M_PI;
+    while (angle - previous > M_PI) {
+        angle -= twoPI;
+    }
+    while (angle - previous < -M_PI) {
+        angle += twoPI;
+    }
+    return angle;
+}
+
+double hermiteValue(double x, double p1, double p2, double m1, double m2)
+{
+    double x2 = x * x;
+    double x3 = x2 * x;
+    return (2.0 * x3 - 3.0 * x2 + 1.0) * p1 +
+            (x3 - 2.0 * x2 + x) * m1 +
+            (-2.0 * x3 + 3.0 * x2) * p2 +
+            (x3 - x2) * m2;
+}
+
+}
+
+CameraTour::CameraTour(const QVector<CameraWaypoint> &waypoints)
+{
+    build(waypoints);
+}
+
+bool CameraTour::isValid() const
+{
+    return _times.length() >= 2;
+}
+
+double CameraTour::duration() const
+{
+    return isValid() ? _times.last() : 0.0;
+}
+
+double CameraTour::length() const
+{
+    return isValid() ? _distances.last() : 0.0;
+}
+
+CameraPose CameraTour::evaluate(double time) const
+{
+    CameraPose pose;
+    if (!isValid()) {
+        return pose;
+    }
+
+    time = std::max(0.0, std::min(time, duration()));
+    int segment = findSegment(time);
+
+    double h = _times[segment + 1] - _times[segment];
+    double x = (time - _times[segment]) / h;
+
+    double startDistance = _distances[segment];
+    double segmentLength = _distances[segment + 1] - startDistance;
+
+    double u = 0.0;
+    double f = x;
+    if (segmentLength > Math::EPSILON6) {
+        double distance = hermiteValue(x, startDistance, _distances[segment + 1], h * _speeds[segment], h * _speeds[segment + 1]);
+        f = std::max(0.0, std::min((distance - startDistance) / segmentLength, 1.0));
+
+        double index = f * ARC_SAMPLES;
+        int k = std::min(static_cast<int>(index), ARC_SAMPLES - 1);
+        const double *table = _arcToParam.constData() + segment * (ARC_SAMPLES + 1);
+        u = table[k] + (table[k + 1] - table[k]) * (index - k);
+    }
+
+    pose.position = toCartesian(_positions[segment].evaluate(u));
+
+    Cartesian3 orientation = _orientations[segment].evaluate(f);
+    pose.heading = CesiumMath::zeroToTwoPi(orientation.x);
+    pose.pitch = orientation.y;
+    pose.roll = CesiumMath::zeroToTwoPi(orientation.z);
+
+    return pose;
+}
+
+void CameraTour::headingPitchToTarget(const Cartesian3 &position, const Cartesian3 &target, double &heading, double &pitch)
+{
+    Cartesian3 direction = (target - position).normalized();
+    Cartesian3 up = Ellipsoid::WGS84()->geodeticSurfaceNormal(position);
+    Cartesian3 east = Cartesian3::cross(Cartesian3::UNIT_Z, up);
+    if (east.magnitudeSquared() < Math::EPSILON12) {
+        east = Cartesian3::UNIT_Y;
+    }
+    east.normalize();
+    Cartesian3 north = Cartesian3::cross(up, east);
+
+    heading = CesiumMath::zeroToTwoPi(atan2(Cartesian3::dot(direction, east), Cartesian3::dot(direction, north)));
+    pitch = M_PI_2 - CesiumMath::acosClamped(Cartesian3::dot(direction, up));
+}
+
+double CameraTour::defaultSegmentDuration(const Cartesian3 &start, const Cartesian3 &end)
+{
+    double duration = ceil((start - end).magnitude() / 1000000.0) + 2.0;
+    return std::min(duration, 3.0);
+}
+
+Cartesian3 CameraTour::CubicSegment::evaluate(double u) const
+{
+    return ((a * u + b) * u + c) * u + d;
+}
+
+CameraTour::CubicSegment CameraTour::hermite(const Cartesian3 &p1, const Cartesian3 &p2, const Cartesian3 &m1, const Cartesian3 &m2)
+{
+    CubicSegment segment;
+    segment.a = p1 * 2.0 - p2 * 2.0 + m1 + m2;
+    segment.b = p2 * 3.0 - p1 * 3.0 - m1 * 2.0 - m2;
+    segment.c = m1;
+    segment.d = p1;
+    return segment;
+}
+
+CameraTour::CubicSegment CameraTour::catmullRom(const Cartesian3 &p0, const Cartesian3 &p1, const Cartesian3 &p2, const Cartesian3 &p3,
+                                                double t01, double t12, double t23)
+{
+    // non-uniform Catmull-Rom tangents, rescaled to the [0, 1] parameter of the middle segment
+    Cartesian3 m1 = ((p1 - p0) / t01 - (p2 - p0) / (t01 + t12) + (p2 - p1) / t12) * t12;
+    Cartesian3 m2 = ((p2 - p1) / t12 - (p3 - p1) / (t12 + t23) + (p3 - p2) / t23) * t12;
+    return hermite(p1, p2, m1, m2);
+}
+
+void CameraTour::build(const QVector<CameraWaypoint> &waypoints)
+{
+    int count = waypoints.length();
+    if (count < 2) {
+        return;
+    }
+
+    QVector<Cartesian3> controls(count);
+    QVector<Cartesian3> angles(count);
+    QVector<double> knots(count - 1);
+    _times.resize(count);
+
+    for (int i = 0; i < count; ++i) {
+        const CameraWaypoint &waypoint = waypoints[i];
+
+        Cartographic cartographic = cartesianToCartographic(waypoint.position);
+        double longitude = cartographic.longitude;
+        if (i > 0) {
+            longitude = unwrapAngle(controls[i - 1].x, longitude);
+        }
+        controls[i] = Cartesian3(longitude, cartographic.latitude, cartographic.height);
+
+        double heading = waypoint.heading;
+        double pitch = waypoint.pitch;
+        double roll = waypoint.roll;
+        if (defined(waypoint.target)) {
+            headingPitchToTarget(waypoint.position, waypoint.target, heading, pitch);
+            roll = 0.0;
+        }
+        if (i > 0) {
+            heading = unwrapAngle(angles[i - 1].x, heading);
+            roll = unwrapAngle(angles[i - 1].z, roll);
+        }
+        angles[i] = Cartesian3(heading, pitch, roll);
+
+        if (i == 0) {
+            _times[i] = 0.0;
+        } else {
+            double time = waypoint.time - (defined(waypoints[0].time) ? waypoints[0].time : 0.0);
+            if (!defined(waypoint.time) || time <= _times[i - 1]) {
+                time = _times[i - 1] + defaultSegmentDuration(waypoints[i - 1].position, waypoint.position);
+            }
+            _times[i] = time;
+
+            // centripetal parameterization: knot spacing is the square root of the chord length
+            knots[i - 1] = std::max(sqrt((waypoint.position - waypoints[i - 1].position).magnitude()), Math::EPSILON4);
+        }
+    }
+
+    int segments = count - 1;
+    _positions.resize(segments);
+    _orientations.resize(segments);
+    for (int i = 0; i < segments; ++i) {
+        Cartesian3 p0 = i > 0 ? controls[i - 1] : controls[0] * 2.0 - controls[1];
+        Cartesian3 p3 = i + 2 < count ? controls[i + 2] : controls[count - 1] * 2.0 - controls[count - 2];
+        double t01 = i > 0 ? knots[i - 1] : knots[i];
+        double t23 = i + 1 < segments ? knots[i + 1] : knots[i];
+        _positions[i] = catmullRom(p0, controls[i], controls[i + 1], p3, t01, knots[i], t23);
+
+        Cartesian3 a0 = i > 0 ? angles[i - 1] : angles[0] * 2.0 - angles[1];
+        Cartesian3 a3 = i + 2 < count ? angles[i + 2] : angles[count - 1] * 2.0 - angles[count - 2];
+        _orientations[i] = catmullRom(a0, angles[i], angles[i + 1], a3, 1.0, 1.0, 1.0);
+    }
+
+    _distances.resize(count);
+    _distances[0] = 0.0;
+    _arcToParam.resize(segments * (ARC_SAMPLES + 1));
+    for (int i = 0; i < segments; ++i) {
+        buildArcLengthTable(i);
+    }
+
+    // time -> distance is a monotone cubic Hermite curve: the camera starts and ends at rest
+    // and passes through each waypoint with the harmonic mean of the neighbouring segment speeds,
+    // so chained stops do not produce velocity jumps
+    _speeds.fill(0.0, count);
+    for (int i = 1; i < segments; ++i) {
+        double before = (_distances[i] - _distances[i - 1]) / (_times[i] - _times[i - 1]);
+        double after = (_distances[i + 1] - _distances[i]) / (_times[i + 1] - _times[i]);
+        if (before > 0.0 && after > 0.0) {
+            _speeds[i] = 2.0 * before * after / (before + after);
+        }
+    }
+}
+
+void CameraTour::buildArcLengthTable(int segment)
+{
+    double lengths[ARC_SAMPLES + 1];
+    lengths[0] = 0.0;
+
+    const CubicSegment &spline = _positions[segment];
+    Cartesian3 previous = toCartesian(spline.evaluate(0.0));
+    for (int j = 1; j <= ARC_SAMPLES; ++j) {
+        Cartesian3 current = toCartesian(spline.evaluate(static_cast<double>(j) / ARC_SAMPLES));
+        lengths[j] = lengths[j - 1] + (current - previous).magnitude();
+        previous = current;
+    }
+
+    double length = lengths[ARC_SAMPLES];
+    _distances[segment + 1] = _distances[segment] + length;
+
+    double *table = _arcToParam.data() + segment * (ARC_SAMPLES + 1);
+    int j = 0;
+    for (int k = 0; k <= ARC_SAMPLES; ++k) {
+        double target = length * k / ARC_SAMPLES;
+        while (j < ARC_SAMPLES - 1 && lengths[j + 1] < target) {
+            ++j;
+        }
+
+        double span = lengths[j + 1] - lengths[j];
+        double w = span > 0.0 ? (target - lengths[j]) / span : 0.0;
+        w = std::max(0.0, std::min(w, 1.0));
+        table[k] = (j + w) / ARC_SAMPLES;
+    }
+    table[0] = 0.0;
+    table[ARC_SAMPLES] = 1.0;
+}
+
+int CameraTour::findSegment(double time) const
+{
+    int segments = _times.length() - 1;
+    int hint = std::min(_segmentHint, segments - 1);
+
+    if (time >= _times[hint] && time <= _times[hint + 1]) {
+        return hint;
+    }
+    if (hint + 2 <= segments && time >= _times[hint + 1] && time <= _times[hint + 2]) {
+        _segmentHint = hint + 1;
+        return _segmentHint;
+    }
+
+    int index = static_cast<int>(std::upper_bound(_times.constBegin(), _times.constEnd(), time) - _times.constBegin()) - 1;
+    _segmentHint = std::max(0, std::min(index, segments - 1));
+    return _segmentHint;
+}
+
+Cartesian3 CameraTour::toCartesian(const Cartesian3 &lonLatHeight) const
+{
+    return CesiumCartesian3::fromRadians(lonLatHeight.x, lonLatHeight.y, lonLatHeight.z);
+}
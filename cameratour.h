@@ -0,0 +1,119 @@
+#ifndef CAMERATOUR_H
+#define CAMERATOUR_H
+
+#include <QtCore>
+#include "cartesian3.h"
+#include "screenspaceeventutils.h"
+
+/**
+ * @brief 相机漫游的途经点
+ *
+ */
+struct CameraWaypoint {
+    Cartesian3 position; ///< 途经点的世界坐标
+    double heading = 0.0; ///< 相机的heading (弧度)
+    double pitch = -M_PI_2; ///< 相机的pitch (弧度)
+    double roll = 0.0; ///< 相机的roll (弧度)
+    Cartesian3 target = Cartesian3(Math::EPSILON20, 0, 0); ///< 相机看向的目标点 (世界坐标), 有效时忽略heading/pitch/roll
+    double time = Math::EPSILON20; ///< 到达该点的时间 (秒, 相对漫游开始), 无效时按照与上一个点的距离自动计算
+};
+
+/**
+ * @brief 相机漫游路径
+ *
+ * 创建时把所有途经点拟合为一条连续的centripetal Catmull-Rom样条 (经度, 纬度, 高度),
+ * 并为每一段建立弧长参数表; 漫游过程中每一帧只需查表和计算一次三次多项式, 与途经点数量无关
+ */
+class CameraTour
+{
+public:
+    /**
+     * @brief 带参构造
+     *
+     * @param waypoints 途经点, 至少两个
+     */
+    CameraTour(const QVector<CameraWaypoint> &waypoints);
+
+    /**
+     * @brief 路径是否有效
+     *
+     * @return bool true: 有效, false: 途经点不足两个
+     */
+    bool isValid() const;
+
+    /**
+     * @brief 漫游的总时间
+     *
+     * @return double 总时间 (秒)
+     */
+    double duration() const;
+
+    /**
+     * @brief 漫游路径的总长度
+     *
+     * @return double 总长度 (米)
+     */
+    double length() const;
+
+    /**
+     * @brief 计算指定时刻的相机位姿
+     *
+     * @param time 相对漫游开始的时间 (秒)
+     * @return CameraPose 相机位姿
+     */
+    CameraPose evaluate(double time) const;
+
+    /**
+     * @brief 计算从position看向target时的heading和pitch
+     *
+     * @param position 相机的世界坐标
+     * @param target 目标点的世界坐标
+     * @param heading 按引用传递一个参数, 最后变成heading (弧度)
+     * @param pitch 按引用传递一个参数, 最后变成pitch (弧度)
+     */
+    static void headingPitchToTarget(const Cartesian3 &position, const Cartesian3 &target, double &heading, double &pitch);
+
+    /**
+     * @brief 根据两点的距离计算默认的飞行时间, 与flyTo的默认时间一致
+     *
+     * @param start 起点
+     * @param end 终点
+     * @return double 飞行时间 (秒)
+     */
+    static double defaultSegmentDuration(const Cartesian3 &start, const Cartesian3 &end);
+
+private:
+    /**
+     * @brief 三次多项式段, 按Horner形式存储: p(u) = ((a * u + b) * u + c) * u + d
+     *
+     */
+    struct CubicSegment {
+        Cartesian3 a;
+        Cartesian3 b;
+        Cartesian3 c;
+        Cartesian3 d;
+
+        Cartesian3 evaluate(double u) const;
+    };
+
+    static CubicSegment hermite(const Cartesian3 &p1, const Cartesian3 &p2, const Cartesian3 &m1, const Cartesian3 &m2);
+    static CubicSegment catmullRom(const Cartesian3 &p0, const Cartesian3 &p1, const Cartesian3 &p2, const Cartesian3 &p3,
+                                   double t01, double t12, double t23);
+
+    void build(const QVector<CameraWaypoint> &waypoints);
+    void buildArcLengthTable(int segment);
+    int findSegment(double time) const;
+    Cartesian3 toCartesian(const Cartesian3 &lonLatHeight) const;
+
+    static const int ARC_SAMPLES = 32;
+
+    QVector<double> _times; ///< 到达每个途经点的时间
+    QVector<double> _distances; ///< 到达每个途经点的累计路径长度
+    QVector<double> _speeds; ///< 经过每个途经点时的速度, 用于三次Hermite时间-距离曲线
+    QVector<CubicSegment> _positions; ///< 位置样条 (经度, 纬度, 高度)
+    QVector<CubicSegment> _orientations; ///< 姿态样条 (heading, pitch, roll)
+    QVector<double> _arcToParam; ///< 每段(ARC_SAMPLES + 1)个, 等弧长对应的样条参数
+    mutable int _segmentHint = 0; ///< 上一次所在的段, 顺序播放时不需要重新查找
+};
+
+#endif // CAMERATOUR_H
@@ -0,0 +1,129 @@
+#include "cullingvolume.h"
+#include "screenspaceeventutils.h"
+
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#include <immintrin.h>
+#define CULLINGVOLUME_AVX2
+#endif
+
+CullingVolume::CullingVolume()
+{
+    for (int i = 0; i < PLANE_COUNT; ++i) {
+        _normalX[i] = 0.0;
+        _normalY[i] = 0.0;
+        _normalZ[i] = 0.0;
+        _distance[i] = 0.0;
+    }
+}
+
+CullingVolume::CullingVolume(const Cartesian3 &position, const Cartesian3 &direction, const Cartesian3 &up, const Cartesian3 &right,
+                             double fovy, double aspectRatio, double nearPlane, double farPlane)
+    : CullingVolume()
+{
+    _fovy = fovy;
+    _aspectRatio = aspectRatio;
+    _nearPlane = nearPlane;
+    _farPlane = farPlane;
+
+    double t = nearPlane * tan(Math::toRadians(fovy) * 0.5);
+    double r = aspectRatio * t;
+
+    Cartesian3 nearCenter = position + direction * nearPlane;
+    Cartesian3 farCenter = position + direction * farPlane;
+    Cartesian3 normal;
+
+    // Left plane
+    normal = (nearCenter - right * r - position).normalize();
+    normal = Cartesian3::cross(normal, up).normalize();
+    setPlane(0, normal, -Cartesian3::dot(normal, position));
+
+    // Right plane
+    normal = (nearCenter + right * r - position).normalize();
+    normal = Cartesian3::cross(up, normal).normalize();
+    setPlane(1, normal, -Cartesian3::dot(normal, position));
+
+    // Bottom plane
+    normal = (nearCenter - up * t - position).normalize();
+    normal = Cartesian3::cross(right, normal).normalize();
+    setPlane(2, normal, -Cartesian3::dot(normal, position));
+
+    // Top plane
+    normal = (nearCenter + up * t - position).normalize();
+    normal = Cartesian3::cross(normal, right).normalize();
+    setPlane(3, normal, -Cartesian3::dot(normal, position));
+
+    // Near plane
+    setPlane(4, direction, -Cartesian3::dot(direction, nearCenter));
+
+    // Far plane
+    setPlane(5, direction * -1.0, Cartesian3::dot(direction, farCenter));
+
+    _planeCount = PLANE_COUNT;
+}
+
+void CullingVolume::plane(int index, Cartesian3 &normal, double &distance) const
+{
+    normal = Cartesian3(_normalX[index], _normalY[index], _normalZ[index]);
+    distance = _distance[index];
+}
+
+CullingVolume::Visibility CullingVolume::computeVisibility(const Cartesian3 &center, double radius) const
+{
+    bool intersecting = false;
+    for (int i = 0; i < _planeCount; ++i) {
+        double distance = _normalX[i] * center.x + _normalY[i] * center.y + _normalZ[i] * center.z + _distance[i];
+        if (distance < -radius) {
+            return Outside;
+        }
+        if (distance < radius) {
+            intersecting = true;
+        }
+    }
+    return intersecting ? Intersecting : Inside;
+}
+
+void CullingVolume::computeVisibility(const double *x, const double *y, const double *z, const double *radius,
+                                      qint8 *results, int count) const
+{
+    int i = 0;
+
+#ifdef CULLINGVOLUME_AVX2
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+
+    for (; i + 4 <= count; i += 4) {
+        __m256d cx = _mm256_loadu_pd(x + i);
+        __m256d cy = _mm256_loadu_pd(y + i);
+        __m256d cz = _mm256_loadu_pd(z + i);
+        __m256d r = _mm256_loadu_pd(radius + i);
+        __m256d negativeR = _mm256_xor_pd(r, signMask);
+
+        __m256d outside = _mm256_setzero_pd();
+        __m256d intersecting = _mm256_setzero_pd();
+        for (int p = 0; p < _planeCount; ++p) {
+            __m256d distance = _mm256_fmadd_pd(_mm256_set1_pd(_normalZ[p]), cz,
+                               _mm256_fmadd_pd(_mm256_set1_pd(_normalY[p]), cy,
+                               _mm256_fmadd_pd(_mm256_set1_pd(_normalX[p]), cx, _mm256_set1_pd(_distance[p]))));
+            outside = _mm256_or_pd(outside, _mm256_cmp_pd(distance, negativeR, _CMP_LT_OQ));
+            intersecting = _mm256_or_pd(intersecting, _mm256_cmp_pd(distance, r, _CMP_LT_OQ));
+        }
+
+        int outsideMask = _mm256_movemask_pd(outside);
+        int intersectingMask = _mm256_movemask_pd(intersecting);
+        for (int k = 0; k < 4; ++k) {
+            results[i + k] = (outsideMask >> k) & 1 ? qint8(Outside) : ((intersectingMask >> k) & 1 ? qint8(Intersecting) : qint8(Inside));
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        results[i] = qint8(computeVisibility(Cartesian3(x[i], y[i], z[i]), radius[i]));
+    }
+}
+
+void CullingVolume::setPlane(int index, const Cartesian3 &normal, double distance)
+{
+    _normalX[index] = normal.x;
+    _normalY[index] = normal.y;
+    _normalZ[index] = normal.z;
+    _distance[index] = distance;
+}
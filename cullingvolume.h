@@ -0,0 +1,101 @@
+#ifndef CULLINGVOLUME_H
+#define CULLINGVOLUME_H
+
+#include "sscc_global.h"
+#include "cartesian3.h"
+
+/**
+ * @brief 视锥的裁剪体 (6个平面, 法线指向视锥内部), 用于包围球的可见性测试
+ *
+ * 视锥与CameraController::getPickRayPerspective相同. 平面按SoA存放, 批量测试在编译时开启AVX2和FMA时每次处理4个包围球
+ */
+class CONTROLLER_EXPORT CullingVolume
+{
+public:
+    /**
+     * @brief 可见性
+     *
+     */
+    enum Visibility {
+        Outside = -1, ///< 完全在裁剪体外
+        Intersecting = 0, ///< 与裁剪体相交
+        Inside = 1 ///< 完全在裁剪体内
+    };
+
+    enum {
+        PLANE_COUNT = 6
+    };
+
+    /**
+     * @brief 默认构造 (没有平面, 所有包围球都在裁剪体内)
+     *
+     */
+    CullingVolume();
+
+    /**
+     * @brief 由相机构造 (世界坐标)
+     *
+     * @param position 相机位置
+     * @param direction 相机的y轴方向
+     * @param up 相机的z轴方向
+     * @param right 相机的x轴方向
+     * @param fovy 视角 (度)
+     * @param aspectRatio 宽高比
+     * @param nearPlane 近裁剪面
+     * @param farPlane 远裁剪面
+     */
+    CullingVolume(const Cartesian3 &position, const Cartesian3 &direction, const Cartesian3 &up, const Cartesian3 &right,
+                  double fovy, double aspectRatio, double nearPlane, double farPlane);
+
+    /**
+     * @brief 获取平面, 顺序为左, 右, 下, 上, 近, 远
+     *
+     * @param index 平面的索引
+     * @param normal 按引用传递一个参数, 最后变成平面的法线 (指向裁剪体内部)
+     * @param distance 按引用传递一个参数, 最后变成平面到原点的距离, 点p在平面内侧时 dot(normal, p) + distance >= 0
+     */
+    void plane(int index, Cartesian3 &normal, double &distance) const;
+
+    /**
+     * @brief 测试一个包围球
+     *
+     * @param center 球心 (世界坐标)
+     * @param radius 半径
+     * @return Visibility 可见性
+     */
+    Visibility computeVisibility(const Cartesian3 &center, double radius) const;
+
+    /**
+     * @brief 批量测试包围球 (SoA数组)
+     *
+     * @param x 球心的x数组
+     * @param y 球心的y数组
+     * @param z 球心的z数组
+     * @param radius 半径数组
+     * @param results 每个包围球的Visibility
+     * @param count 包围球的数量
+     */
+    void computeVisibility(const double *x, const double *y, const double *z, const double *radius,
+                           qint8 *results, int count) const;
+
+    double fovy() const { return _fovy; }
+    double aspectRatio() const { return _aspectRatio; }
+    double nearPlane() const { return _nearPlane; }
+    double farPlane() const { return _farPlane; }
+
+private:
+    void setPlane(int index, const Cartesian3 &normal, double distance);
+
+    int _planeCount = 0;
+    double _normalX[PLANE_COUNT];
+    double _normalY[PLANE_COUNT];
+    double _normalZ[PLANE_COUNT];
+    double _distance[PLANE_COUNT];
+
+    double _fovy = 0.0;
+    double _aspectRatio = 0.0;
+    double _nearPlane = 0.0;
+    double _farPlane = 0.0;
+};
+
+#endif // CULLINGVOLUME_H
@@ -0,0 +1,278 @@
+#ifndef EASING_H
+#define EASING_H
+
+#include <cmath>
+
+/**
+ * @brief 动画插值函数类型
+ *
+ */
+struct EasingType {
+    /**
+     * @brief 类型集合
+     *
+     */
+    enum Type {
+        LinearNone = 0,
+        QuadraticIn,
+        QuadraticOut,
+        QuadraticInOut,
+        CubicIn,
+        CubicOut,
+        CubicInOut,
+        QuarticIn,
+        QuarticOut,
+        QuarticInOut,
+        QuinticIn,
+        QuinticOut,
+        QuinticInOut,
+        SinusoidalIn,
+        SinusoidalOut,
+        SinusoidalInOut,
+        ExponentialIn,
+        ExponentialOut,
+        ExponentialInOut,
+        CircularIn,
+        CircularOut,
+        CircularInOut,
+        ElasticIn,
+        ElasticOut,
+        ElasticInOut,
+        BackIn,
+        BackOut,
+        BackInOut,
+        BounceIn,
+        BounceOut,
+        BounceInOut,
+        TypeCount
+    };
+};
+
+/**
+ * @brief 动画插值函数集合 (Penner easing, 与tween.js的公式一致)
+ *
+ * 多项式类的插值函数为constexpr, 可以通过ease(type, k)按枚举分发,
+ * 或者通过ease<type>(k)在编译期确定, 两种方式都可以被编译器内联, 不需要std::function
+ */
+class Easing
+{
+public:
+    static constexpr double linearNone(double k) { return k; }
+
+    static constexpr double quadraticIn(double k) { return k * k; }
+    static constexpr double quadraticOut(double k) { return k * (2.0 - k); }
+    static constexpr double quadraticInOut(double k)
+    {
+        k *= 2.0;
+        if (k < 1.0)
+            return 0.5 * k * k;
+        k -= 1.0;
+        return -0.5 * (k * (k - 2.0) - 1.0);
+    }
+
+    static constexpr double cubicIn(double k) { return k * k * k; }
+    static constexpr double cubicOut(double k)
+    {
+        k -= 1.0;
+        return k * k * k + 1.0;
+    }
+    static constexpr double cubicInOut(double k)
+    {
+        k *= 2.0;
+        if (k < 1.0)
+            return 0.5 * k * k * k;
+        k -= 2.0;
+        return 0.5 * (k * k * k + 2.0);
+    }
+
+    static constexpr double quarticIn(double k) { return k * k * k * k; }
+    static constexpr double quarticOut(double k)
+    {
+        k -= 1.0;
+        return 1.0 - k * k * k * k;
+    }
+    static constexpr double quarticInOut(double k)
+    {
+        k *= 2.0;
+        if (k < 1.0)
+            return 0.5 * k * k * k * k;
+        k -= 2.0;
+        return -0.5 * (k * k * k * k - 2.0);
+    }
+
+    static constexpr double quinticIn(double k) { return k * k * k * k * k; }
+    static constexpr double quinticOut(double k)
+    {
+        k -= 1.0;
+        return k * k * k * k * k + 1.0;
+    }
+    static constexpr double quinticInOut(double k)
+    {
+        k *= 2.0;
+        if (k < 1.0)
+            return 0.5 * k * k * k * k * k;
+        k -= 2.0;
+        return 0.5 * (k * k * k * k * k + 2.0);
+    }
+
+    static inline double sinusoidalIn(double k) { return 1.0 - cos(k * M_PI_2); }
+    static inline double sinusoidalOut(double k) { return sin(k * M_PI_2); }
+    static inline double sinusoidalInOut(double k) { return 0.5 * (1.0 - cos(M_PI * k)); }
+
+    static inline double exponentialIn(double k) { return k == 0.0 ? 0.0 : pow(1024.0, k - 1.0); }
+    static inline double exponentialOut(double k) { return k == 1.0 ? 1.0 : 1.0 - pow(2.0, -10.0 * k); }
+    static inline double exponentialInOut(double k)
+    {
+        if (k == 0.0)
+            return 0.0;
+        if (k == 1.0)
+            return 1.0;
+        k *= 2.0;
+        if (k < 1.0)
+            return 0.5 * pow(1024.0, k - 1.0);
+        return 0.5 * (-pow(2.0, -10.0 * (k - 1.0)) + 2.0);
+    }
+
+    static inline double circularIn(double k) { return 1.0 - sqrt(1.0 - k * k); }
+    static inline double circularOut(double k)
+    {
+        k -= 1.0;
+        return sqrt(1.0 - k * k);
+    }
+    static inline double circularInOut(double k)
+    {
+        k *= 2.0;
+        if (k < 1.0)
+            return -0.5 * (sqrt(1.0 - k * k) - 1.0);
+        k -= 2.0;
+        return 0.5 * (sqrt(1.0 - k * k) + 1.0);
+    }
+
+    static inline double elasticIn(double k)
+    {
+        if (k == 0.0)
+            return 0.0;
+        if (k == 1.0)
+            return 1.0;
+        return -pow(2.0, 10.0 * (k - 1.0)) * sin((k - 1.1) * 5.0 * M_PI);
+    }
+    static inline double elasticOut(double k)
+    {
+        if (k == 0.0)
+            return 0.0;
+        if (k == 1.0)
+            return 1.0;
+        return pow(2.0, -10.0 * k) * sin((k - 0.1) * 5.0 * M_PI) + 1.0;
+    }
+    static inline double elasticInOut(double k)
+    {
+        if (k == 0.0)
+            return 0.0;
+        if (k == 1.0)
+            return 1.0;
+        k *= 2.0;
+        if (k < 1.0)
+            return -0.5 * pow(2.0, 10.0 * (k - 1.0)) * sin((k - 1.1) * 5.0 * M_PI);
+        return 0.5 * pow(2.0, -10.0 * (k - 1.0)) * sin((k - 1.1) * 5.0 * M_PI) + 1.0;
+    }
+
+    static constexpr double backIn(double k)
+    {
+        const double s = 1.70158;
+        return k * k * ((s + 1.0) * k - s);
+    }
+    static constexpr double backOut(double k)
+    {
+        const double s = 1.70158;
+        k -= 1.0;
+        return k * k * ((s + 1.0) * k + s) + 1.0;
+    }
+    static constexpr double backInOut(double k)
+    {
+        const double s = 1.70158 * 1.525;
+        k *= 2.0;
+        if (k < 1.0)
+            return 0.5 * (k * k * ((s + 1.0) * k - s));
+        k -= 2.0;
+        return 0.5 * (k * k * ((s + 1.0) * k + s) + 2.0);
+    }
+
+    static constexpr double bounceOut(double k)
+    {
+        if (k < (1.0 / 2.75))
+            return 7.5625 * k * k;
+        if (k < (2.0 / 2.75)) {
+            k -= (1.5 / 2.75);
+            return 7.5625 * k * k + 0.75;
+        }
+        if (k < (2.5 / 2.75)) {
+            k -= (2.25 / 2.75);
+            return 7.5625 * k * k + 0.9375;
+        }
+        k -= (2.625 / 2.75);
+        return 7.5625 * k * k + 0.984375;
+    }
+    static constexpr double bounceIn(double k) { return 1.0 - bounceOut(1.0 - k); }
+    static constexpr double bounceInOut(double k)
+    {
+        if (k < 0.5)
+            return bounceIn(k * 2.0) * 0.5;
+        return bounceOut(k * 2.0 - 1.0) * 0.5 + 0.5;
+    }
+
+    /**
+     * @brief 按类型计算插值 (编译期确定类型)
+     *
+     * @param k 插值参数, 范围[0, 1]
+     * @return double 插值的结果
+     */
+    template <EasingType::Type T>
+    static inline double ease(double k) { return ease(T, k); }
+
+    /**
+     * @brief 按类型计算插值 (运行期分发)
+     *
+     * @param type 插值函数类型
+     * @param k 插值参数, 范围[0, 1]
+     * @return double 插值的结果
+     */
+    static inline double ease(EasingType::Type type, double k)
+    {
+        switch (type) {
+        case EasingType::LinearNone: return linearNone(k);
+        case EasingType::QuadraticIn: return quadraticIn(k);
+        case EasingType::QuadraticOut: return quadraticOut(k);
+        case EasingType::QuadraticInOut: return quadraticInOut(k);
+        case EasingType::CubicIn: return cubicIn(k);
+        case EasingType::CubicOut: return cubicOut(k);
+        case EasingType::CubicInOut: return cubicInOut(k);
+        case EasingType::QuarticIn: return quarticIn(k);
+        case EasingType::QuarticOut: return quarticOut(k);
+        case EasingType::QuarticInOut: return quarticInOut(k);
+        case EasingType::QuinticIn: return quinticIn(k);
+        case EasingType::QuinticOut: return quinticOut(k);
+        case EasingType::QuinticInOut: return quinticInOut(k);
+        case EasingType::SinusoidalIn: return sinusoidalIn(k);
+        case EasingType::SinusoidalOut: return sinusoidalOut(k);
+        case EasingType::SinusoidalInOut: return sinusoidalInOut(k);
+        case EasingType::ExponentialIn: return exponentialIn(k);
+        case EasingType::ExponentialOut: return exponentialOut(k);
+        case EasingType::ExponentialInOut: return exponentialInOut(k);
+        case EasingType::CircularIn: return circularIn(k);
+        case EasingType::CircularOut: return circularOut(k);
+        case EasingType::CircularInOut: return circularInOut(k);
+        case EasingType::ElasticIn: return elasticIn(k);
+        case EasingType::ElasticOut: return elasticOut(k);
+        case EasingType::ElasticInOut: return elasticInOut(k);
+        case EasingType::BackIn: return backIn(k);
+        case EasingType::BackOut: return backOut(k);
+        case EasingType::BackInOut: return backInOut(k);
+        case EasingType::BounceIn: return bounceIn(k);
+        case EasingType::BounceOut: return bounceOut(k);
+        case EasingType::BounceInOut: return bounceInOut(k);
+        default: return k;
+        }
+    }
+};
+
+#endif // EASING_H
@@ -0,0 +1,174 @@
+#include "ellipsoidaloccluder.h"
+#include "ellipsoid.h"
+
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#include <immintrin.h>
+#define ELLIPSOIDALOCCLUDER_AVX2
+#endif
+
+EllipsoidalOccluder::EllipsoidalOccluder()
+{
+}
+
+EllipsoidalOccluder::EllipsoidalOccluder(Ellipsoid *ellipsoid, const Cartesian3 &cameraPosition)
+    : _ellipsoid(ellipsoid)
+    , _cameraPosition(cameraPosition)
+{
+    if (!ellipsoid) {
+        return;
+    }
+
+    _scale = ellipsoid->oneOverRadii();
+    _radiusScale = qMax(_scale.x, qMax(_scale.y, _scale.z));
+
+    _cameraPositionInScaledSpace = Cartesian3(cameraPosition.x * _scale.x, cameraPosition.y * _scale.y, cameraPosition.z * _scale.z);
+    _cameraMagnitude = _cameraPositionInScaledSpace.magnitude();
+    _horizonMagnitudeSquared = _cameraMagnitude * _cameraMagnitude - 1.0;
+    _horizonMagnitude = _horizonMagnitudeSquared > 0.0 ? sqrt(_horizonMagnitudeSquared) : 0.0;
+}
+
+bool EllipsoidalOccluder::isPointVisible(const Cartesian3 &position) const
+{
+    // 相机在椭球内部 (地下模式) 时不做遮挡
+    if (!(_horizonMagnitudeSquared > 0.0)) {
+        return true;
+    }
+
+    const Cartesian3 &cv = _cameraPositionInScaledSpace;
+    double vtX = position.x * _scale.x - cv.x;
+    double vtY = position.y * _scale.y - cv.y;
+    double vtZ = position.z * _scale.z - cv.z;
+
+    // vt在圆锥轴 (-cv) 上的投影乘以|cv|
+    double vtDotVc = -(vtX * cv.x + vtY * cv.y + vtZ * cv.z);
+    double vtMagnitudeSquared = vtX * vtX + vtY * vtY + vtZ * vtZ;
+
+    bool occluded = vtDotVc > _horizonMagnitudeSquared &&
+            vtDotVc * vtDotVc > _horizonMagnitudeSquared * vtMagnitudeSquared;
+    return !occluded;
+}
+
+bool EllipsoidalOccluder::isBoundingSphereVisible(const Cartesian3 &center, double radius) const
+{
+    if (!(_horizonMagnitudeSquared > 0.0)) {
+        return true;
+    }
+
+    const Cartesian3 &cv = _cameraPositionInScaledSpace;
+    double vtX = center.x * _scale.x - cv.x;
+    double vtY = center.y * _scale.y - cv.y;
+    double vtZ = center.z * _scale.z - cv.z;
+    double r = radius * _radiusScale;
+
+    double vtDotVc = -(vtX * cv.x + vtY * cv.y + vtZ * cv.z);
+    double vtMagnitudeSquared = vtX * vtX + vtY * vtY + vtZ * vtZ;
+
+    // 整个球都在地平线平面之后
+    if (!(vtDotVc > _horizonMagnitudeSquared + r * _cameraMagnitude)) {
+        return true;
+    }
+
+    // 整个球都在圆锥内: 球心与轴的夹角加上球的半角不超过圆锥的半角, 两边同乘 |vt|^2 * |cv|
+    double sine = sqrt(qMax(vtMagnitudeSquared * _cameraMagnitude * _cameraMagnitude - vtDotVc * vtDotVc, 0.0));
+    double cosine = sqrt(qMax(vtMagnitudeSquared - r * r, 0.0));
+    bool occluded = vtDotVc * cosine - r * sine > vtMagnitudeSquared * _horizonMagnitude;
+    return !occluded;
+}
+
+void EllipsoidalOccluder::isPointVisible(const double *x, const double *y, const double *z, quint8 *visible, int count) const
+{
+    if (!(_horizonMagnitudeSquared > 0.0)) {
+        for (int i = 0; i < count; ++i) {
+            visible[i] = 1;
+        }
+        return;
+    }
+
+    int i = 0;
+
+#ifdef ELLIPSOIDALOCCLUDER_AVX2
+    const __m256d scaleX = _mm256_set1_pd(_scale.x);
+    const __m256d scaleY = _mm256_set1_pd(_scale.y);
+    const __m256d scaleZ = _mm256_set1_pd(_scale.z);
+    const __m256d cvX = _mm256_set1_pd(_cameraPositionInScaledSpace.x);
+    const __m256d cvY = _mm256_set1_pd(_cameraPositionInScaledSpace.y);
+    const __m256d cvZ = _mm256_set1_pd(_cameraPositionInScaledSpace.z);
+    const __m256d horizon = _mm256_set1_pd(_horizonMagnitudeSquared);
+
+    for (; i + 4 <= count; i += 4) {
+        __m256d vtX = _mm256_fmsub_pd(_mm256_loadu_pd(x + i), scaleX, cvX);
+        __m256d vtY = _mm256_fmsub_pd(_mm256_loadu_pd(y + i), scaleY, cvY);
+        __m256d vtZ = _mm256_fmsub_pd(_mm256_loadu_pd(z + i), scaleZ, cvZ);
+
+        // -dot(vt, cv)
+        __m256d vtDotVc = _mm256_fnmadd_pd(vtZ, cvZ, _mm256_fnmadd_pd(vtY, cvY, _mm256_mul_pd(_mm256_sub_pd(_mm256_setzero_pd(), vtX), cvX)));
+        __m256d vtMagnitudeSquared = _mm256_fmadd_pd(vtZ, vtZ, _mm256_fmadd_pd(vtY, vtY, _mm256_mul_pd(vtX, vtX)));
+
+        __m256d occluded = _mm256_and_pd(_mm256_cmp_pd(vtDotVc, horizon, _CMP_GT_OQ),
+                                         _mm256_cmp_pd(_mm256_mul_pd(vtDotVc, vtDotVc), _mm256_mul_pd(horizon, vtMagnitudeSquared), _CMP_GT_OQ));
+
+        int mask = _mm256_movemask_pd(occluded);
+        for (int k = 0; k < 4; ++k) {
+            visible[i + k] = (mask >> k) & 1 ? 0 : 1;
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        visible[i] = isPointVisible(Cartesian3(x[i], y[i], z[i])) ? 1 : 0;
+    }
+}
+
+void EllipsoidalOccluder::isBoundingSphereVisible(const double *x, const double *y, const double *z, const double *radius,
+                                                  quint8 *visible, int count) const
+{
+    if (!(_horizonMagnitudeSquared > 0.0)) {
+        for (int i = 0; i < count; ++i) {
+            visible[i] = 1;
+        }
+        return;
+    }
+
+    int i = 0;
+
+#ifdef ELLIPSOIDALOCCLUDER_AVX2
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d scaleX = _mm256_set1_pd(_scale.x);
+    const __m256d scaleY = _mm256_set1_pd(_scale.y);
+    const __m256d scaleZ = _mm256_set1_pd(_scale.z);
+    const __m256d radiusScale = _mm256_set1_pd(_radiusScale);
+    const __m256d cvX = _mm256_set1_pd(_cameraPositionInScaledSpace.x);
+    const __m256d cvY = _mm256_set1_pd(_cameraPositionInScaledSpace.y);
+    const __m256d cvZ = _mm256_set1_pd(_cameraPositionInScaledSpace.z);
+    const __m256d cameraMagnitude = _mm256_set1_pd(_cameraMagnitude);
+    const __m256d cameraMagnitudeSquared = _mm256_set1_pd(_cameraMagnitude * _cameraMagnitude);
+    const __m256d horizonSquared = _mm256_set1_pd(_horizonMagnitudeSquared);
+    const __m256d horizon = _mm256_set1_pd(_horizonMagnitude);
+
+    for (; i + 4 <= count; i += 4) {
+        __m256d vtX = _mm256_fmsub_pd(_mm256_loadu_pd(x + i), scaleX, cvX);
+        __m256d vtY = _mm256_fmsub_pd(_mm256_loadu_pd(y + i), scaleY, cvY);
+        __m256d vtZ = _mm256_fmsub_pd(_mm256_loadu_pd(z + i), scaleZ, cvZ);
+        __m256d r = _mm256_mul_pd(_mm256_loadu_pd(radius + i), radiusScale);
+
+        __m256d vtDotVc = _mm256_fnmadd_pd(vtZ, cvZ, _mm256_fnmadd_pd(vtY, cvY, _mm256_mul_pd(_mm256_sub_pd(zero, vtX), cvX)));
+        __m256d vtMagnitudeSquared = _mm256_fmadd_pd(vtZ, vtZ, _mm256_fmadd_pd(vtY, vtY, _mm256_mul_pd(vtX, vtX)));
+
+        __m256d behindHorizon = _mm256_cmp_pd(vtDotVc, _mm256_fmadd_pd(r, cameraMagnitude, horizonSquared), _CMP_GT_OQ);
+
+        __m256d sine = _mm256_sqrt_pd(_mm256_max_pd(_mm256_fmsub_pd(vtMagnitudeSquared, cameraMagnitudeSquared, _mm256_mul_pd(vtDotVc, vtDotVc)), zero));
+        __m256d cosine = _mm256_sqrt_pd(_mm256_max_pd(_mm256_fnmadd_pd(r, r, vtMagnitudeSquared), zero));
+        __m256d insideCone = _mm256_cmp_pd(_mm256_fmsub_pd(vtDotVc, cosine, _mm256_mul_pd(r, sine)),
+                                           _mm256_mul_pd(vtMagnitudeSquared, horizon), _CMP_GT_OQ);
+
+        int mask = _mm256_movemask_pd(_mm256_and_pd(behindHorizon, insideCone));
+        for (int k = 0; k < 4; ++k) {
+            visible[i + k] = (mask >> k) & 1 ? 0 : 1;
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        visible[i] = isBoundingSphereVisible(Cartesian3(x[i], y[i], z[i]), radius[i]) ? 1 : 0;
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef ELLIPSOIDALOCCLUDER_H
+#define ELLIPSOIDALOCCLUDER_H
+
+#include "sscc_global.h"
+#include "cartesian3.h"
+
+class Ellipsoid;
+
+/**
+ * @brief 椭球的地平线遮挡测试, 判断点或包围球是否被椭球挡住 (在地平线之后)
+ *
+ * 在缩放空间 (坐标乘以1 / radii, 椭球变成单位球) 中计算: 被遮挡的区域是从相机出发与单位球相切的圆锥内,
+ * 且在地平线平面之后的部分. 批量测试使用SoA数组, 编译时开启AVX2和FMA时每次处理4个对象
+ */
+class CONTROLLER_EXPORT EllipsoidalOccluder
+{
+public:
+    /**
+     * @brief 默认构造 (没有椭球, 所有对象都可见)
+     *
+     */
+    EllipsoidalOccluder();
+
+    /**
+     * @brief 构造
+     *
+     * @param ellipsoid 椭球
+     * @param cameraPosition 相机的世界坐标
+     */
+    EllipsoidalOccluder(Ellipsoid *ellipsoid, const Cartesian3 &cameraPosition);
+
+    /**
+     * @brief 测试一个点是否可见
+     *
+     * @param position 世界坐标
+     * @return bool true: 可见, false: 被椭球遮挡
+     */
+    bool isPointVisible(const Cartesian3 &position) const;
+
+    /**
+     * @brief 测试一个包围球是否可见 (保守测试, 只有整个包围球都被遮挡时才返回false)
+     *
+     * @param center 球心 (世界坐标)
+     * @param radius 半径
+     * @return bool true: 可见或部分可见, false: 被椭球遮挡
+     */
+    bool isBoundingSphereVisible(const Cartesian3 &center, double radius) const;
+
+    /**
+     * @brief 批量测试点 (SoA数组)
+     *
+     * @param x 世界坐标的x数组
+     * @param y 世界坐标的y数组
+     * @param z 世界坐标的z数组
+     * @param visible 每个点的结果, 1: 可见, 0: 被遮挡
+     * @param count 点的数量
+     */
+    void isPointVisible(const double *x, const double *y, const double *z, quint8 *visible, int count) const;
+
+    /**
+     * @brief 批量测试包围球 (SoA数组)
+     *
+     * @param x 球心的x数组
+     * @param y 球心的y数组
+     * @param z 球心的z数组
+     * @param radius 半径数组
+     * @param visible 每个包围球的结果, 1: 可见或部分可见, 0: 被遮挡
+     * @param count 包围球的数量
+     */
+    void isBoundingSphereVisible(const double *x, const double *y, const double *z, const double *radius,
+                                 quint8 *visible, int count) const;
+
+    Ellipsoid *ellipsoid() const { return _ellipsoid; }
+    Cartesian3 cameraPosition() const { return _cameraPosition; }
+
+private:
+    Ellipsoid *_ellipsoid = nullptr;
+    Cartesian3 _cameraPosition;
+
+    Cartesian3 _scale; ///< 1 / radii
+    double _radiusScale = 0.0; ///< 半径缩放到缩放空间的系数 (取最大值, 保证缩放后的球包住原来的包围球)
+    Cartesian3 _cameraPositionInScaledSpace; ///< 缩放空间中的相机位置 cv
+    double _cameraMagnitude = 0.0; ///< |cv|
+    double _horizonMagnitudeSquared = -1.0; ///< |cv|^2 - 1, 相机到地平线距离的平方, 小于0时相机在椭球内部
+    double _horizonMagnitude = 0.0; ///< sqrt(|cv|^2 - 1)
+};
+
+#endif // ELLIPSOIDALOCCLUDER_H
@@ -5,6 +5,7 @@
 #include "quarticrealpolynomial.h"
 #include "plane.h"
 #include "ellipsoid.h"
+#include "sphere.h"
 
 IntersectionTests::IntersectionTests()
 {
@@ -70,6 +71,45 @@ Interval IntersectionTests::rayEllipsoid(const Ray &ray, Ellipsoid *ellipsoid)
         return Interval(Math::EPSILON20, 0);
 }
 
+Interval IntersectionTests::raySphere(const Ray &ray, const Sphere &sphere)
+{
+    Cartesian3 q = ray.origin;
+    Cartesian3 w = ray.direction;
+
+    double q2 = q.magnitudeSquared();
+    double qw = Cartesian3::dot(q, w);
+    double w2 = w.magnitudeSquared();
+    double difference = q2 - sphere.radiusSquared();
+
+    if (difference > 0.0) {
+        // Outside sphere.
+        if (qw >= 0.0) {
+            return Interval(Math::EPSILON20, 0);
+        }
+
+        double product = w2 * difference;
+        double discriminant = qw * qw - product;
+        if (discriminant < 0.0) {
+            return Interval(Math::EPSILON20, 0);
+        }
+
+        double temp = -qw + sqrt(discriminant); // Avoid cancellation.
+        double root0 = temp / w2;
+        double root1 = difference / temp;
+        return root0 < root1 ? Interval(root0, root1) : Interval(root1, root0);
+    } else if (difference < 0.0) {
+        // Inside sphere.
+        double temp = -qw + sqrt(qw * qw - w2 * difference);
+        return Interval(0.0, temp / w2);
+    }
+
+    // On sphere.
+    if (qw < 0.0) {
+        return Interval(0.0, -qw / w2);
+    }
+    return Interval(Math::EPSILON20, 0);
+}
+
 Cartesian3 IntersectionTests::rayPlane(const Ray &ray, Plane *plane)
 {
     Cartesian3 origin = ray.origin;
@@ -95,6 +135,132 @@ Cartesian3 IntersectionTests::rayPlane(const Ray &ray, Plane *plane)
 }
 
 Cartesian3 IntersectionTests::grazingAltitudeLocation(const Ray &ray, Ellipsoid *ellipsoid)
+{
+    const int maximumIterations = 8;
+    const int maximumExpansions = 4;
+
+    // The closed-form start and the geodetic slope below assume a rotational ellipsoid.
+    Cartesian3 radii = ellipsoid->radii();
+    if (radii.x != radii.y) {
+        return grazingAltitudeLocationGeneral(ray, ellipsoid);
+    }
+
+    Cartesian3 position = ray.origin;
+    Cartesian3 direction = ray.direction;
+
+    if (!position.isNull()) {
+        Cartesian3 normal = ellipsoid->geodeticSurfaceNormal(position);
+        if (Cartesian3::dot(direction, normal) >= 0.0) { // The location provided is the closest point in altitude
+            return position;
+        }
+    }
+
+    // In scaled space the ellipsoid is the unit sphere, the closest approach of the ray to it is where
+    // the direction is perpendicular to the scaled surface normal.
+    Cartesian3 q = ellipsoid->transformPositionToScaledSpace(position);
+    Cartesian3 w = ellipsoid->transformPositionToScaledSpace(direction);
+    double w2 = w.magnitudeSquared();
+    if (w2 == 0.0) {
+        return position;
+    }
+
+    double t0 = -Cartesian3::dot(q, w) / w2;
+    if (t0 <= 0.0) {
+        return position;
+    }
+
+    // The minimum geodetic altitude is where the direction is perpendicular to the geodetic normal instead.
+    // The two only differ by the flattening, so bracket the root next to t0 and refine it with the Illinois
+    // variant of regula falsi for a fixed number of iterations.
+    double a = radii.x;
+    double b = radii.z;
+
+    double g0 = grazingSlope(position, direction, t0, a, b);
+    if (g0 == 0.0) {
+        return direction * t0 + position;
+    }
+
+    double step = t0 * 0.01;
+    double lo = t0;
+    double hi = t0;
+    double gLo = g0;
+    double gHi = g0;
+    bool bracketed = false;
+    for (int i = 0; i < maximumExpansions && !bracketed; ++i, step *= 4.0) {
+        if (g0 < 0.0) {
+            // still descending at t0, the root lies further along the ray
+            hi = t0 + step;
+            gHi = grazingSlope(position, direction, hi, a, b);
+            bracketed = gHi >= 0.0;
+        } else {
+            lo = std::max(t0 - step, 0.0);
+            gLo = grazingSlope(position, direction, lo, a, b);
+            bracketed = gLo <= 0.0;
+        }
+    }
+
+    if (!bracketed) {
+        return direction * t0 + position;
+    }
+
+    double t = t0;
+    int side = 0;
+    for (int i = 0; i < maximumIterations; ++i) {
+        t = (lo * gHi - hi * gLo) / (gHi - gLo);
+        double g = grazingSlope(position, direction, t, a, b);
+        if (g == 0.0 || hi - lo <= Math::EPSILON12 * t) {
+            break;
+        }
+
+        if (g < 0.0) {
+            lo = t;
+            gLo = g;
+            if (side == -1) {
+                gHi *= 0.5;
+            }
+            side = -1;
+        } else {
+            hi = t;
+            gHi = g;
+            if (side == 1) {
+                gLo *= 0.5;
+            }
+            side = 1;
+        }
+    }
+
+    return direction * t + position;
+}
+
+double IntersectionTests::grazingSlope(const Cartesian3 &position, const Cartesian3 &direction, double t, double a, double b)
+{
+    // Rate of change of the geodetic altitude along the ray: the direction projected onto the geodetic normal.
+    // The normal comes from Bowring's latitude formula, which is accurate to well below a millimetre near the Earth.
+    Cartesian3 point = direction * t + position;
+    double p = sqrt(point.x * point.x + point.y * point.y);
+    if (p < Math::EPSILON12 * a) {
+        return point.z >= 0.0 ? direction.z : -direction.z;
+    }
+
+    double e2 = 1.0 - (b * b) / (a * a);
+    double ep2 = (a * a) / (b * b) - 1.0;
+
+    double sinBeta = point.z * a;
+    double cosBeta = p * b;
+    double length = sqrt(sinBeta * sinBeta + cosBeta * cosBeta);
+    sinBeta /= length;
+    cosBeta /= length;
+
+    double sinLatitude = point.z + ep2 * b * sinBeta * sinBeta * sinBeta;
+    double cosLatitude = p - e2 * a * cosBeta * cosBeta * cosBeta;
+    length = sqrt(sinLatitude * sinLatitude + cosLatitude * cosLatitude);
+    sinLatitude /= length;
+    cosLatitude /= length;
+
+    return cosLatitude * (direction.x * point.x + direction.y * point.y) / p + sinLatitude * direction.z;
+}
+
+Cartesian3 IntersectionTests::grazingAltitudeLocationGeneral(const Ray &ray, Ellipsoid *ellipsoid)
 {
     Cartesian3 position = ray.origin;
     Cartesian3 direction = ray.direction;
@@ -7,6 +7,7 @@
 
 class Plane;
 class Ellipsoid;
+class Sphere;
 
 /**
  * @brief 用于计算射, 平面, 三角形和椭圆体等几何体之间的交点的函数
@@ -26,6 +27,26 @@ public:
      */
     static Interval rayEllipsoid(const Ray &ray, Ellipsoid *ellipsoid);
 
+    /**
+     * @brief 计算射线与球的交点 (静态函数, 闭式解)
+     *
+     * 结果与半径相同的Ellipsoid调用rayEllipsoid一致: 射线起点在球外时返回两个交点, 在球内时返回(0, 出射点)
+     *
+     * @param ray 射线
+     * @param sphere 球
+     * @return Interval 交点
+     */
+    static Interval raySphere(const Ray &ray, const Sphere &sphere);
+
+    /**
+     * @brief 计算射线与球的交点 (静态函数), 与raySphere相同, 使模板代码可以用同一个名字在编译时选择球的路径
+     *
+     * @param ray 射线
+     * @param sphere 球
+     * @return Interval 交点
+     */
+    static Interval rayEllipsoid(const Ray &ray, const Sphere &sphere) { return raySphere(ray, sphere); }
+
     /**
      * @brief 计算射线与平面的交点 (静态函数)
      *
@@ -38,13 +59,28 @@ public:
     /**
      * @brief 提供沿射线最靠近椭球的点 (静态函数)
      *
+     * 先在缩放空间(椭球变为单位球)中直接求出射线的最近点, 再用固定次数的regula falsi迭代修正到大地高最小的点,
+     * 不分配内存, 适用于每一帧调用
+     *
+     * @param ray 射线
+     * @param ellipsoid 椭球, 不是旋转椭球 (radii.x != radii.y) 时使用grazingAltitudeLocationGeneral
+     * @return Cartesian3 射线上大地高最小的点; 射线远离椭球时返回射线的起点
+     */
+    static Cartesian3 grazingAltitudeLocation(const Ray &ray, Ellipsoid *ellipsoid);
+
+    /**
+     * @brief 提供沿射线最靠近椭球的点 (静态函数, 通用算法)
+     *
+     * 构造旋转矩阵并求解四次方程, 适用于任意三轴椭球, 开销较大
+     *
      * @param ray 射线
      * @param ellipsoid 椭球
      * @return Cartesian3 返回Cartesian3类型
      */
-    static Cartesian3 grazingAltitudeLocation(const Ray &ray, Ellipsoid *ellipsoid);
+    static Cartesian3 grazingAltitudeLocationGeneral(const Ray &ray, Ellipsoid *ellipsoid);
 
 private:
+    static double grazingSlope(const Cartesian3 &position, const Cartesian3 &direction, double t, double a, double b);
     static QVector<Vector3> quadraticVectorExpression(const Matrix3 &matrix,
                                           const Cartesian3 &cartesian,
                                           double c,
@@ -0,0 +1,182 @@
+#include "rtcellipsoidpicker.h"
+#include "intersectiontests.h"
+#include "ellipsoid.h"
+#include <cfloat>
+
+RtcEllipsoidPicker::RtcEllipsoidPicker()
+{
+}
+
+void RtcEllipsoidPicker::setFrame(const Cartesian3 &position, const Cartesian3 &direction, const Cartesian3 &up, const Cartesian3 &right,
+                                  double fovy, double aspectRatio, int width, int height)
+{
+    _position = position;
+    _direction = direction;
+    _up = up;
+    _right = right;
+    _tanPhi = tan(Math::toRadians(fovy) * 0.5);
+    _tanTheta = aspectRatio * _tanPhi;
+    _width = qMax(width, 1);
+    _height = qMax(height, 1);
+}
+
+void RtcEllipsoidPicker::setEllipsoid(Ellipsoid *ellipsoid)
+{
+    _ellipsoid = ellipsoid;
+}
+
+void RtcEllipsoidPicker::setTolerance(double tolerance)
+{
+    _tolerance = tolerance;
+}
+
+double RtcEllipsoidPicker::tolerance() const
+{
+    return _tolerance;
+}
+
+Ray RtcEllipsoidPicker::pickRay(double wx, double wy) const
+{
+    Ray ray;
+
+    double x = (2.0 / _width) * wx - 1.0;
+    double y = (2.0 / _height) * (_height - wy) - 1.0;
+
+    ray.origin = _position;
+    ray.direction = _direction + _right * (x * _tanTheta);
+    ray.direction += _up * (y * _tanPhi);
+    ray.direction.normalize();
+
+    return ray;
+}
+
+void RtcEllipsoidPicker::pick(const QVector<Cartesian2> &windowPositions, QVector<Cartesian3> &results)
+{
+    int count = windowPositions.size();
+    results.resize(count);
+    _fallbackCount = 0;
+    _missCount = 0;
+
+    Cartesian3 inverseRadii = _ellipsoid->oneOverRadii();
+    Cartesian3 radii = _ellipsoid->radii();
+
+    // 缩放空间中相机的位置, 只在double中计算一次
+    Cartesian3 q = inverseRadii * _position;
+    double difference = q.magnitudeSquared() - 1.0;
+    if (difference <= 0.0) {
+        // 相机在椭球内或椭球上, q2 - 1在float中没有有效数字
+        pickDouble(windowPositions, results);
+        _fallbackCount = count;
+        for (const Cartesian3 &result : results) {
+            if (!defined(result)) {
+                ++_missCount;
+            }
+        }
+        return;
+    }
+
+    // 射线方向 = D + x * R + y * U (缩放空间, 不归一化, 交点 = t * 方向)
+    const float dx = float(_direction.x * inverseRadii.x);
+    const float dy = float(_direction.y * inverseRadii.y);
+    const float dz = float(_direction.z * inverseRadii.z);
+    const float rx = float(_right.x * _tanTheta * inverseRadii.x);
+    const float ry = float(_right.y * _tanTheta * inverseRadii.y);
+    const float rz = float(_right.z * _tanTheta * inverseRadii.z);
+    const float ux = float(_up.x * _tanPhi * inverseRadii.x);
+    const float uy = float(_up.y * _tanPhi * inverseRadii.y);
+    const float uz = float(_up.z * _tanPhi * inverseRadii.z);
+    // q与射线方向几乎垂直时点积会相消, 所以q·D, q·R, q·U在double中计算
+    const float qd = float(q.x * dx + q.y * dy + q.z * dz);
+    const float qr = float(q.x * rx + q.y * ry + q.z * rz);
+    const float qu = float(q.x * ux + q.y * uy + q.z * uz);
+    const float diff = float(difference);
+    const float scaleX = 2.0f / _width;
+    const float scaleY = 2.0f / _height;
+    const float height = float(_height);
+
+    // 相对误差FLT_EPSILON * (4 + condition)不能超过tolerance个像素对应的角度
+    const double pixelAngle = 2.0 * _tanPhi / _height;
+    const float maximumCondition = float(_tolerance * pixelAngle / FLT_EPSILON - 4.0);
+
+    float t[BLOCK_SIZE];
+    float wx[BLOCK_SIZE];
+    float wy[BLOCK_SIZE];
+    float wz[BLOCK_SIZE];
+    float condition[BLOCK_SIZE];
+
+    for (int begin = 0; begin < count; begin += BLOCK_SIZE) {
+        const int size = qMin(int(BLOCK_SIZE), count - begin);
+        const Cartesian2 *positions = windowPositions.constData() + begin;
+
+        // 无分支, 便于编译器按float宽度向量化
+        for (int i = 0; i < size; ++i) {
+            float x = scaleX * float(positions[i].x) - 1.0f;
+            float y = scaleY * (height - float(positions[i].y)) - 1.0f;
+
+            float sx = dx + x * rx + y * ux;
+            float sy = dy + x * ry + y * uy;
+            float sz = dz + x * rz + y * uz;
+
+            float qw = qd + x * qr + y * qu;
+            float qwMagnitude = std::abs(qd) + std::abs(x * qr) + std::abs(y * qu);
+            float w2 = sx * sx + sy * sy + sz * sz;
+            float product = w2 * diff;
+            float discriminant = qw * qw - product;
+            float root = std::sqrt(std::max(discriminant, 0.0f));
+            float temp = root - qw; // Avoid cancellation.
+
+            // 取较近的交点 difference / temp; 没有交点时condition为负.
+            // t的相对误差约为FLT_EPSILON * (4 + condition): 前一项来自判别式的舍入, 后一项来自qw的舍入
+            t[i] = diff / temp;
+            condition[i] = (qw < 0.0f && discriminant >= 0.0f) ? (qw * qw + product) / (2.0f * root * temp) + 2.0f * qwMagnitude / root : -1.0f;
+            wx[i] = sx;
+            wy[i] = sy;
+            wz[i] = sz;
+        }
+
+        Cartesian3 *output = results.data() + begin;
+        for (int i = 0; i < size; ++i) {
+            if (condition[i] < 0.0f) {
+                output[i] = Cartesian3(Math::EPSILON20, 0, 0);
+                ++_missCount;
+            } else if (condition[i] > maximumCondition) {
+                // 接近相切, 回退到double
+                output[i] = pickOne(positions[i].x, positions[i].y);
+                ++_fallbackCount;
+            } else {
+                output[i] = Cartesian3(_position.x + double(t[i] * wx[i]) * radii.x,
+                                       _position.y + double(t[i] * wy[i]) * radii.y,
+                                       _position.z + double(t[i] * wz[i]) * radii.z);
+            }
+        }
+    }
+}
+
+void RtcEllipsoidPicker::pickDouble(const QVector<Cartesian2> &windowPositions, QVector<Cartesian3> &results) const
+{
+    results.resize(windowPositions.size());
+    for (int i = 0; i < windowPositions.size(); ++i) {
+        results[i] = pickOne(windowPositions[i].x, windowPositions[i].y);
+    }
+}
+
+int RtcEllipsoidPicker::fallbackCount() const
+{
+    return _fallbackCount;
+}
+
+int RtcEllipsoidPicker::missCount() const
+{
+    return _missCount;
+}
+
+Cartesian3 RtcEllipsoidPicker::pickOne(double wx, double wy) const
+{
+    Ray ray = pickRay(wx, wy);
+    Interval intersection = IntersectionTests::rayEllipsoid(ray, _ellipsoid);
+    if (!defined(intersection)) {
+        return Cartesian3(Math::EPSILON20, 0, 0);
+    }
+    double t = intersection.start > 0.0 ? intersection.start : intersection.stop;
+    return ray.getPoint(t);
+}
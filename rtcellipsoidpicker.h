@@ -0,0 +1,125 @@
+#ifndef RTCELLIPSOIDPICKER_H
+#define RTCELLIPSOIDPICKER_H
+
+#include "sscc_global.h"
+#include "cartesian3.h"
+#include "ray.h"
+#include "screenspaceeventutils.h"
+
+class Ellipsoid;
+
+/**
+ * @brief 批量在椭球上拾取 (以相机为中心的单精度模式)
+ *
+ * 射线与椭球都以相机位置为中心(RTC)表示: 射线起点为0, 与椭球有关的常量(缩放空间中的相机位置, q2 - 1)用double预先求出,
+ * 每条射线只需在float中求交, 循环可以按float的SIMD宽度向量化.
+ * 每条射线同时给出误差估计, 超过tolerance时改用与CameraController::getPickRayPerspective相同的double射线重新计算
+ */
+class CONTROLLER_EXPORT RtcEllipsoidPicker
+{
+public:
+    /**
+     * @brief 默认构造
+     *
+     */
+    RtcEllipsoidPicker();
+
+    /**
+     * @brief 设置相机 (世界坐标)
+     *
+     * @param position 相机位置
+     * @param direction 相机的y轴方向
+     * @param up 相机的z轴方向
+     * @param right 相机的x轴方向
+     * @param fovy 视角 (度)
+     * @param aspectRatio 宽高比
+     * @param width 窗口宽度 (像素)
+     * @param height 窗口高度 (像素)
+     */
+    void setFrame(const Cartesian3 &position, const Cartesian3 &direction, const Cartesian3 &up, const Cartesian3 &right,
+                  double fovy, double aspectRatio, int width, int height);
+
+    /**
+     * @brief 设置椭球
+     *
+     * @param ellipsoid 椭球
+     */
+    void setEllipsoid(Ellipsoid *ellipsoid);
+
+    /**
+     * @brief 设置允许的误差
+     *
+     * @param tolerance 允许的误差, 以交点处一个像素的大小为单位, 默认0.05
+     */
+    void setTolerance(double tolerance);
+
+    /**
+     * @brief 获取允许的误差
+     *
+     * @return double 允许的误差 (像素)
+     */
+    double tolerance() const;
+
+    /**
+     * @brief 从相机向一个屏幕点发射一条射线 (double), 与CameraController::getPickRayPerspective相同
+     *
+     * @param wx 屏幕坐标的x
+     * @param wy 屏幕坐标的y
+     * @return Ray 射线
+     */
+    Ray pickRay(double wx, double wy) const;
+
+    /**
+     * @brief 批量拾取 (单精度, 误差超过tolerance时回退到double)
+     *
+     * @param windowPositions 屏幕坐标
+     * @param results 拾取的结果 (世界坐标), 没有交点时为Cartesian3(Math::EPSILON20, 0, 0)
+     */
+    void pick(const QVector<Cartesian2> &windowPositions, QVector<Cartesian3> &results);
+
+    /**
+     * @brief 批量拾取 (double), 每个点的结果与CameraController::pickEllipsoid相同
+     *
+     * @param windowPositions 屏幕坐标
+     * @param results 拾取的结果 (世界坐标), 没有交点时为Cartesian3(Math::EPSILON20, 0, 0)
+     */
+    void pickDouble(const QVector<Cartesian2> &windowPositions, QVector<Cartesian3> &results) const;
+
+    /**
+     * @brief 上一次pick中回退到double的数量 (相机在椭球内时全部回退)
+     *
+     * @return int 回退数量
+     */
+    int fallbackCount() const;
+
+    /**
+     * @brief 上一次pick中没有交点的数量
+     *
+     * @return int 没有交点的数量
+     */
+    int missCount() const;
+
+private:
+    enum {
+        BLOCK_SIZE = 256
+    };
+
+    Cartesian3 pickOne(double wx, double wy) const;
+
+    Ellipsoid *_ellipsoid = nullptr;
+    double _tolerance = 0.05;
+
+    Cartesian3 _position;
+    Cartesian3 _direction;
+    Cartesian3 _up;
+    Cartesian3 _right;
+    double _tanPhi = 0.0;
+    double _tanTheta = 0.0;
+    int _width = 1;
+    int _height = 1;
+
+    int _fallbackCount = 0;
+    int _missCount = 0;
+};
+
+#endif // RTCELLIPSOIDPICKER_H
@@ -1,14 +1,8 @@
 #include "screenspacecameracontroller.h"
 #include "cameraeventaggregator.h"
 #include "liviewer.h"
-#include "liscene.h"
-#include "globe.h"
-#include "licamera.h"
-#include "liwidget.h"
 #include "cameracontroller.h"
 #include "tweencollection.h"
-#include "liinputsystem.h"
-#include "timestamp.h"
 #include "limath.h"
 #include "matrix4.h"
 #include "litransform.h"
@@ -18,27 +12,51 @@
 #include "cesiummath.h"
 #include "cesiumcartesian3.h"
 #include "liraycasthit.h"
-#include "quadtreeprimitive.h"
 #include "ellipsoid.h"
 
 ScreenSpaceCameraController::ScreenSpaceCameraController(LiNode *parent)
     : LiCameraController(parent)
-    , _scene(GlobalViewer()->scene())
-    , _ellipsoid(Ellipsoid::WGS84())
+    , _viewerEnvironment(new LiCameraEnvironment(GlobalViewer()))
 {
+    initialize(_viewerEnvironment->environment());
+}
+
+ScreenSpaceCameraController::ScreenSpaceCameraController(const CameraEnvironment &environment, LiNode *parent)
+    : LiCameraController(parent)
+{
+    initialize(environment);
+}
+
+void ScreenSpaceCameraController::initialize(const CameraEnvironment &environment)
+{
+    CameraEnvironment resolved = environment;
+    if (!resolved.ellipsoid) {
+        resolved.ellipsoid = Ellipsoid::WGS84();
+    }
+    if (!resolved.globe) {
+        _ellipsoidGlobe = new EllipsoidCameraGlobe(resolved.ellipsoid);
+        resolved.globe = _ellipsoidGlobe;
+    }
+
+    _globeEllipsoid = resolved.ellipsoid;
+    _ellipsoid = _globeEllipsoid;
     _sphereEllipsoid = new Ellipsoid(1.0, 1.0, 1.0);
 
     _tweens = new TweenCollection();
-    _canvas = _scene->canvas();
-    _globe = _scene->globe();
+    _canvas = resolved.canvas;
+    _globe = resolved.globe;
     m_globe = _globe;
-    _camera = _scene->mainCamera();
-    _cameraTrans = _camera->transform();
+    _camera = resolved.camera;
+    _input = resolved.input;
 
-    _aggregator = new CameraEventAggregator(_canvas, this);
-    _cameraController = new CameraController(_scene, _camera, _tweens);
+    _aggregator = new CameraEventAggregator(_canvas, _input ? _input->inputSystem() : nullptr, this);
+    _cameraController = new CameraController(resolved, _tweens, this);
+    _statePublisher = new CameraStatePublisher();
 
-    _input = _aggregator->inputSystem;
+    _aggregator->setClock(_clock);
+    _cameraController->setClock(_clock);
+
+    connect(_cameraController, &CameraController::fastMotionChanged, this, &ScreenSpaceCameraController::fastMotionChanged);
 
     translateEventTypes.append(EventType(CameraEventType::LEFT_DRAG, 0));
 
@@ -63,28 +81,241 @@ ScreenSpaceCameraController::~ScreenSpaceCameraController()
     delete _aggregator;
     delete _cameraController;
     delete _sphereEllipsoid;
+    delete _statePublisher;
+    delete _ellipsoidGlobe;
+    delete _viewerEnvironment;
 }
 
 void ScreenSpaceCameraController::update()
 {
-    _tweens->update();
+    // 每帧只读一次时钟, 动画, 惯性和键盘移动使用同一个时间戳
+    _frameTime = _clock->nanoseconds();
+
+    if (_syncRole != SyncNone && !_syncTransport) {
+        // transport已经被删除, 停止同步
+        _syncRole = SyncNone;
+    }
 
     if (_cameraController->_transform != Matrix4()) {
         _globe = nullptr;
         _ellipsoid = _sphereEllipsoid;
     } else {
-        _globe = _scene->globe();
-        _ellipsoid = Ellipsoid::WGS84();
+        _globe = m_globe;
+        _ellipsoid = _globeEllipsoid;
     }
 
     double radius = _ellipsoid->maximumRadius();
     _rotateFactor = 1.0 / radius;
     _rotateRateRangeAdjustment = radius;
 
-    update3D();
-    _aggregator->reset();
+    _collisionStartPosition = _cameraController->positionWC();
+
+    {
+        // 动画和手势在一帧内多次读写相机位姿, 放在一个事务中, 离开作用域时只写一次LiTransform
+        CameraTransaction transaction(_cameraController);
+
+        if (_syncRole == SyncFollower) {
+            // 跟随节点丢弃本节点的飞行, 输入和脚本操作, 只应用主控节点的位姿
+            _cameraController->cancelFlight();
+            {
+                QMutexLocker locker(&_commandMutex);
+                _pendingCommands.clear();
+            }
+            _aggregator->flushInputEvents();
+            _aggregator->reset();
+
+            applySyncPose();
+        } else {
+            _tweens->update(CameraClock::toMilliseconds(_frameTime));
+
+            applyPendingCommands();
+
+            _aggregator->flushInputEvents();
+            update3D();
+            _aggregator->reset();
+
+            handleKeyDown();
+
+            resolveCollision();
+        }
+    }
+
+    _cameraController->updateMotionMetrics(CameraClock::toMilliseconds(_frameTime));
+
+    publishCameraState();
+
+    if (_syncRole == SyncMaster) {
+        sendSyncPose();
+    }
+
+    raiseCameraEvents();
+}
+
+void ScreenSpaceCameraController::resolveCollision()
+{
+    const int refineIterations = 4;
+
+    Cartesian3 start = _collisionStartPosition;
+    _collisionStartPosition = Cartesian3(Math::EPSILON20, 0, 0);
+
+    // 只在地球坐标系下检测 (_globe为空表示相机在局部坐标系中)
+    if (!_globe || !defined(start)) {
+        return;
+    }
+
+    Cartesian3 end = _cameraController->positionWC();
+    Cartesian3 offset = end - start;
+    double length = offset.magnitude();
+    if (length == 0.0) {
+        return;
+    }
+
+    // 线段最低点比两端低约 length^2 / (8R), 整段都高于_minimumCollisionTerrainHeight时不可能碰到地形
+    Cartographic startCartographic = _ellipsoid->cartesianToCartographic(start);
+    Cartographic endCartographic = _ellipsoid->cartesianToCartographic(end);
+    double sag = length * length / (8.0 * _ellipsoid->minimumRadius());
+    if (std::min(startCartographic.height, endCartographic.height) - sag > _minimumCollisionTerrainHeight) {
+        return;
+    }
+
+    Cartesian3 resolved = end;
+    if (startCartographic.height >= collisionFloor(startCartographic)) {
+        // 沿线段等间距采样, 找到第一个低于地形的采样点, 再在前一个采样点之间二分
+        int count = std::max(_collisionSampleCount, 1);
+        double valid = 0.0;
+        double hit = -1.0;
+        for (int i = 1; i <= count; ++i) {
+            double t = double(i) / count;
+            Cartographic cartographic = _ellipsoid->cartesianToCartographic(start + offset * t);
+            if (cartographic.height < collisionFloor(cartographic)) {
+                hit = t;
+                break;
+            }
+            valid = t;
+        }
+
+        if (hit >= 0.0) {
+            for (int i = 0; i < refineIterations; ++i) {
+                double t = (valid + hit) * 0.5;
+                Cartographic cartographic = _ellipsoid->cartesianToCartographic(start + offset * t);
+                if (cartographic.height < collisionFloor(cartographic)) {
+                    hit = t;
+                } else {
+                    valid = t;
+                }
+            }
+            resolved = start + offset * valid;
+        }
+    }
+
+    // 起点已经在地形之下 (例如地形刚加载完成) 时不能沿路径回退, 沿法线抬高到地形之上
+    Cartographic resolvedCartographic = _ellipsoid->cartesianToCartographic(resolved);
+    double floor = collisionFloor(resolvedCartographic);
+    if (resolvedCartographic.height < floor) {
+        resolvedCartographic.height = floor;
+        resolved = _ellipsoid->cartographicToCartesian(resolvedCartographic);
+    }
+
+    if (resolved != end) {
+        _cameraController->setCameraPosition(resolved);
+    }
+}
+
+double ScreenSpaceCameraController::collisionFloor(const Cartographic &cartographic) const
+{
+    if (_enableUnderGround) {
+        return _undergroundFloor;
+    }
+
+    double height = m_globe->getHeight(cartographic);
+    if (height < 0) {
+        height = 0;
+    }
+    return height + _collisionClearance;
+}
+
+void ScreenSpaceCameraController::publishCameraState()
+{
+    quint64 poseEpoch = _cameraController->poseEpoch();
+    double fovy = _camera->fovy();
+    double aspectRatio = _camera->aspectRatio();
+    bool flying = _cameraController->isFlying();
+
+    if (_statePublisher->epoch() != 0 &&
+            poseEpoch == _publishedPoseEpoch &&
+            fovy == _publishedFovy &&
+            aspectRatio == _publishedAspectRatio &&
+            flying == _publishedFlying) {
+        return;
+    }
+
+    CameraState state;
+    state.timestamp = CameraClock::toMilliseconds(_frameTime);
+    state.flying = flying;
+    state.position = _cameraController->positionWC();
+    state.direction = _cameraController->directionWC();
+    state.up = _cameraController->upWC();
+    state.right = _cameraController->rightWC();
+    state.positionCartographic = _cameraController->positionCartographic();
+    _cameraController->headingPitchRoll(state.heading, state.pitch, state.roll);
+    state.fovy = fovy;
+    state.aspectRatio = aspectRatio;
+    state.nearPlane = _camera->nearPlane();
+    state.farPlane = _camera->farPlane();
+
+    _statePublisher->publish(state);
+
+    _publishedPoseEpoch = poseEpoch;
+    _publishedFovy = fovy;
+    _publishedAspectRatio = aspectRatio;
+    _publishedFlying = flying;
+}
+
+void ScreenSpaceCameraController::raiseCameraEvents()
+{
+    // 使用刚发布的相机状态, 不再读取相机, 每帧最多发出一次
+    quint64 poseEpoch = _publishedPoseEpoch;
+    bool moved = poseEpoch != _eventPoseEpoch;
+    _eventPoseEpoch = poseEpoch;
+
+    if (!moved) {
+        if (_moving && CameraClock::toMilliseconds(_frameTime - _lastMoveTime) >= _moveEndWaitTime) {
+            _moving = false;
+            emit moveEnd();
+        }
+        return;
+    }
+
+    CameraState state = _statePublisher->snapshot();
+
+    // 第一帧只记录初始位姿
+    if (!defined(_changedPosition)) {
+        _changedPosition = state.position;
+        _changedDirection = state.direction;
+        _changedHeading = state.heading;
+        return;
+    }
+
+    _lastMoveTime = _frameTime;
+    if (!_moving) {
+        _moving = true;
+        emit moveStart();
+    }
+    emit viewChanged();
+
+    // 与Cesium的Camera.percentageChanged相同: 方向的改变按半视角归一化, 位置的改变按相机高度归一化, heading的改变按π归一化
+    double directionPercentage = CesiumMath::acosClamped(Cartesian3::dot(state.direction, _changedDirection)) / (Math::toRadians(state.fovy) * 0.5);
+    double height = std::max(std::abs(state.positionCartographic.height), minimumZoomDistance);
+    double positionPercentage = (state.position - _changedPosition).magnitude() / height;
+    double headingPercentage = std::abs(CesiumMath::negativePiToPi(state.heading - _changedHeading)) / M_PI;
+    double percentage = std::max(directionPercentage, std::max(positionPercentage, headingPercentage));
 
-    handleKeyDown();
+    if (percentage > _percentageChanged) {
+        _changedPosition = state.position;
+        _changedDirection = state.direction;
+        _changedHeading = state.heading;
+        emit changed(percentage);
+    }
 }
 
 bool ScreenSpaceCameraController::enableInputs() const
@@ -168,6 +399,56 @@ void ScreenSpaceCameraController::setMinimumCollisionTerrainHeight(double minimu
     _cameraController->_minimumCollisionTerrainHeight = minimumCollisionTerrainHeight;
 }
 
+double ScreenSpaceCameraController::collisionClearance() const
+{
+    return _collisionClearance;
+}
+
+void ScreenSpaceCameraController::setCollisionClearance(double clearance)
+{
+    _collisionClearance = clearance;
+}
+
+int ScreenSpaceCameraController::collisionSampleCount() const
+{
+    return _collisionSampleCount;
+}
+
+void ScreenSpaceCameraController::setCollisionSampleCount(int count)
+{
+    _collisionSampleCount = std::max(count, 1);
+}
+
+double ScreenSpaceCameraController::undergroundFloor() const
+{
+    return _undergroundFloor;
+}
+
+void ScreenSpaceCameraController::setUndergroundFloor(double floor)
+{
+    _undergroundFloor = floor;
+}
+
+double ScreenSpaceCameraController::zoomAnchorTimeout() const
+{
+    return _zoomAnchorTimeout;
+}
+
+void ScreenSpaceCameraController::setZoomAnchorTimeout(double timeout)
+{
+    _zoomAnchorTimeout = std::max(timeout, 0.0);
+}
+
+double ScreenSpaceCameraController::zoomAnchorTolerance() const
+{
+    return _zoomAnchorTolerance;
+}
+
+void ScreenSpaceCameraController::setZoomAnchorTolerance(double tolerance)
+{
+    _zoomAnchorTolerance = std::max(tolerance, 0.0);
+}
+
 Vector3 ScreenSpaceCameraController::positionWC()
 {
     return _cameraController->positionWC();
@@ -208,6 +489,26 @@ double ScreenSpaceCameraController::roll()
     return _cameraController->roll();
 }
 
+double ScreenSpaceCameraController::percentageChanged() const
+{
+    return _percentageChanged;
+}
+
+void ScreenSpaceCameraController::setPercentageChanged(double percentage)
+{
+    _percentageChanged = std::max(percentage, 0.0);
+}
+
+double ScreenSpaceCameraController::moveEndWaitTime() const
+{
+    return _moveEndWaitTime;
+}
+
+void ScreenSpaceCameraController::setMoveEndWaitTime(double waitTime)
+{
+    _moveEndWaitTime = std::max(waitTime, 0.0);
+}
+
 Ray ScreenSpaceCameraController::getPickRay(double x, double y)
 {
     return _cameraController->getPickRay(x, y);
@@ -352,6 +653,265 @@ Cartesian3 ScreenSpaceCameraController::pickGlobe(const Vector2 &mousePosition)
     return rayIntersection;
 }
 
+QVector<CameraFlightSample> ScreenSpaceCameraController::sampleFlight(const QVector<double> &timeOffsets, bool withFootprint)
+{
+    return _cameraController->sampleFlight(timeOffsets, withFootprint);
+}
+
+void ScreenSpaceCameraController::flyTour(const QVector<CameraWaypoint> &waypoints)
+{
+    _cameraController->flyTour(waypoints);
+}
+
+CameraState ScreenSpaceCameraController::cameraState() const
+{
+    return _statePublisher->snapshot();
+}
+
+quint64 ScreenSpaceCameraController::cameraStateEpoch() const
+{
+    return _statePublisher->epoch();
+}
+
+bool ScreenSpaceCameraController::handleTouchEvent(QTouchEvent *event)
+{
+    return _aggregator->processTouchEvent(event);
+}
+
+void ScreenSpaceCameraController::handleWheel(const Cartesian2 &position, int deltaY)
+{
+    _aggregator->processWheel(position, deltaY);
+}
+
+InputEventCounters ScreenSpaceCameraController::inputEventCounters() const
+{
+    return _aggregator->inputEventCounters();
+}
+
+EllipsoidalOccluder ScreenSpaceCameraController::ellipsoidalOccluder()
+{
+    quint64 poseEpoch = _cameraController->poseEpoch();
+    if (_occluderEpoch != poseEpoch || _occluder.ellipsoid() != _ellipsoid) {
+        _occluder = EllipsoidalOccluder(_ellipsoid, _cameraController->positionWC());
+        _occluderEpoch = poseEpoch;
+    }
+    return _occluder;
+}
+
+bool ScreenSpaceCameraController::submitCommands(const QVariantList &commands)
+{
+    CameraCommandBuffer buffer;
+    QString error;
+    if (!buffer.append(commands, &error)) {
+        qWarning("ScreenSpaceCameraController::submitCommands: %s", qPrintable(error));
+        return false;
+    }
+
+    submitCommands(buffer);
+    return true;
+}
+
+void ScreenSpaceCameraController::submitCommands(const CameraCommandBuffer &buffer)
+{
+    QMutexLocker locker(&_commandMutex);
+    _pendingCommands.append(buffer);
+}
+
+void ScreenSpaceCameraController::applyPendingCommands()
+{
+    CameraCommandBuffer commands;
+    {
+        QMutexLocker locker(&_commandMutex);
+        if (_pendingCommands.isEmpty()) {
+            return;
+        }
+        std::swap(commands, _pendingCommands);
+    }
+
+    _cameraController->applyCommands(commands.commands());
+}
+
+void ScreenSpaceCameraController::setSyncMaster(CameraSyncTransport *transport)
+{
+    if (_syncTransport) {
+        disconnect(_syncTransport, nullptr, this, nullptr);
+    }
+
+    _syncTransport = transport;
+    _syncRole = transport ? SyncMaster : SyncNone;
+    _syncEncoder.reset();
+    _syncPoses.clear();
+}
+
+void ScreenSpaceCameraController::setSyncFollower(CameraSyncTransport *transport)
+{
+    if (_syncTransport) {
+        disconnect(_syncTransport, nullptr, this, nullptr);
+    }
+
+    _syncTransport = transport;
+    _syncRole = transport ? SyncFollower : SyncNone;
+    _syncDecoder.reset();
+    _syncPoses.clear();
+    _syncApplied = false;
+
+    if (transport) {
+        _cameraController->cancelFlight();
+        connect(transport, &CameraSyncTransport::packetReceived, this, &ScreenSpaceCameraController::receiveSyncPacket);
+    }
+}
+
+void ScreenSpaceCameraController::setSyncViewOffset(double heading, double pitch, double roll)
+{
+    _syncHeadingOffset = heading;
+    _syncPitchOffset = pitch;
+    _syncRollOffset = roll;
+}
+
+void ScreenSpaceCameraController::setSyncTargetFrame(qint64 frame)
+{
+    _syncTargetFrame = frame;
+}
+
+quint32 ScreenSpaceCameraController::syncFrame() const
+{
+    return _syncFrame;
+}
+
+void ScreenSpaceCameraController::receiveSyncPacket(const QByteArray &packet)
+{
+    const int maximumPendingPoses = 32;
+
+    CameraSyncPose pose;
+    bool restarted;
+    if (!_syncDecoder.decode(packet, pose, &restarted)) {
+        return;
+    }
+
+    if (restarted) {
+        // 主控节点重启, 帧号重新开始, 丢弃旧的帧号
+        _syncPoses.clear();
+        _syncApplied = false;
+    } else if (_syncApplied && qint32(pose.frame - _syncFrame) <= 0) {
+        // 乱序迟到的旧位姿, 应用后相机会跳回去
+        return;
+    }
+
+    _syncPoses.insert(pose.frame, pose);
+    while (_syncPoses.size() > maximumPendingPoses) {
+        _syncPoses.erase(_syncPoses.begin());
+    }
+}
+
+void ScreenSpaceCameraController::sendSyncPose()
+{
+    // 同步transform坐标系下的位姿, 所有节点的场景使用相同的transform
+    CameraSyncPose pose;
+    pose.frame = _syncFrame++;
+    pose.position = _cameraController->cameraPosition();
+    pose.direction = _cameraController->cameraDirection();
+    pose.up = _cameraController->cameraUp();
+    pose.right = _cameraController->cameraRight();
+
+    _syncTransport->send(_syncEncoder.encode(pose));
+}
+
+void ScreenSpaceCameraController::applySyncPose()
+{
+    if (_syncPoses.isEmpty()) {
+        return;
+    }
+
+    // 应用不超过目标帧号的最新位姿, 目标帧还没有到达时保持上一帧
+    QMap<quint32, CameraSyncPose>::iterator it = _syncPoses.end();
+    if (_syncTargetFrame >= 0) {
+        it = _syncPoses.upperBound(quint32(_syncTargetFrame));
+        if (it == _syncPoses.begin()) {
+            return;
+        }
+    }
+    --it;
+
+    CameraSyncPose pose = it.value();
+    while (!_syncPoses.isEmpty() && _syncPoses.firstKey() <= pose.frame) {
+        _syncPoses.erase(_syncPoses.begin());
+    }
+    _syncFrame = pose.frame;
+    _syncApplied = true;
+
+    Cartesian3 direction = pose.direction;
+    Cartesian3 up = pose.up;
+    Cartesian3 right = pose.right;
+
+    // Rodrigues旋转, 依次应用heading, pitch, roll偏移
+    auto rotate = [](const Cartesian3 &vector, const Cartesian3 &axis, double angle) {
+        double c = cos(angle);
+        double s = sin(angle);
+        return vector * c + Cartesian3::cross(axis, vector) * s + axis * (Cartesian3::dot(axis, vector) * (1.0 - c));
+    };
+    if (_syncHeadingOffset != 0.0) {
+        direction = rotate(direction, up, -_syncHeadingOffset);
+        right = rotate(right, up, -_syncHeadingOffset);
+    }
+    if (_syncPitchOffset != 0.0) {
+        direction = rotate(direction, right, _syncPitchOffset);
+        up = rotate(up, right, _syncPitchOffset);
+    }
+    if (_syncRollOffset != 0.0) {
+        up = rotate(up, direction, _syncRollOffset);
+        right = rotate(right, direction, _syncRollOffset);
+    }
+
+    _cameraController->setCameraPosition(pose.position);
+    _cameraController->setCameraAxes(right, direction, up);
+}
+
+CameraClock *ScreenSpaceCameraController::clock() const
+{
+    return _clock;
+}
+
+void ScreenSpaceCameraController::setClock(CameraClock *clock)
+{
+    _clock = clock ? clock : &_steadyClock;
+    _aggregator->setClock(_clock);
+    _cameraController->setClock(_clock);
+
+    // 不同时钟的时间不能相减
+    lastTime = -1;
+}
+
+qint64 ScreenSpaceCameraController::frameTime() const
+{
+    return _frameTime;
+}
+
+CameraMotionMetrics ScreenSpaceCameraController::motionMetrics()
+{
+    return _cameraController->motionMetrics();
+}
+
+double ScreenSpaceCameraController::fastMotionThreshold() const
+{
+    return _cameraController->fastMotionThreshold();
+}
+
+void ScreenSpaceCameraController::setFastMotionThreshold(double threshold)
+{
+    _cameraController->setFastMotionThreshold(threshold);
+}
+
+void ScreenSpaceCameraController::isPointVisible(const double *x, const double *y, const double *z, quint8 *visible, int count)
+{
+    ellipsoidalOccluder().isPointVisible(x, y, z, visible, count);
+}
+
+void ScreenSpaceCameraController::isBoundingSphereVisible(const double *x, const double *y, const double *z, const double *radius,
+                                                          quint8 *visible, int count)
+{
+    ellipsoidalOccluder().isBoundingSphereVisible(x, y, z, radius, visible, count);
+}
+
 void ScreenSpaceCameraController::spin3DByKey(double startX, double startY, double endX, double endY, bool touring, bool mouseUp)
 {
     if (mouseUp) {
@@ -367,16 +927,13 @@ void ScreenSpaceCameraController::spin3DByKey(double startX, double startY, doub
 
     m_touring = touring;
     Cartesian3 spin3DPick;
-    Cartesian3 cameraCarte = _cameraTrans->worldPosition();
+    Cartesian3 cameraCarte = _cameraController->cameraPosition();
     double height = _ellipsoid->cartesianToCartographic(cameraCarte).height;
     Cartesian3 mousePos;
     if (height < _minimumPickingTerrainHeight) {
         mousePos = pickGlobe(Vector2(startX, startY));
         if (!mousePos.isNull()) {
-            double magnitude = mousePos.magnitude();
-            Ellipsoid ellipsoid(magnitude, magnitude, magnitude);
-            Cartesian3 p0 = _cameraController->pickEllipsoid(Cartesian2(startX, startY), &ellipsoid, p0);
-            pan3DByKey(startX, startY, endX, endY, &ellipsoid);
+            pan3DByKey(startX, startY, endX, endY, Sphere(mousePos.magnitude()));
         } else {
             m_looking = true;
             look3DByKey(startX, startY, endX, endY);
@@ -391,14 +948,15 @@ void ScreenSpaceCameraController::spin3DByKey(double startX, double startY, doub
     }
 }
 
-void ScreenSpaceCameraController::pan3DByKey(double startX, double startY, double endX, double endY, Ellipsoid *ellipsoid)
+template <typename Shape>
+void ScreenSpaceCameraController::pan3DByKey(double startX, double startY, double endX, double endY, const Shape &shape)
 {
     Cartesian2 startMousePosition(startX, startY);
     Cartesian2 endMousePosition(endX, endY);
 
     Cartesian3 p0, p1;
-    _cameraController->pickEllipsoid(startMousePosition, ellipsoid, p0);
-    _cameraController->pickEllipsoid(endMousePosition, ellipsoid, p1);
+    _cameraController->pickEllipsoid(startMousePosition, shape, p0);
+    _cameraController->pickEllipsoid(endMousePosition, shape, p1);
 
     _cameraController->worldToCameraCoordinates(p0);
     _cameraController->worldToCameraCoordinates(p1);
@@ -413,12 +971,12 @@ void ScreenSpaceCameraController::pan3DByKey(double startX, double startY, doubl
         if (angle < 0.00000002)
             angle = 0.00000002;
 
-        Cartesian3 oldPos = _cameraTrans->worldPosition();
+        Cartesian3 oldPos = _cameraController->cameraPosition();
         _cameraController->rotate(axis, angle);
 
         // add by feng
-        if (cartesianToCartographic(_cameraTrans->worldPosition()).height < 1) {
-            _cameraTrans->setWorldPosition(oldPos);
+        if (cartesianToCartographic(_cameraController->cameraPosition()).height < 1) {
+            _cameraController->setCameraPosition(oldPos);
             return;
         }
     }
@@ -453,7 +1011,7 @@ void ScreenSpaceCameraController::look3DByKey(double startX, double startY, doub
     }
     angle = startX > endX ? -angle : angle;
 
-    Cartesian3 rotationAxis = _ellipsoid->geodeticSurfaceNormal(_cameraTrans->worldPosition());
+    Cartesian3 rotationAxis = _ellipsoid->geodeticSurfaceNormal(_cameraController->cameraPosition());
     _cameraController->look(rotationAxis, -angle);
 
     start = _cameraController->getPickRay(0, startY).direction;
@@ -467,25 +1025,25 @@ void ScreenSpaceCameraController::look3DByKey(double startX, double startY, doub
     angle = startY > endY ? -angle : angle;
 
     Cartesian3 negativeRotationAxis = -rotationAxis;
-    bool northParallel = CesiumCartesian3::equalsEpsilon(_cameraTrans->yaxis(), rotationAxis, Math::EPSILON2);
-    bool southParallel = CesiumCartesian3::equalsEpsilon(_cameraTrans->yaxis(), negativeRotationAxis, Math::EPSILON2);
+    bool northParallel = CesiumCartesian3::equalsEpsilon(_cameraController->cameraDirection(), rotationAxis, Math::EPSILON2);
+    bool southParallel = CesiumCartesian3::equalsEpsilon(_cameraController->cameraDirection(), negativeRotationAxis, Math::EPSILON2);
     if ((!northParallel && !southParallel)) {
-        dot = Cartesian3::dot(_cameraTrans->yaxis(), rotationAxis);
+        dot = Cartesian3::dot(_cameraController->cameraDirection(), rotationAxis);
         double angleToAxis = CesiumMath::acosClamped(dot); // CesiumMath.acosClamped(dot);
         if (angle > 0 && angle > angleToAxis) {
             angle = angleToAxis - Math::EPSILON4;
         }
 
-        dot = Cartesian3::dot(_cameraTrans->yaxis(), negativeRotationAxis);
+        dot = Cartesian3::dot(_cameraController->cameraDirection(), negativeRotationAxis);
         angleToAxis = CesiumMath::acosClamped(dot); // CesiumMath.acosClamped(dot);
         if (angle < 0 && -angle > angleToAxis) {
             angle = -angleToAxis + Math::EPSILON4;
         }
 
-        Cartesian3 tangent = Cartesian3::cross(rotationAxis, _cameraTrans->yaxis());
+        Cartesian3 tangent = Cartesian3::cross(rotationAxis, _cameraController->cameraDirection());
         _cameraController->look(tangent, angle);
     } else if ((northParallel && angle < 0) || (southParallel && angle > 0)) {
-        _cameraController->look(_cameraTrans->xaxis(), -angle);
+        _cameraController->look(_cameraController->cameraRight(), -angle);
     }
 }
 
@@ -541,14 +1099,14 @@ void ScreenSpaceCameraController::maintainInertia(CameraEventType::Type type, in
         _movementState[lastMovementName] = movementState;
     }
 
-    quint64 ts = _aggregator->getButtonPressTime(type, modifier);
-    quint64 tr = _aggregator->getButtonReleaseTime(type, modifier);
+    double ts = _aggregator->getButtonPressTime(type, modifier);
+    double tr = _aggregator->getButtonReleaseTime(type, modifier);
 
     double threshold = 0.0;
     if (ts != 0 && tr != 0)
         threshold = (tr - ts) / 1000.0;
 
-    quint64 now = getTimestamp();
+    double now = CameraClock::toMilliseconds(_frameTime);
     double fromNow = (now - tr) / 1000.0;
 
     double inertiaMaxClickTimeThreshold = 0.4;
@@ -645,7 +1203,7 @@ void ScreenSpaceCameraController::spin3D(const Cartesian2 &startPosition, const
         }
     }
 
-    _rotationAxis = _ellipsoid->geodeticSurfaceNormal(_cameraTrans->worldPosition());
+    _rotationAxis = _ellipsoid->geodeticSurfaceNormal(_cameraController->cameraPosition());
 
     if (startPosition == _rotateMousePosition) {
         if (_looking) {
@@ -656,9 +1214,7 @@ void ScreenSpaceCameraController::spin3D(const Cartesian2 &startPosition, const
             _strafeStartPosition =  mousePos;
             strafe(movement);
         } else {
-            double magnitude = _rotateStartPosition.magnitude();
-            Ellipsoid ellipsoid(magnitude, magnitude, magnitude);
-            pan3D(movement, &ellipsoid);
+            pan3D(movement, Sphere(_rotateStartPosition.magnitude()));
         }
         _rotationAxis = Cartesian3();
         return;
@@ -669,15 +1225,13 @@ void ScreenSpaceCameraController::spin3D(const Cartesian2 &startPosition, const
 
     if (_globe && height < _minimumPickingTerrainHeight) {
         if (!mousePos.isNull()) {
-            if (_cameraTrans->worldPosition().magnitude() < mousePos.magnitude()) {
+            if (_cameraController->cameraPosition().magnitude() < mousePos.magnitude()) {
                 mousePos = _strafeStartPosition;
 
                 _strafing = true;
                 strafe(movement);
             } else {
-                double magnitude = mousePos.magnitude();
-                Ellipsoid ellipsoid(magnitude, magnitude, magnitude);
-                pan3D(movement, &ellipsoid);
+                pan3D(movement, Sphere(mousePos.magnitude()));
 
                 _rotateStartPosition = mousePos;
             }
@@ -710,7 +1264,7 @@ void ScreenSpaceCameraController::zoom3D(const Cartesian2 &startPosition, const
     Ray ray = _cameraController->getPickRay(windowPosition.x, windowPosition.y);
 
     Cartesian3 intersection;
-    double height = _ellipsoid->cartesianToCartographic(_cameraTrans->worldPosition()).height;
+    double height = _ellipsoid->cartesianToCartographic(_cameraController->cameraPosition()).height;
     if (height < _minimumPickingTerrainHeight) {
         intersection = pickGlobe(Vector2(windowPosition.x, windowPosition.y));
     }
@@ -722,8 +1276,8 @@ void ScreenSpaceCameraController::zoom3D(const Cartesian2 &startPosition, const
         distance = height;
     }
 
-    Cartesian3 unitPosition = _cameraTrans->worldPosition().normalized();
-    handleZoom(startPosition, movement, _zoomFactor, distance, Cartesian3::dot(unitPosition, _cameraTrans->yaxis()));
+    Cartesian3 unitPosition = _cameraController->cameraPosition().normalized();
+    handleZoom(startPosition, movement, _zoomFactor, distance, Cartesian3::dot(unitPosition, _cameraController->cameraDirection()));
 }
 
 void ScreenSpaceCameraController::tilt3D(const Cartesian2 &startPosition, const CameraMovement &movement)
@@ -737,7 +1291,7 @@ void ScreenSpaceCameraController::tilt3D(const Cartesian2 &startPosition, const
 //    }
 
     if (startPosition != _tiltCenterMousePosition) {
-        Cartographic cartographic = _ellipsoid->cartesianToCartographic(_cameraTrans->worldPosition());
+        Cartographic cartographic = _ellipsoid->cartesianToCartographic(_cameraController->cameraPosition());
         if (cartographic.height > _minimumCollisionTerrainHeight) {
             _tiltOnEllipsoid = true;
         }
@@ -748,7 +1302,7 @@ void ScreenSpaceCameraController::tilt3D(const Cartesian2 &startPosition, const
     }
 
     if (_looking) {
-        _rotationAxis = _ellipsoid->geodeticSurfaceNormal(_cameraTrans->worldPosition());
+        _rotationAxis = _ellipsoid->geodeticSurfaceNormal(_cameraController->cameraPosition());
         look3D(startPosition, movement);
         _rotationAxis = Cartesian3(0, 0, 0);
         return;
@@ -760,18 +1314,18 @@ void ScreenSpaceCameraController::tilt3D(const Cartesian2 &startPosition, const
         tilt3DOnTerrain(startPosition, movement);
 
         Cartesian3 normal = _ellipsoid->geodeticSurfaceNormal(_cameraController->positionWC());
-        double angle = CesiumCartesian3::angleBetween(normal, _cameraTrans->xaxis()); // radian
+        double angle = CesiumCartesian3::angleBetween(normal, _cameraController->cameraRight()); // radian
 
         if (abs(M_PI_2 - angle) >= 0.0001) {
             double angle2 = angle - M_PI_2;
-//            _cameraController->look(_cameraTrans->yaxis(), angle2);
+//            _cameraController->look(_cameraController->cameraDirection(), angle2);
 
             Cartesian3 lookAxis;
-            double dotZ = Cartesian3::dot(normal, _cameraTrans->zaxis());
+            double dotZ = Cartesian3::dot(normal, _cameraController->cameraUp());
             if (abs(dotZ) > 0.707) // 相机z轴 与 normal夹角小于45度, 表示相机绕x轴向上旋转超过45度
-                lookAxis = _cameraTrans->yaxis();
+                lookAxis = _cameraController->cameraDirection();
             else
-                lookAxis = _cameraTrans->zaxis();
+                lookAxis = _cameraController->cameraUp();
 
             _cameraController->look(lookAxis, angle2);
         }
@@ -843,25 +1397,25 @@ void ScreenSpaceCameraController::look3D(const Cartesian2 &startPosition, const
 
     if (!rotationAxis.isNull()) {
         Cartesian3 negativeRotationAxis = -rotationAxis;
-        bool northParallel = CesiumCartesian3::equalsEpsilon(_cameraTrans->yaxis(), rotationAxis, Math::EPSILON2);
-        bool southParallel = CesiumCartesian3::equalsEpsilon(_cameraTrans->yaxis(), negativeRotationAxis, Math::EPSILON2);
+        bool northParallel = CesiumCartesian3::equalsEpsilon(_cameraController->cameraDirection(), rotationAxis, Math::EPSILON2);
+        bool southParallel = CesiumCartesian3::equalsEpsilon(_cameraController->cameraDirection(), negativeRotationAxis, Math::EPSILON2);
         if ((!northParallel && !southParallel)) {
-            dot = Cartesian3::dot(_cameraTrans->yaxis(), rotationAxis);
+            dot = Cartesian3::dot(_cameraController->cameraDirection(), rotationAxis);
             double angleToAxis = CesiumMath::acosClamped(dot); // CesiumMath.acosClamped(dot);
             if (angle > 0 && angle > angleToAxis) {
                 angle = angleToAxis - Math::EPSILON4;
             }
 
-            dot = Cartesian3::dot(_cameraTrans->yaxis(), negativeRotationAxis);
+            dot = Cartesian3::dot(_cameraController->cameraDirection(), negativeRotationAxis);
             angleToAxis = CesiumMath::acosClamped(dot); // CesiumMath.acosClamped(dot);
             if (angle < 0 && -angle > angleToAxis) {
                 angle = -angleToAxis + Math::EPSILON4;
             }
 
-            Cartesian3 tangent = Cartesian3::cross(rotationAxis, _cameraTrans->yaxis());
+            Cartesian3 tangent = Cartesian3::cross(rotationAxis, _cameraController->cameraDirection());
             _cameraController->look(tangent, angle);
         } else if ((northParallel && angle < 0) || (southParallel && angle > 0)) {
-            _cameraController->look(_cameraTrans->xaxis(), -angle);
+            _cameraController->look(_cameraController->cameraRight(), -angle);
         }
     } else {
         _cameraController->lookUp(angle);
@@ -878,7 +1432,7 @@ void ScreenSpaceCameraController::strafe(const CameraMovement &movement)
     Cartesian3 mousePosition = movement.endPosition;
     Ray ray = _cameraController->getPickRay(mousePosition.x, mousePosition.y);
 
-    Cartesian3 direction = _cameraTrans->yaxis();
+    Cartesian3 direction = _cameraController->cameraDirection();
 
     Plane plane(mouseStartPosition, direction);
     Cartesian3 intersection = IntersectionTests::rayPlane(ray, &plane);
@@ -888,26 +1442,11 @@ void ScreenSpaceCameraController::strafe(const CameraMovement &movement)
 
     direction = mouseStartPosition - intersection;
 
-    _cameraTrans->setWorldPosition(_cameraTrans->worldPosition() + direction);
-
-    Cartographic cameraCartographic = _ellipsoid->cartesianToCartographic(_cameraController->positionWC());
-    double cameraHeight = cameraCartographic.height;
-    if (!_enableUnderGround) {
-        double height = m_globe->getHeight(cameraCartographic);
-        if (height < 0)
-            height = 0;
-        height = height + 0.9;
-        if (cameraHeight < height) {
-           _cameraTrans->setWorldPosition(_cameraTrans->worldPosition() - direction);
-        }
-    }
-    else {
-        if (cameraHeight < -980)
-            _cameraTrans->setWorldPosition(_cameraTrans->worldPosition() - direction);
-    }
+    _cameraController->setCameraPosition(_cameraController->cameraPosition() + direction);
 }
 
-void ScreenSpaceCameraController::pan3D(const CameraMovement &movement, Ellipsoid *ellipsoid)
+template <typename Shape>
+void ScreenSpaceCameraController::pan3D(const CameraMovement &movement, const Shape &shape)
 {
     if (!_enablePan) {
         return;
@@ -917,8 +1456,8 @@ void ScreenSpaceCameraController::pan3D(const CameraMovement &movement, Ellipsoi
     Cartesian2 endMousePosition = movement.endPosition;
 
     Cartesian3 p0, p1;
-    _cameraController->pickEllipsoid(startMousePosition, ellipsoid, p0);
-    _cameraController->pickEllipsoid(endMousePosition, ellipsoid, p1);
+    _cameraController->pickEllipsoid(startMousePosition, shape, p0);
+    _cameraController->pickEllipsoid(endMousePosition, shape, p1);
 
     if (!defined(p0) || !defined(p1)) {
         _rotating = true;
@@ -977,10 +1516,10 @@ void ScreenSpaceCameraController::pan3D(const CameraMovement &movement, Ellipsoi
         double deltaPhi = startPhi - endPhi;
 
         Cartesian3 east;
-        if (CesiumCartesian3::equalsEpsilon(basis0, _cameraTrans->worldPosition(), Math::EPSILON2)) {
-            east = _cameraTrans->xaxis();
+        if (CesiumCartesian3::equalsEpsilon(basis0, _cameraController->cameraPosition(), Math::EPSILON2)) {
+            east = _cameraController->cameraRight();
         } else {
-            east = Cartesian3::cross(basis0, _cameraTrans->worldPosition());
+            east = Cartesian3::cross(basis0, _cameraController->cameraPosition());
         }
 
         Cartesian3 planeNormal = Cartesian3::cross(basis0, east);
@@ -991,7 +1530,7 @@ void ScreenSpaceCameraController::pan3D(const CameraMovement &movement, Ellipsoi
         if (side0 > 0 && side1 > 0) {
             deltaTheta = endTheta - startTheta;
         } else if (side0 > 0 && side1 <= 0) {
-            if (Cartesian3::dot(_cameraTrans->worldPosition(), basis0) > 0) {
+            if (Cartesian3::dot(_cameraController->cameraPosition(), basis0) > 0) {
                 deltaTheta = -startTheta - endTheta;
             } else {
                 deltaTheta = startTheta + endTheta;
@@ -1006,17 +1545,18 @@ void ScreenSpaceCameraController::pan3D(const CameraMovement &movement, Ellipsoi
 }
 
 void ScreenSpaceCameraController::rotate3D(const CameraMovement &movement, const Cartesian3 &constrainedAxis,
-                                           bool rotateOnlyVertical, bool rotateOnlyHorizontal)
+                                           bool rotateOnlyVertical, bool rotateOnlyHorizontal, bool localFrame)
 {
-    Ellipsoid *ellipsoid = Ellipsoid::WGS84();
-
     Cartesian3 oldAxis = _cameraController->constrainedAxis;
     if (defined(constrainedAxis)) {
         _cameraController->constrainedAxis = constrainedAxis;
     }
 
-    double rho = _cameraTrans->worldPosition().magnitude();
-    double rotateRate = _rotateFactor * (rho - _rotateRateRangeAdjustment);
+    double rho = _cameraController->cameraPosition().magnitude();
+    // 在倾斜中心的局部坐标系中按单位球计算旋转速率
+    double rotateFactor = localFrame ? 1.0 : _rotateFactor;
+    double rotateRateRangeAdjustment = localFrame ? 1.0 : _rotateRateRangeAdjustment;
+    double rotateRate = rotateFactor * (rho - rotateRateRangeAdjustment);
 
     if (rotateRate > _maximumRotateRate) {
         rotateRate = _maximumRotateRate;
@@ -1045,44 +1585,10 @@ void ScreenSpaceCameraController::rotate3D(const CameraMovement &movement, const
 
     if (!rotateOnlyVertical) {
         _cameraController->rotateRight(deltaPhi);
-
-        Cartographic cameraCartographic = ellipsoid->cartesianToCartographic(_cameraController->positionWC());
-        double cameraHeight = cameraCartographic.height;
-        if (!_enableUnderGround){
-            double height = m_globe->getHeight(cameraCartographic);
-            if (height < 0)
-                height = 0;
-            height = height + 0.9;
-            if (cameraHeight < height) {
-                _cameraController->rotateRight(-deltaPhi);
-            }
-        }
-        else {
-            if (cameraHeight < -980) {
-                _cameraController->rotateRight(-deltaPhi);
-            }
-        }
     }
 
     if (!rotateOnlyHorizontal) {
         _cameraController->rotateUp(deltaTheta);
-
-        Cartographic cameraCartographic = ellipsoid->cartesianToCartographic(_cameraController->positionWC());
-        double cameraHeight = cameraCartographic.height;
-        if (!_enableUnderGround){
-            double height = m_globe->getHeight(cameraCartographic);
-            if (height < 0)
-                height = 0;
-            height = height + 0.9;
-            if (cameraHeight < height) {
-                if (deltaTheta > 0)
-                    _cameraController->rotateUp(-deltaTheta);
-            }
-        }
-        else {
-            if (cameraHeight < -980)
-                _cameraController->rotateUp(-deltaTheta);
-        }
     }
     _cameraController->constrainedAxis = oldAxis;
 }
@@ -1117,7 +1623,7 @@ void ScreenSpaceCameraController::tilt3DOnEllipsoid(const Cartesian2 &startPosit
         center = _ellipsoid->cartographicToCartesian(grazingAltitudeCart);
     } else {
         _looking = true;
-        _rotationAxis = _ellipsoid->geodeticSurfaceNormal(_cameraTrans->worldPosition());
+        _rotationAxis = _ellipsoid->geodeticSurfaceNormal(_cameraController->cameraPosition());
         look3D(startPosition, movement);
         _rotationAxis = Cartesian3(0, 0, 0);
         _tiltCenterMousePosition = startPosition;
@@ -1126,26 +1632,12 @@ void ScreenSpaceCameraController::tilt3DOnEllipsoid(const Cartesian2 &startPosit
 
     Matrix4 transform = Transforms::eastNorthUpToFixedFrame(center, _ellipsoid);
 
-    Globe *oldGlobe = _globe;
-    Ellipsoid *oldEllipsoid = _ellipsoid;
-    _globe = nullptr;
-    _ellipsoid = _sphereEllipsoid;
-    _rotateFactor = 1.0;
-    _rotateRateRangeAdjustment = 1.0;
-
     Matrix4 oldTransform = _cameraController->_transform;
     _cameraController->_setTransform(transform);
 
-    rotate3D(movement, Cartesian3::UNIT_Z);
+    rotate3D(movement, Cartesian3::UNIT_Z, false, false, true);
 
     _cameraController->_setTransform(oldTransform);
-
-    _globe = oldGlobe;
-    _ellipsoid = oldEllipsoid;
-
-    double radius = oldEllipsoid->maximumRadius();
-    _rotateFactor = 1.0 / radius;
-    _rotateRateRangeAdjustment = radius;
 }
 
 void ScreenSpaceCameraController::tilt3DOnTerrain(const Cartesian2 &startPosition, const CameraMovement &movement)
@@ -1157,7 +1649,7 @@ void ScreenSpaceCameraController::tilt3DOnTerrain(const Cartesian2 &startPositio
     if (startPosition == _tiltCenterMousePosition) {
         center = _tiltCenter;
     } else {
-        double height = cartesianToCartographic(_cameraTrans->worldPosition()).height;
+        double height = cartesianToCartographic(_cameraController->cameraPosition()).height;
         if (height < 0)
             center = pickGlobe(Vector2(startPosition.x, startPosition.y));
         else {
@@ -1175,10 +1667,10 @@ void ScreenSpaceCameraController::tilt3DOnTerrain(const Cartesian2 &startPositio
             ray = _cameraController->getPickRay(startPosition.x, startPosition.y);
             intersection = IntersectionTests::rayEllipsoid(ray, _ellipsoid);
             if (!defined(intersection)) {
-                Cartographic cartographic = _ellipsoid->cartesianToCartographic(_cameraTrans->worldPosition());
+                Cartographic cartographic = _ellipsoid->cartesianToCartographic(_cameraController->cameraPosition());
                 if (cartographic.height <= _minimumTrackBallHeight) {
                     _looking = true;
-                    _rotationAxis = _ellipsoid->geodeticSurfaceNormal(_cameraTrans->worldPosition());
+                    _rotationAxis = _ellipsoid->geodeticSurfaceNormal(_cameraController->cameraPosition());
                     look3D(startPosition, movement);
                     _rotationAxis = Cartesian3(0, 0, 0);
                     _tiltCenterMousePosition = startPosition;
@@ -1196,9 +1688,7 @@ void ScreenSpaceCameraController::tilt3DOnTerrain(const Cartesian2 &startPositio
     ray = _cameraController->getPickRay(windowPosition.x, windowPosition.y);
 
     double mag = center.magnitude();
-    Ellipsoid newEllipsoid(mag, mag, mag);
-
-    intersection = IntersectionTests::rayEllipsoid(ray, &newEllipsoid);
+    intersection = IntersectionTests::raySphere(ray, Sphere(mag));
     if (!defined(intersection)) {
         return;
     }
@@ -1207,14 +1697,8 @@ void ScreenSpaceCameraController::tilt3DOnTerrain(const Cartesian2 &startPositio
     Vector3 verticalCenter = ray.getPoint(t);
 
     Matrix4 transform = Transforms::eastNorthUpToFixedFrame(center, _ellipsoid);
-    Matrix4 verticalTransform = Transforms::eastNorthUpToFixedFrame(verticalCenter, &newEllipsoid);
-
-    Globe *oldGlobe = _globe;
-    Ellipsoid *oldEllipsoid = _ellipsoid;
-    _globe = nullptr;
-    _ellipsoid = _sphereEllipsoid;
-    _rotateFactor = 1.0;
-    _rotateRateRangeAdjustment = 1.0;
+    // 球面的法线与半径无关, 用单位球计算东北天坐标系
+    Matrix4 verticalTransform = Transforms::eastNorthUpToFixedFrame(verticalCenter, _sphereEllipsoid);
 
     Cartesian3 constrainedAxis = Cartesian3::UNIT_Z;
 
@@ -1224,7 +1708,7 @@ void ScreenSpaceCameraController::tilt3DOnTerrain(const Cartesian2 &startPositio
     Cartesian3 tangent = Cartesian3::cross(verticalCenter, _cameraController->positionWC());
     double dot = Cartesian3::dot(_cameraController->rightWC(), tangent);
 
-    rotate3D(movement, constrainedAxis, false, true);
+    rotate3D(movement, constrainedAxis, false, true, true);
 
     _cameraController->_setTransform(verticalTransform); // try to move above, but not
 
@@ -1242,23 +1726,23 @@ void ScreenSpaceCameraController::tilt3DOnTerrain(const Cartesian2 &startPositio
         Cartesian3 oldConstrainedAxis = _cameraController->constrainedAxis;
         _cameraController->constrainedAxis = Cartesian3(Math::EPSILON20, 0, 0);
 
-        rotate3D(movement, constrainedAxis, true, false);
+        rotate3D(movement, constrainedAxis, true, false, true);
 
         _cameraController->constrainedAxis = oldConstrainedAxis;
     } else {
-        rotate3D(movement, constrainedAxis, true, false);
+        rotate3D(movement, constrainedAxis, true, false, true);
     }
 
     if (defined(_cameraController->constrainedAxis)) {
         Cartesian3 ZERO;
-        Cartesian3 right = Cartesian3::cross(_cameraTrans->yaxis(), _cameraController->constrainedAxis).normalize();
+        Cartesian3 right = Cartesian3::cross(_cameraController->cameraDirection(), _cameraController->constrainedAxis).normalize();
         if (!CesiumCartesian3::equalsEpsilon(right, ZERO, Math::EPSILON6)) {
-            if (Cartesian3::dot(right, _cameraTrans->xaxis()) < 0.0) {
+            if (Cartesian3::dot(right, _cameraController->cameraRight()) < 0.0) {
                 right = -right;
             }
 
             Cartesian3 rightCarte;
-            Cartesian3 directionCarte = _cameraTrans->yaxis();
+            Cartesian3 directionCarte = _cameraController->cameraDirection();
             Cartesian3 upCarte;
 
             upCarte = Cartesian3::cross(right, directionCarte);
@@ -1266,17 +1750,11 @@ void ScreenSpaceCameraController::tilt3DOnTerrain(const Cartesian2 &startPositio
             upCarte.normalize();
             rightCarte.normalize();
 
-            _cameraTrans->setAxes(rightCarte, directionCarte, upCarte);
+            _cameraController->setCameraAxes(rightCarte, directionCarte, upCarte);
         }
     }
 
     _cameraController->_setTransform(oldTransform);
-    _globe = oldGlobe;
-    _ellipsoid = oldEllipsoid;
-
-    double radius = oldEllipsoid->maximumRadius();
-    _rotateFactor = 1.0 / radius;
-    _rotateRateRangeAdjustment = radius;
 
     Cartesian3 originalPosition = _cameraController->positionWC();
 
@@ -1285,28 +1763,28 @@ void ScreenSpaceCameraController::tilt3DOnTerrain(const Cartesian2 &startPositio
         _cameraController->worldToCameraCoordinates(originalPosition);
 
         double magSqrd = originalPosition.magnitudeSquared();
-        if (_cameraTrans->worldPosition().magnitudeSquared() > magSqrd) {
-            _cameraTrans->setWorldPosition(_cameraTrans->worldPosition().normalize() * sqrt(magSqrd));
+        if (_cameraController->cameraPosition().magnitudeSquared() > magSqrd) {
+            _cameraController->setCameraPosition(_cameraController->cameraPosition().normalize() * sqrt(magSqrd));
         }
 
-        double angle = CesiumCartesian3::angleBetween(originalPosition, _cameraTrans->worldPosition());
-        Cartesian3 axis = Cartesian3::cross(originalPosition, _cameraTrans->worldPosition());
+        double angle = CesiumCartesian3::angleBetween(originalPosition, _cameraController->cameraPosition());
+        Cartesian3 axis = Cartesian3::cross(originalPosition, _cameraController->cameraPosition());
         axis.normalize();
 
         angle = Math::toDegrees(angle);
         Quaternion quaternion = Quaternion::fromAxisAndAngle(axis, angle);
         Matrix3 rotation = quaternion.toRotationMatrix();
 
-        Cartesian3 direction = _cameraTrans->yaxis();
+        Cartesian3 direction = _cameraController->cameraDirection();
         Cartesian3 right;
-        Cartesian3 up = _cameraTrans->zaxis();
+        Cartesian3 up = _cameraController->cameraUp();
 
         direction = rotation * direction;
         up = rotation * up;
         right = Cartesian3::cross(direction, up);
         up = Cartesian3::cross(right, direction);
 
-        _cameraTrans->setAxes(right.normalize(), direction.normalize(), up.normalize());
+        _cameraController->setCameraAxes(right.normalize(), direction.normalize(), up.normalize());
 
         _cameraController->_setTransform(oldTransform);
     }
@@ -1348,13 +1826,15 @@ void ScreenSpaceCameraController::handleZoom(const Cartesian2 &startPosition, co
         distance = distanceMeasure - maxHeight;
     }
 
-    bool sameStartPosition = startPosition == _zoomMouseStart;
+    bool sameStartPosition = startPosition == _zoomMouseStart || reuseZoomAnchor(startPosition);
     bool zoomingOnVector = _zoomingOnVector;
     bool rotatingZoom = _rotatingZoom;
     Cartesian3 pickedPosition;
 
+    _zoomMouseStart = startPosition;
     if (!sameStartPosition) {
-        _zoomMouseStart = startPosition;
+        _zoomAnchorMousePosition = startPosition;
+        _zoomCenterTime = -1;
         pickedPosition = pickGlobe(Vector2(startPosition.x, startPosition.y));
 
         if (!pickedPosition.isNull()) {
@@ -1368,12 +1848,14 @@ void ScreenSpaceCameraController::handleZoom(const Cartesian2 &startPosition, co
         rotatingZoom = _rotatingZoom = false;
     }
 
+    _zoomAnchorTime = _useZoomWorldPosition ? _frameTime : -1;
+
     if (!_useZoomWorldPosition) {
-        Cartesian3 oldPos = _cameraTrans->worldPosition();
+        Cartesian3 oldPos = _cameraController->cameraPosition();
         Cartographic carto = cartesianToCartographic(oldPos);
         if (carto.height < 0) {
             carto.height = 0.8;
-            _cameraTrans->setCartographic(carto);
+            _cameraController->setCameraPosition(cartographicToCartesian(carto));
         }
         else {
             _cameraController->zoomIn(distance);
@@ -1388,18 +1870,17 @@ void ScreenSpaceCameraController::handleZoom(const Cartesian2 &startPosition, co
     }
 
     if (!sameStartPosition || rotatingZoom) {
-        Cartesian3 cameraPositionNormal = _cameraTrans->worldPosition().normalized();
+        Cartesian3 cameraPositionNormal = _cameraController->cameraPosition().normalized();
 
         if (_cameraController->positionCartographic().height < 3000.0 &&
-                abs(Cartesian3::dot(_cameraTrans->yaxis(), cameraPositionNormal)) < 0.6) {
+                abs(Cartesian3::dot(_cameraController->cameraDirection(), cameraPositionNormal)) < 0.6) {
             zoomOnVector = true;
         } else {
-            Cartesian2 centerPixel(_canvas->width() / 2, _canvas->height() / 2);
-            Cartesian3 centerPosition = pickGlobe(Vector2(centerPixel.x, centerPixel.y));
+            Cartesian3 centerPosition = pickZoomCenter(sameStartPosition);
             // If centerPosition is not defined, it means the globe does not cover the center position of screen
 
             if (!centerPosition.isNull() && _cameraController->positionCartographic().height < 1000000) {
-                Cartesian3 cameraPosition = _cameraTrans->worldPosition();
+                Cartesian3 cameraPosition = _cameraController->cameraPosition();
                 Cartesian3 target = _zoomWorldPosition;
                 Cartesian3 targetNormal = target.normalized();
 
@@ -1407,7 +1888,7 @@ void ScreenSpaceCameraController::handleZoom(const Cartesian2 &startPosition, co
                     return;
                 }
 
-                Cartesian3 forward = _cameraTrans->yaxis();
+                Cartesian3 forward = _cameraController->cameraDirection();
                 Cartesian3 center = cameraPosition +  forward * 1000;
 
                 Cartesian3 positionToTarget = target - cameraPosition;
@@ -1421,6 +1902,8 @@ void ScreenSpaceCameraController::handleZoom(const Cartesian2 &startPosition, co
                     // This line causes the next zoom movement to pick a new starting point.
                     if (!_enableUnderGround) {
                        _zoomMouseStart.x = -1;
+                       _zoomAnchorTime = -1;
+                       _zoomCenterTime = -1;
                        return;
                     }
                     else {
@@ -1463,27 +1946,27 @@ void ScreenSpaceCameraController::handleZoom(const Cartesian2 &startPosition, co
                     center += cMid;
                 }
 
-                Cartesian3 oldPos = _cameraTrans->worldPosition();
+                Cartesian3 oldPos = _cameraController->cameraPosition();
 
                 // Set new position
-                _cameraTrans->setWorldPosition(cameraPosition);
+                _cameraController->setCameraPosition(cameraPosition);
 
                 // add by feng
-                if (cartesianToCartographic(_cameraTrans->worldPosition()).height < 1) {
-                    _cameraTrans->setWorldPosition(oldPos);
+                if (cartesianToCartographic(_cameraController->cameraPosition()).height < 1) {
+                    _cameraController->setCameraPosition(oldPos);
                     return;
                 }
 
                 // Set new direction
                 Cartesian3 directionCarte = (center - cameraPosition).normalize();
                 Cartesian3 rightCarte;
-                Cartesian3 upCarte = _cameraTrans->zaxis();
+                Cartesian3 upCarte = _cameraController->cameraUp();
 
                 // Set new right & up vectors
                 rightCarte = Cartesian3::cross(directionCarte, upCarte);
                 upCarte = Cartesian3::cross(rightCarte, directionCarte);
 
-                _cameraTrans->setAxes(rightCarte.normalize(), directionCarte, upCarte.normalize());
+                _cameraController->setCameraAxes(rightCarte.normalize(), directionCarte, upCarte.normalize());
 
                 return;
             }
@@ -1512,9 +1995,9 @@ void ScreenSpaceCameraController::handleZoom(const Cartesian2 &startPosition, co
 
     if ((!sameStartPosition && zoomOnVector) || zoomingOnVector) {
         Ray ray;
-        Vector3 zoomMouseStartVec = _camera->worldToScreenPoint(_zoomWorldPosition);
-        Cartesian2 zoomMouseStart(zoomMouseStartVec.x(), zoomMouseStartVec.y());
-        if (!zoomMouseStart.isNull() && startPosition == _zoomMouseStart) {
+        int zoomMouseStartFlags;
+        Cartesian2 zoomMouseStart = _cameraController->projectToWindow(_zoomWorldPosition, &zoomMouseStartFlags);
+        if (zoomMouseStartFlags != WindowProjection::BehindCamera && startPosition == _zoomMouseStart) {
             ray = _cameraController->getPickRay(zoomMouseStart.x, zoomMouseStart.y);
         } else {
             ray = _cameraController->getPickRay(startPosition.x, startPosition.y);
@@ -1523,39 +2006,74 @@ void ScreenSpaceCameraController::handleZoom(const Cartesian2 &startPosition, co
         Cartesian3 rayDirection = ray.direction;
         _cameraController->move(rayDirection, distance);
 
-        //相机位置低于地表0.9米
-        Cartographic cameraCartographic = _ellipsoid->cartesianToCartographic(_cameraController->positionWC());
-        double cameraHeight = cameraCartographic.height;
-        if (!_enableUnderGround) {
-            double height = m_globe->getHeight(cameraCartographic);
-            if (height < 0)
-                height = 0;
-            height = height + 0.9;
-            if (cameraHeight < height) {
-               _cameraController->move(rayDirection, -distance);
-            }
-        }
-        else {
-            if (cameraHeight < -980) {
-                _cameraController->move(rayDirection, -distance);
-            }
-        }
-
         _zoomingOnVector = true;
     } else {
         _cameraController->zoomIn(distance);
     }
 }
 
+bool ScreenSpaceCameraController::reuseZoomAnchor(const Cartesian2 &startPosition)
+{
+    // 滚轮和触控板的缩放从当前鼠标位置开始, 鼠标稍有移动时沿用上一次拾取的锚点
+    if (!_useZoomWorldPosition || _zoomAnchorTime < 0 ||
+            CameraClock::toMilliseconds(_frameTime - _zoomAnchorTime) > _zoomAnchorTimeout) {
+        return false;
+    }
+
+    if (!withinZoomAnchorTolerance(startPosition, _zoomAnchorMousePosition)) {
+        return false;
+    }
+
+    // 相机移动后锚点可能已经不在鼠标下
+    int flags;
+    Cartesian2 anchor = _cameraController->projectToWindow(_zoomWorldPosition, &flags);
+    return flags == WindowProjection::Visible && withinZoomAnchorTolerance(startPosition, anchor);
+}
+
+Cartesian3 ScreenSpaceCameraController::pickZoomCenter(bool anchorKept)
+{
+    Cartesian2 centerPixel(_canvas->width() / 2, _canvas->height() / 2);
+
+    // 沿用锚点时屏幕中心的拾取结果也沿用, 直到超时或拾取点离开屏幕中心
+    if (anchorKept && _zoomCenterTime >= 0 &&
+            CameraClock::toMilliseconds(_frameTime - _zoomCenterTime) <= _zoomAnchorTimeout) {
+        if (_zoomCenterPosition.isNull()) {
+            // 地球没有覆盖屏幕中心, 超时后再拾取
+            return _zoomCenterPosition;
+        }
+
+        int flags;
+        Cartesian2 center = _cameraController->projectToWindow(_zoomCenterPosition, &flags);
+        if (flags == WindowProjection::Visible && withinZoomAnchorTolerance(centerPixel, center)) {
+            _zoomCenterTime = _frameTime;
+            return _zoomCenterPosition;
+        }
+    }
+
+    _zoomCenterPosition = pickGlobe(Vector2(centerPixel.x, centerPixel.y));
+    _zoomCenterTime = _frameTime;
+    return _zoomCenterPosition;
+}
+
+bool ScreenSpaceCameraController::withinZoomAnchorTolerance(const Cartesian2 &left, const Cartesian2 &right) const
+{
+    double dx = left.x - right.x;
+    double dy = left.y - right.y;
+    return dx * dx + dy * dy <= _zoomAnchorTolerance * _zoomAnchorTolerance;
+}
+
 void ScreenSpaceCameraController::handleKeyDown()
 {
-    if (lastTime == 0)
-        lastTime = getTimestamp();
-    quint64 time = getTimestamp();
-    quint64 gap = time - lastTime;
-    lastTime = time;
+    if (lastTime < 0)
+        lastTime = _frameTime;
+    double gap = CameraClock::toMilliseconds(_frameTime - lastTime);
+    lastTime = _frameTime;
 
-    Cartesian3 cameraCarte =  _cameraTrans->worldPosition();
+    if (!_input) {
+        return;
+    }
+
+    Cartesian3 cameraCarte =  _cameraController->cameraPosition();
     Cartographic cameraCarto = _ellipsoid->cartesianToCartographic(cameraCarte);
     double cameraHeight = cameraCarto.height;
 
@@ -1594,25 +2112,13 @@ void ScreenSpaceCameraController::handleKeyDown()
     }
 
     if ((_input->getKey(Qt::Key_Plus) || _input->getKey(Qt::Key_Equal)) && _enableInputs) {
-        if (!_enableUnderGround) {
-            double height = m_globe->getHeight(cameraCarto);
-            if (height < 0)
-                height = 0;
-            height = height + 0.9;
-            if (cameraHeight > height) {
-                if ((cameraHeight - moveRate) <= height)
-                     _cameraController->moveForward(cameraHeight - height);
-                else
-                     _cameraController->moveForward(moveRate);
-            }
-        }
-        else {
-            if (cameraHeight > -980) {
-                if ((cameraHeight - moveRate) <= -980)
-                     _cameraController->moveForward(cameraHeight + 980);
-                else
-                     _cameraController->moveForward(moveRate);
-            }
+        // 步长与高度成正比, 到达地面 (或地下的最低高度) 后停止前进
+        double floor = collisionFloor(cameraCarto);
+        if (cameraHeight > floor) {
+            if ((cameraHeight - moveRate) <= floor)
+                 _cameraController->moveForward(cameraHeight - floor);
+            else
+                 _cameraController->moveForward(moveRate);
         }
     }
 
@@ -1626,25 +2132,12 @@ void ScreenSpaceCameraController::handleKeyDown()
     }
 
     if (_input->getKey(Qt::Key_PageUp) && _enableInputs) {
-        if (!_enableUnderGround) {
-            double height = m_globe->getHeight(cameraCarto);
-            if (height < 0)
-                height = 0;
-            height = height + 0.9;
-            if (cameraHeight > height) {
-                if ((cameraHeight - pageMoveRate) <= height)
-                     _cameraController->moveForward(cameraHeight - height);
-                else
-                     _cameraController->moveForward(pageMoveRate);
-            }
-        }
-        else {
-            if (cameraHeight > -980) {
-                if ((cameraHeight - pageMoveRate) <= -980)
-                     _cameraController->moveForward(cameraHeight + 980);
-                else
-                     _cameraController->moveForward(pageMoveRate);
-            }
+        double floor = collisionFloor(cameraCarto);
+        if (cameraHeight > floor) {
+            if ((cameraHeight - pageMoveRate) <= floor)
+                 _cameraController->moveForward(cameraHeight - floor);
+            else
+                 _cameraController->moveForward(pageMoveRate);
         }
     }
 
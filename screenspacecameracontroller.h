@@ -8,17 +8,23 @@
 #include "rectangle.h"
 #include "ray.h"
 #include "licameracontroller.h"
+#include "camerastate.h"
+#include "ellipsoidaloccluder.h"
+#include "cameraclock.h"
+#include "cameracommandbuffer.h"
+#include "camerasync.h"
+#include "cameraenvironment.h"
+#include <QPointer>
 
 class CameraEventAggregator;
-class LiScene;
-class LiCamera;
 class Ellipsoid;
-class Globe;
 class Tween;
 class TweenCollection;
 class CameraController;
-class LiWidget;
-class LiInputSystem;
+class QTouchEvent;
+struct CameraFlightSample;
+struct CameraMotionMetrics;
+struct CameraWaypoint;
 
 /**
  * @brief 根据窗口的鼠标输入修改相机位置和方向
@@ -27,15 +33,33 @@ class LiInputSystem;
 class CONTROLLER_EXPORT ScreenSpaceCameraController : public LiCameraController
 {
     Q_OBJECT
+    // 覆盖LiCameraController的位姿属性, 增加NOTIFY (不修改licore的LiCameraController)
+    Q_PROPERTY(Vector3 positionWC READ positionWC NOTIFY viewChanged)
+    Q_PROPERTY(Vector3 rightWC READ rightWC NOTIFY viewChanged)
+    Q_PROPERTY(Vector3 directionWC READ directionWC NOTIFY viewChanged)
+    Q_PROPERTY(Vector3 upWC READ upWC NOTIFY viewChanged)
+    Q_PROPERTY(Cartographic positionCartographic READ positionCartographic NOTIFY viewChanged)
+    Q_PROPERTY(double heading READ heading NOTIFY viewChanged)
+    Q_PROPERTY(double pitch READ pitch NOTIFY viewChanged)
+    Q_PROPERTY(double roll READ roll NOTIFY viewChanged)
+    Q_PROPERTY(double percentageChanged READ percentageChanged WRITE setPercentageChanged)
 
 public:
     /**
-     * @brief 构造函数
+     * @brief 构造函数, 使用GlobalViewer()的窗口, 输入系统, 场景和主相机
      *
      * @param parent 父类指针
      */
     explicit ScreenSpaceCameraController(LiNode *parent = nullptr);
 
+    /**
+     * @brief 构造函数, 使用注入的环境, 可以在没有LiWidget的服务端和测试中运行, 或离线生成相机轨迹
+     *
+     * @param environment 窗口, 输入, 地球和相机 (不拥有, 生命周期必须长于控制器)
+     * @param parent 父类指针
+     */
+    explicit ScreenSpaceCameraController(const CameraEnvironment &environment, LiNode *parent = nullptr);
+
     /**
      * @brief 析构函数
      *
@@ -161,6 +185,78 @@ public:
      */
     void setMinimumCollisionTerrainHeight(double minimumCollisionTerrainHeight) override;
 
+    /**
+     * @brief 获取相机与地形之间保持的最小距离
+     *
+     * @return double 最小距离 (米)
+     */
+    double collisionClearance() const;
+
+    /**
+     * @brief 设置相机与地形之间保持的最小距离, 默认0.9米
+     *
+     * @param clearance 最小距离 (米)
+     */
+    void setCollisionClearance(double clearance);
+
+    /**
+     * @brief 获取碰撞检测每帧沿相机路径采样地形高度的次数
+     *
+     * @return int 采样次数
+     */
+    int collisionSampleCount() const;
+
+    /**
+     * @brief 设置碰撞检测每帧沿相机路径采样地形高度的次数, 默认16, 命中后另有固定次数的二分
+     *
+     * @param count 采样次数 (至少为1)
+     */
+    void setCollisionSampleCount(int count);
+
+    /**
+     * @brief 获取允许进入地下时相机的最低高度
+     *
+     * @return double 高度 (米)
+     */
+    double undergroundFloor() const;
+
+    /**
+     * @brief 设置允许进入地下 (enableUnderGround) 时相机的最低高度, 默认-980米
+     *
+     * @param floor 高度 (米)
+     */
+    void setUndergroundFloor(double floor);
+
+    /**
+     * @brief 获取连续缩放沿用锚点的时间窗口
+     *
+     * @return double 时间 (毫秒)
+     */
+    double zoomAnchorTimeout() const;
+
+    /**
+     * @brief 设置连续缩放沿用锚点的时间窗口, 默认300毫秒. 滚轮和触控板的缩放在这个时间内连续发生时,
+     * 沿用上一次拾取的世界坐标作为缩放锚点, 不再重新拾取
+     *
+     * @param timeout 时间 (毫秒), 为0时每次鼠标移动都重新拾取
+     */
+    void setZoomAnchorTimeout(double timeout);
+
+    /**
+     * @brief 获取沿用缩放锚点的像素容差
+     *
+     * @return double 像素
+     */
+    double zoomAnchorTolerance() const;
+
+    /**
+     * @brief 设置沿用缩放锚点的像素容差, 默认8像素. 鼠标离开拾取位置, 或者锚点投影到屏幕后离开鼠标超过容差时重新拾取.
+     * 屏幕中心的拾取结果投影后离开屏幕中心超过容差时也重新拾取
+     *
+     * @param tolerance 像素
+     */
+    void setZoomAnchorTolerance(double tolerance);
+
     /**
      * @brief 获取相机更新后的世界坐标
      *
@@ -217,6 +313,35 @@ public:
      */
     double roll() override;
 
+    /**
+     * @brief 返回发出changed信号的阈值
+     *
+     * @return double 相机位置或方向改变量占视图的比例
+     */
+    double percentageChanged() const;
+
+    /**
+     * @brief 设置发出changed信号的阈值, 默认0.5
+     *
+     * @param percentage 比例 (0到1)
+     */
+    void setPercentageChanged(double percentage);
+
+    /**
+     * @brief 获取相机停止移动后发出moveEnd之前等待的时间
+     *
+     * @return double 时间 (毫秒)
+     */
+    double moveEndWaitTime() const;
+
+    /**
+     * @brief 设置相机停止移动后发出moveEnd之前等待的时间, 默认500毫秒 (与Cesium的cameraEventWaitTime相同).
+     * 拖动时鼠标移动事件每帧合并一次, 没有鼠标移动的帧不会结束这次移动
+     *
+     * @param waitTime 时间 (毫秒), 为0时位姿一帧没有变化就发出moveEnd
+     */
+    void setMoveEndWaitTime(double waitTime);
+
     /**
      * @brief 从相机向一个屏幕点(x, y)发射一条射线 (相机拾取)
      *
@@ -372,6 +497,23 @@ public:
      */
     Q_INVOKABLE void zoomOut(double amount) override;
 
+    /**
+     * @brief 提交一组相机操作, 在下一次update中按提交顺序在一个事务里执行 (先于本帧的鼠标和键盘输入)
+     *
+     * 每条操作是一个列表, 第一个元素为操作名, 例如 [["rotateLeft", 0.1], ["moveForward", 100], ["setView", x, y, z, heading, pitch, roll]]
+     *
+     * @param commands 操作列表
+     * @return bool true: 已提交, false: 有无法解析的操作, 整组都不执行
+     */
+    Q_INVOKABLE bool submitCommands(const QVariantList &commands);
+
+    /**
+     * @brief 提交一组相机操作 (C++), 在下一次update中按提交顺序在一个事务里执行, 可以在任意线程调用
+     *
+     * @param buffer 相机操作
+     */
+    void submitCommands(const CameraCommandBuffer &buffer);
+
     /**
      * @brief 相机飞到目标点 (Vector3类型)
      *
@@ -413,20 +555,228 @@ public:
      */
     Q_INVOKABLE Cartesian3 pickGlobe(const Vector2 &mousePosition) const override;
 
+    /**
+     * @brief 预测当前飞行在未来若干时刻的相机状态, 用于提前加载地形和影像
+     *
+     * @param timeOffsets 相对当前时刻的时间偏移 (秒)
+     * @param withFootprint 是否计算视锥在椭球上的覆盖范围
+     * @return QVector<CameraFlightSample> 与timeOffsets一一对应, 没有飞行时返回的结果均为无效
+     */
+    QVector<CameraFlightSample> sampleFlight(const QVector<double> &timeOffsets, bool withFootprint = false);
+
+    /**
+     * @brief 相机沿多个途经点连续漫游
+     *
+     * @param waypoints 途经点, 时间相对漫游开始 (秒)
+     */
+    void flyTour(const QVector<CameraWaypoint> &waypoints);
+
+    /**
+     * @brief 获取最近一帧发布的相机状态 (线程安全, 可在任意线程调用)
+     *
+     * @return CameraState 相机状态快照
+     */
+    CameraState cameraState() const;
+
+    /**
+     * @brief 获取最近一帧发布的相机状态序号 (线程安全), 序号不变时相机状态没有变化
+     *
+     * @return quint64 发布序号
+     */
+    quint64 cameraStateEpoch() const;
+
+    /**
+     * @brief 处理窗口收到的触摸事件, 触摸移动在下一次update时合并成一次相机移动
+     *
+     * @param event 触摸事件 (TouchBegin, TouchUpdate, TouchEnd, TouchCancel)
+     * @return bool true: 已处理, false: 不是触摸事件
+     */
+    bool handleTouchEvent(QTouchEvent *event);
+
+    /**
+     * @brief 处理滚轮事件, 用于没有LiInputSystem的环境 (测试, 回放和远程控制), 在下一次update时缩放
+     *
+     * @param position 鼠标位置 (屏幕坐标)
+     * @param deltaY 滚动量, 与LiInputSystem::mouseWheeling相同
+     */
+    void handleWheel(const Cartesian2 &position, int deltaY);
+
+    /**
+     * @brief 获取输入事件计数, 用于验证高频鼠标和触摸输入是否每帧只触发一次
+     *
+     * @return InputEventCounters 收到的和合并后触发的事件数量
+     */
+    InputEventCounters inputEventCounters() const;
+
+    /**
+     * @brief 获取当前椭球的地平线遮挡测试 (只在poseEpoch或椭球改变时重新计算)
+     *
+     * @return EllipsoidalOccluder 遮挡测试
+     */
+    EllipsoidalOccluder ellipsoidalOccluder();
+
+    /**
+     * @brief 获取相机的运动指标 (线速度, 角速度, 屏幕运动速率和是否快速运动)
+     *
+     * @return CameraMotionMetrics 运动指标
+     */
+    CameraMotionMetrics motionMetrics();
+
+    /**
+     * @brief 获取进入快速运动的阈值
+     *
+     * @return double 屏幕内容的运动速率 (像素/秒)
+     */
+    double fastMotionThreshold() const;
+
+    /**
+     * @brief 设置进入快速运动的阈值, 默认500像素/秒
+     *
+     * @param threshold 屏幕内容的运动速率 (像素/秒)
+     */
+    void setFastMotionThreshold(double threshold);
+
+    /**
+     * @brief 获取当前使用的时钟
+     *
+     * @return CameraClock* 时钟
+     */
+    CameraClock *clock() const;
+
+    /**
+     * @brief 设置时钟, 动画, 惯性, 键盘移动和相机状态的时间戳都来自这个时钟, 用于测试和回放使用模拟时间
+     *
+     * @param clock 时钟 (不拥有, 生命周期必须长于控制器), 为空时恢复默认的SteadyCameraClock
+     */
+    void setClock(CameraClock *clock);
+
+    /**
+     * @brief 获取当前帧的时间戳, 每次update开始时从时钟读取一次
+     *
+     * @return qint64 时间 (纳秒)
+     */
+    qint64 frameTime() const;
+
+    /**
+     * @brief 批量测试点是否在地平线之前 (SoA数组), 用于剔除地球背面的广告牌和点
+     *
+     * @param x 世界坐标的x数组
+     * @param y 世界坐标的y数组
+     * @param z 世界坐标的z数组
+     * @param visible 每个点的结果, 1: 可见, 0: 被椭球遮挡
+     * @param count 点的数量
+     */
+    void isPointVisible(const double *x, const double *y, const double *z, quint8 *visible, int count);
+
+    /**
+     * @brief 批量测试包围球是否在地平线之前 (SoA数组)
+     *
+     * @param x 球心的x数组
+     * @param y 球心的y数组
+     * @param z 球心的z数组
+     * @param radius 半径数组
+     * @param visible 每个包围球的结果, 1: 可见或部分可见, 0: 被椭球遮挡
+     * @param count 包围球的数量
+     */
+    void isBoundingSphereVisible(const double *x, const double *y, const double *z, const double *radius,
+                                 quint8 *visible, int count);
+
+    /**
+     * @brief 作为拼接屏的主控节点, 每帧通过transport发送一次相机位姿
+     *
+     * @param transport 传输 (不拥有), 为空时停止同步
+     */
+    void setSyncMaster(CameraSyncTransport *transport);
+
+    /**
+     * @brief 作为拼接屏的跟随节点, 每帧应用主控节点的相机位姿, 本节点的飞行, 鼠标, 键盘和脚本操作都被忽略
+     *
+     * @param transport 传输 (不拥有), 为空时停止同步
+     */
+    void setSyncFollower(CameraSyncTransport *transport);
+
+    /**
+     * @brief 跟随节点相对主控相机的视角偏移, 用于多个屏幕拼接成更大的视野
+     *
+     * @param heading 绕相机z轴的偏移, 正值向右 (弧度)
+     * @param pitch 绕相机x轴的偏移, 正值向上 (弧度)
+     * @param roll 绕相机y轴的偏移 (弧度)
+     */
+    void setSyncViewOffset(double heading, double pitch, double roll);
+
+    /**
+     * @brief 跟随节点下一次update应用的帧号
+     *
+     * @param frame 帧号, 应用不超过这个帧号的最新位姿; 小于0时应用收到的最新位姿 (默认)
+     */
+    void setSyncTargetFrame(qint64 frame);
+
+    /**
+     * @brief 获取同步的帧号, 主控节点为下一帧要发送的帧号, 跟随节点为最近应用的帧号
+     *
+     * @return quint32 帧号
+     */
+    quint32 syncFrame() const;
+
     bool _enableInputs = true; ///< 开启或禁用相机的所有鼠标操作, true: 开启, false: 禁用
     double _minimumCollisionTerrainHeight = 15000.0; ///< 测试与地形碰撞前相机必须达到的最小高度
 
+signals:
+    /**
+     * @brief 进入或退出快速运动时发出, 渲染可以在快速旋转, 缩放惯性和飞行时降低地形精度
+     *
+     * @param fastMotion true: 进入快速运动, false: 相机已稳定
+     */
+    void fastMotionChanged(bool fastMotion);
+
+    /**
+     * @brief 相机开始移动时发出
+     *
+     */
+    void moveStart();
+
+    /**
+     * @brief 相机停止移动moveEndWaitTime之后发出
+     *
+     */
+    void moveEnd();
+
+    /**
+     * @brief 相机位置或方向的改变量超过percentageChanged时发出
+     *
+     * @param percentage 相对上一次发出changed时的改变量占视图的比例
+     */
+    void changed(double percentage);
+
+    /**
+     * @brief 相机位姿改变时发出, 每帧最多发出一次, 是位姿相关属性的NOTIFY信号
+     *
+     */
+    void viewChanged();
+
 public slots:
     void spin3DByKey(double startX, double startY, double endX, double endY, bool touring = false, bool mouseUp = false);
 
+private slots:
+    void receiveSyncPacket(const QByteArray &packet);
+
 private:
     bool m_touring = false;
     bool m_looking = false;
-    void pan3DByKey(double startX, double startY, double endX, double endY, Ellipsoid *ellipsoid);
+    template <typename Shape>
+    void pan3DByKey(double startX, double startY, double endX, double endY, const Shape &shape);
     void rotate3DByKey(double startX, double startY, double endX, double endY);
     void look3DByKey(double startX, double startY, double endX, double endY);
 
+    void initialize(const CameraEnvironment &environment);
     void update3D();
+    void publishCameraState();
+    void raiseCameraEvents();
+    void applyPendingCommands();
+    void applySyncPose();
+    void sendSyncPose();
+    void resolveCollision();
+    double collisionFloor(const Cartographic &cartographic) const;
 
     struct EventType {
         EventType() {
@@ -464,11 +814,14 @@ private:
     void tilt3D(const Cartesian2 &startPosition, const CameraMovement &movement);
     void look3D(const Cartesian2 &startPosition, const CameraMovement &movement);
     void strafe(const CameraMovement &movement);
-    void pan3D(const CameraMovement &movement, Ellipsoid *ellipsoid = nullptr);
+    template <typename Shape>
+    void pan3D(const CameraMovement &movement, const Shape &shape);
+    // localFrame为true时在倾斜中心的东北天坐标系中旋转, 旋转速率按单位球计算, 不修改成员状态
     void rotate3D(const CameraMovement &movement,
                   const Cartesian3 &constrainedAxis = Cartesian3(Math::EPSILON20, 0, 0),
                   bool rotateOnlyVertical = false,
-                  bool rotateOnlyHorizontal = false);
+                  bool rotateOnlyHorizontal = false,
+                  bool localFrame = false);
 
     void tilt3DOnEllipsoid(const Cartesian2 &startPosition, const CameraMovement &movement);
     void tilt3DOnTerrain(const Cartesian2 &startPosition, const CameraMovement &movement);
@@ -477,6 +830,9 @@ private:
                     double zoomFactor,
                     double distanceMeasure,
                     double unitPositionDotDirection);
+    bool reuseZoomAnchor(const Cartesian2 &startPosition);
+    Cartesian3 pickZoomCenter(bool anchorKept);
+    bool withinZoomAnchorTolerance(const Cartesian2 &left, const Cartesian2 &right) const;
 
     void handleKeyDown();
 
@@ -495,20 +851,39 @@ private:
 
     TweenCollection *_tweens;
     CameraEventAggregator *_aggregator;
-    LiInputSystem *_input;
-    LiScene *_scene;
-    LiWidget *_canvas;
-
-    Globe *_globe;
-    Globe *m_globe;
-    LiCamera *_camera;
-    LiTransform *_cameraTrans;
+    CameraInput *_input;
+    CameraCanvas *_canvas;
+
+    LiCameraEnvironment *_viewerEnvironment = nullptr; ///< 默认构造时从GlobalViewer()创建的环境
+    EllipsoidCameraGlobe *_ellipsoidGlobe = nullptr; ///< 环境没有提供地球时使用
+    CameraGlobe *_globe; ///< 相机在局部坐标系中时为空
+    CameraGlobe *m_globe;
+    CameraRig *_camera;
     Ellipsoid *_ellipsoid;
+    Ellipsoid *_globeEllipsoid;
     Ellipsoid *_sphereEllipsoid;
 
     CameraController *_cameraController;
     QHash<QString, MovementState*> _movementState;
 
+    CameraStatePublisher *_statePublisher;
+    quint64 _publishedPoseEpoch = 0;
+    double _publishedFovy = 0.0;
+    double _publishedAspectRatio = 0.0;
+    bool _publishedFlying = false;
+
+    quint64 _eventPoseEpoch = 0; ///< 上一帧发出相机事件时的poseEpoch
+    bool _moving = false; ///< 已经发出moveStart, 还没有发出moveEnd
+    qint64 _lastMoveTime = 0; ///< 最近一次位姿变化的帧时间 (纳秒)
+    double _moveEndWaitTime = 500.0;
+    double _percentageChanged = 0.5;
+    Cartesian3 _changedPosition = Cartesian3(Math::EPSILON20, 0, 0); ///< 上一次发出changed时的相机位置
+    Cartesian3 _changedDirection; ///< 上一次发出changed时的相机方向
+    double _changedHeading = 0.0; ///< 上一次发出changed时的heading (弧度)
+
+    EllipsoidalOccluder _occluder;
+    quint64 _occluderEpoch = 0;
+
     Cartesian3 _rotationAxis;
 
 //    bool enableTranslate = true;
@@ -524,6 +899,10 @@ private:
     double maximumZoomDistance = DBL_MAX;
 
     double _minimumPickingTerrainHeight = 150000.0;
+    double _collisionClearance = 0.9;
+    int _collisionSampleCount = 16;
+    double _undergroundFloor = -980.0; ///< 允许进入地下时相机的最低高度
+    Cartesian3 _collisionStartPosition = Cartesian3(Math::EPSILON20, 0, 0); ///< 本帧输入处理之前的相机位置
     double _minimumTrackBallHeight = 7500000.0;
 
     Cartesian2 _tiltCenterMousePosition = Cartesian2(-1.0, -1.0);
@@ -534,6 +913,12 @@ private:
     Cartesian2 _zoomMouseStart = Cartesian2(-1.0, -1.0);
     Cartesian3 _zoomWorldPosition;
     bool _useZoomWorldPosition = false;
+    Cartesian2 _zoomAnchorMousePosition; ///< 拾取_zoomWorldPosition时的鼠标位置
+    qint64 _zoomAnchorTime = -1; ///< 最近一次使用缩放锚点的帧时间 (纳秒), 小于0时锚点无效
+    Cartesian3 _zoomCenterPosition; ///< 缩放时屏幕中心的拾取结果, 与锚点一起沿用
+    qint64 _zoomCenterTime = -1; ///< 最近一次使用_zoomCenterPosition的帧时间 (纳秒), 小于0时无效
+    double _zoomAnchorTimeout = 300.0;
+    double _zoomAnchorTolerance = 8.0;
     bool _looking = false;
     bool _rotating = false;
     bool _strafing = false;
@@ -553,7 +938,30 @@ private:
     bool _enableUnderGround = false;
     bool _enablePan = true;
 
-    quint64 lastTime = 0;
+    SteadyCameraClock _steadyClock;
+    CameraClock *_clock = &_steadyClock;
+    QMutex _commandMutex;
+    CameraCommandBuffer _pendingCommands; ///< 等待下一次update执行的相机操作, 由_commandMutex保护
+
+    enum SyncRole {
+        SyncNone,
+        SyncMaster,
+        SyncFollower
+    };
+
+    SyncRole _syncRole = SyncNone;
+    QPointer<CameraSyncTransport> _syncTransport; ///< 不拥有, 被删除后自动变为空
+    CameraSyncEncoder _syncEncoder;
+    CameraSyncDecoder _syncDecoder;
+    QMap<quint32, CameraSyncPose> _syncPoses; ///< 跟随节点收到还没有应用的位姿, 按帧号排序
+    quint32 _syncFrame = 0;
+    bool _syncApplied = false; ///< 跟随节点是否已经应用过位姿 (_syncFrame有效)
+    qint64 _syncTargetFrame = -1;
+    double _syncHeadingOffset = 0.0;
+    double _syncPitchOffset = 0.0;
+    double _syncRollOffset = 0.0;
+    qint64 _frameTime = 0; ///< 当前帧的时间戳 (纳秒)
+    qint64 lastTime = -1; ///< 上一次处理键盘的帧时间 (纳秒), 小于0时还没有处理过
 //    double earthRadius = 6378137.0;
     double maxCameraHeight = 62000000.0;
 //    double minCameraHeight = 1.5;
@@ -1,15 +1,21 @@
 #include "screenspaceeventhandler.h"
 #include "timestamp.h"
 #include "liinputsystem.h"
+#include <QTouchEvent>
 
 ScreenSpaceEventHandler::ScreenSpaceEventHandler(QObject *parent)
     : QObject(parent)
 {
+    _touchEvent = ScreenSpaceMouseEventPtr(new ScreenSpaceMouseEvent);
+    _mouseMoveEvent = ScreenSpaceMouseEventPtr(new ScreenSpaceMouseEvent);
 }
 
 void ScreenSpaceEventHandler::setInputSystem(LiInputSystem *inputSystem)
 {
     _inputSystem = inputSystem;
+    if (!_inputSystem) {
+        return;
+    }
 
     std::function<ScreenSpaceMouseEventPtr(int)> getScreenSpaceMouseEvent = [this](int button) {
         ScreenSpaceMouseEvent *event = new ScreenSpaceMouseEvent;
@@ -51,7 +57,10 @@ void ScreenSpaceEventHandler::setInputSystem(LiInputSystem *inputSystem)
     });
     connect(_inputSystem, &LiInputSystem::mouseMoving, [=]() {
 //        qDebug() << "mouseMoving";
-        handleMouseMove(getScreenSpaceMouseEvent(0));
+        // 只记录位置, 由flushInputEvents每帧触发一次MOUSE_MOVE
+        _pendingMousePosition = _inputSystem->mousePosition();
+        _mouseMovePending = true;
+        ++_counters.rawMouseMoves;
     });
     connect(_inputSystem, &LiInputSystem::mouseWheeling, [=](int deltaX, int deltaY) {
 //        qDebug() << "mouseWheeling";
@@ -117,6 +126,8 @@ void ScreenSpaceEventHandler::handleMouseDown(ScreenSpaceMouseEventPtr event)
     if (!canProcessMouseEvent()) {
         return;
     }
+    flushMouseMove();
+
     int button = event->button;
     _buttonDown = button;
 
@@ -149,6 +160,8 @@ void ScreenSpaceEventHandler::handleMouseUp(ScreenSpaceMouseEventPtr event)
     if (!canProcessMouseEvent()) {
         return;
     }
+    flushMouseMove();
+
     int button = event->button;
     _buttonDown = 0;
 
@@ -247,186 +260,318 @@ void ScreenSpaceEventHandler::handleWheel(ScreenSpaceMouseEventPtr event)
     }
 }
 
-void ScreenSpaceEventHandler::handleTouchStart(ScreenSpaceMouseEventPtr event)
+bool ScreenSpaceEventHandler::processTouchEvent(QTouchEvent *event)
+{
+    switch (event->type()) {
+    case QEvent::TouchBegin:
+    case QEvent::TouchUpdate:
+    case QEvent::TouchEnd:
+        break;
+    case QEvent::TouchCancel:
+        touchCancel();
+        return true;
+    default:
+        return false;
+    }
+
+    for (const QTouchEvent::TouchPoint &touchPoint : event->touchPoints()) {
+        Cartesian2 position(touchPoint.pos().x(), touchPoint.pos().y());
+        switch (touchPoint.state()) {
+        case Qt::TouchPointPressed:
+            touchStart(touchPoint.id(), position);
+            break;
+        case Qt::TouchPointMoved:
+            touchMove(touchPoint.id(), position);
+            break;
+        case Qt::TouchPointReleased:
+            touchEnd(touchPoint.id());
+            break;
+        default:
+            break;
+        }
+    }
+
+    return true;
+}
+
+void ScreenSpaceEventHandler::touchStart(int id, const Cartesian2 &position)
 {
     gotTouchEvent();
 
-//    var changedTouches = event.changedTouches;
+    // 触摸点数量改变前先触发已合并的移动
+    flushTouchEvents();
 
-//    var i;
-//    var length = changedTouches.length;
-//    var touch;
-//    var identifier;
-//    var positions = screenSpaceEventHandler._positions;
+    int index = findTouch(id);
+    if (index >= 0) {
+        _touches[index].position = position;
+        _touches[index].previousPosition = position;
+        return;
+    }
+    if (_touchCount == MAXIMUM_TOUCH_COUNT) {
+        return;
+    }
+
+    TouchPoint &touch = _touches[_touchCount++];
+    touch.id = id;
+    touch.position = position;
+    touch.previousPosition = position;
 
-//    for (i = 0; i < length; ++i) {
-//        touch = changedTouches[i];
-//        identifier = touch.identifier;
-//        positions.set(identifier, getPosition(screenSpaceEventHandler, touch, new Cartesian2()));
-//    }
+    fireTouchEvents(position);
+}
 
-//    fireTouchEvents(screenSpaceEventHandler, event);
+void ScreenSpaceEventHandler::touchMove(int id, const Cartesian2 &position)
+{
+    gotTouchEvent();
 
-//    var previousPositions = screenSpaceEventHandler._previousPositions;
+    int index = findTouch(id);
+    if (index < 0) {
+        return;
+    }
 
-//    for (i = 0; i < length; ++i) {
-//        touch = changedTouches[i];
-//        identifier = touch.identifier;
-//        previousPositions.set(identifier, Cartesian2.clone(positions.get(identifier)));
-//    }
+    _touches[index].position = position;
+    _touchMoved = true;
+    ++_counters.rawTouchMoves;
 }
 
-void ScreenSpaceEventHandler::handleTouchEnd(ScreenSpaceMouseEventPtr event)
+void ScreenSpaceEventHandler::touchEnd(int id)
 {
     gotTouchEvent();
 
-//    var changedTouches = event.changedTouches;
+    flushTouchEvents();
 
-//    var i;
-//    var length = changedTouches.length;
-//    var touch;
-//    var identifier;
-//    var positions = screenSpaceEventHandler._positions;
+    int index = findTouch(id);
+    if (index < 0) {
+        return;
+    }
 
-//    for (i = 0; i < length; ++i) {
-//        touch = changedTouches[i];
-//        identifier = touch.identifier;
-//        positions.remove(identifier);
-//    }
+    // 保持按下的顺序, 第一个触摸点始终是主触摸点
+    Cartesian2 releasedPosition = _touches[index].previousPosition;
+    for (int i = index + 1; i < _touchCount; ++i) {
+        _touches[i - 1] = _touches[i];
+    }
+    --_touchCount;
 
-//    fireTouchEvents(screenSpaceEventHandler, event);
+    fireTouchEvents(releasedPosition);
+}
 
-//    var previousPositions = screenSpaceEventHandler._previousPositions;
+void ScreenSpaceEventHandler::touchCancel()
+{
+    while (_touchCount > 0) {
+        touchEnd(_touches[_touchCount - 1].id);
+    }
+}
 
-//    for (i = 0; i < length; ++i) {
-//        touch = changedTouches[i];
-//        identifier = touch.identifier;
-//        previousPositions.remove(identifier);
-//    }
+void ScreenSpaceEventHandler::mouseMove(const Cartesian2 &position)
+{
+    _pendingMousePosition = QPoint(qRound(position.x), qRound(position.y));
+    _mouseMovePending = true;
+    ++_counters.rawMouseMoves;
 }
 
-void ScreenSpaceEventHandler::handleTouchMove(ScreenSpaceMouseEventPtr event)
+void ScreenSpaceEventHandler::wheel(int deltaY, int modifier)
 {
-    gotTouchEvent();
+    ScreenSpaceMouseEventPtr event(new ScreenSpaceMouseEvent);
+    event->button = 0;
+    event->modifier = modifier;
+    event->deltaY = deltaY;
+    event->position = Cartesian2(_pendingMousePosition.x(), _pendingMousePosition.y());
+    handleWheel(event);
+}
 
-//    var changedTouches = event.changedTouches;
+void ScreenSpaceEventHandler::flushInputEvents()
+{
+    flushMouseMove();
+    flushTouchEvents();
+}
 
-//    var i;
-//    var length = changedTouches.length;
-//    var touch;
-//    var identifier;
-//    var positions = screenSpaceEventHandler._positions;
+InputEventCounters ScreenSpaceEventHandler::inputEventCounters() const
+{
+    return _counters;
+}
 
-//    for (i = 0; i < length; ++i) {
-//        touch = changedTouches[i];
-//        identifier = touch.identifier;
-//        var position = positions.get(identifier);
-//        if (defined(position)) {
+void ScreenSpaceEventHandler::flushMouseMove()
+{
+    if (!_mouseMovePending) {
+        return;
+    }
+    _mouseMovePending = false;
+    ++_counters.dispatchedMouseMoves;
+
+    _mouseMoveEvent->button = 0;
+    _mouseMoveEvent->modifier = _inputSystem ? getModifier(_inputSystem) : 0;
+    _mouseMoveEvent->position = Cartesian2(_pendingMousePosition.x(),
+                                           _pendingMousePosition.y());
+    handleMouseMove(_mouseMoveEvent);
+}
 
-//            getPosition(screenSpaceEventHandler, touch, position);
-//        }
-//    }
+void ScreenSpaceEventHandler::flushTouchEvents()
+{
+    if (!_touchMoved) {
+        return;
+    }
+    _touchMoved = false;
+    ++_counters.dispatchedTouchMoves;
 
-//    fireTouchMoveEvents(screenSpaceEventHandler, event);
+    fireTouchMoveEvents();
 
-//    var previousPositions = screenSpaceEventHandler._previousPositions;
+    for (int i = 0; i < _touchCount; ++i) {
+        _touches[i].previousPosition = _touches[i].position;
+    }
+}
 
-//    for (i = 0; i < length; ++i) {
-//        touch = changedTouches[i];
-//        identifier = touch.identifier;
-//        Cartesian2.clone(positions.get(identifier), previousPositions.get(identifier));
-//    }
+int ScreenSpaceEventHandler::touchCount() const
+{
+    return _touchCount;
 }
 
-void ScreenSpaceEventHandler::fireTouchEvents(ScreenSpaceMouseEventPtr event)
+int ScreenSpaceEventHandler::findTouch(int id) const
 {
-//    var modifier = getModifier(event);
-//    var positions = screenSpaceEventHandler._positions;
-//    var previousPositions = screenSpaceEventHandler._previousPositions;
-//    var numberOfTouches = positions.length;
-//    var action;
-//    var clickAction;
-//    var pinching = screenSpaceEventHandler._isPinching;
+    for (int i = 0; i < _touchCount; ++i) {
+        if (_touches[i].id == id) {
+            return i;
+        }
+    }
+    return -1;
+}
 
-//    if (numberOfTouches !== 1 && screenSpaceEventHandler._buttonDown === MouseButton.LEFT) {
-//        // transitioning from single touch, trigger UP and might trigger CLICK
-//        screenSpaceEventHandler._buttonDown = undefined;
-//        action = screenSpaceEventHandler.getInputAction(ScreenSpaceEventType.LEFT_UP, modifier);
+void ScreenSpaceEventHandler::fireTouchEvents(const Cartesian2 &releasedPosition)
+{
+    int modifier = _inputSystem ? getModifier(_inputSystem) : 0;
+    int numberOfTouches = _touchCount;
+    bool pinching = _isPinching;
+    InputAction action;
 
-//        if (defined(action)) {
-//            Cartesian2.clone(screenSpaceEventHandler._primaryPosition, touchEndEvent.position);
+    _touchEvent->button = Qt::LeftButton;
+    _touchEvent->modifier = modifier;
 
-//            action(touchEndEvent);
-//        }
+    if (numberOfTouches != 1 && _buttonDown == Qt::LeftButton) {
+        // transitioning from single touch, trigger UP and might trigger CLICK
+        _buttonDown = 0;
+        action = getInputAction(ScreenSpaceEventType::LEFT_UP, modifier);
 
-//        if (numberOfTouches === 0) {
-//            // releasing single touch, check for CLICK
-//            clickAction = screenSpaceEventHandler.getInputAction(ScreenSpaceEventType.LEFT_CLICK, modifier);
+        if (action) {
+            _touchEvent->position = _primaryPosition;
+            action(_touchEvent);
+        }
 
-//            if (defined(clickAction)) {
-//                var startPosition = screenSpaceEventHandler._primaryStartPosition;
-//                var endPosition = previousPositions.values[0];
-//                var xDiff = startPosition.x - endPosition.x;
-//                var yDiff = startPosition.y - endPosition.y;
-//                var totalPixels = Math.sqrt(xDiff * xDiff + yDiff * yDiff);
+        if (numberOfTouches == 0) {
+            // releasing single touch, check for CLICK
+            InputAction clickAction = getInputAction(ScreenSpaceEventType::LEFT_CLICK, modifier);
 
-//                if (totalPixels < screenSpaceEventHandler._clickPixelTolerance) {
-//                    Cartesian2.clone(screenSpaceEventHandler._primaryPosition, touchClickEvent.position);
+            if (clickAction) {
+                Cartesian2 startPosition = _primaryStartPosition;
+                double xDiff = startPosition.x - releasedPosition.x;
+                double yDiff = startPosition.y - releasedPosition.y;
+                double totalPixels = sqrt(xDiff * xDiff + yDiff * yDiff);
 
-//                    clickAction(touchClickEvent);
-//                }
-//            }
-//        }
+                if (totalPixels < _clickPixelTolerance) {
+                    _touchEvent->position = _primaryPosition;
+                    clickAction(_touchEvent);
+                }
+            }
+        }
 
-//        // Otherwise don't trigger CLICK, because we are adding more touches.
-//    }
+        // Otherwise don't trigger CLICK, because we are adding more touches.
+    }
 
-//    if (numberOfTouches === 0 && pinching) {
-//        // transitioning from pinch, trigger PINCH_END
-//        screenSpaceEventHandler._isPinching = false;
+    if (numberOfTouches == 0 && pinching) {
+        // transitioning from pinch, trigger PINCH_END
+        _isPinching = false;
 
-//        action = screenSpaceEventHandler.getInputAction(ScreenSpaceEventType.PINCH_END, modifier);
+        action = getInputAction(ScreenSpaceEventType::PINCH_END, modifier);
 
-//        if (defined(action)) {
-//            action();
-//        }
-//    }
+        if (action) {
+            action(_touchEvent);
+        }
+    }
+
+    if (numberOfTouches == 1 && !pinching) {
+        // transitioning to single touch, trigger DOWN
+        Cartesian2 position = _touches[0].position;
+        _primaryPosition = position;
+        _primaryStartPosition = position;
+        _primaryPreviousPosition = position;
 
-//    if (numberOfTouches === 1 && !pinching) {
-//        // transitioning to single touch, trigger DOWN
-//        var position = positions.values[0];
-//        Cartesian2.clone(position, screenSpaceEventHandler._primaryPosition);
-//        Cartesian2.clone(position, screenSpaceEventHandler._primaryStartPosition);
-//        Cartesian2.clone(position, screenSpaceEventHandler._primaryPreviousPosition);
+        _buttonDown = Qt::LeftButton;
 
-//        screenSpaceEventHandler._buttonDown = MouseButton.LEFT;
+        action = getInputAction(ScreenSpaceEventType::LEFT_DOWN, modifier);
 
-//        action = screenSpaceEventHandler.getInputAction(ScreenSpaceEventType.LEFT_DOWN, modifier);
+        if (action) {
+            _touchEvent->position = position;
+            action(_touchEvent);
+        }
+    }
+
+    if (numberOfTouches == 2 && !pinching) {
+        // transitioning to pinch, trigger PINCH_START
+        _isPinching = true;
+
+        action = getInputAction(ScreenSpaceEventType::PINCH_START, modifier);
+
+        if (action) {
+            _touchEvent->position1 = _touches[0].position;
+            _touchEvent->position2 = _touches[1].position;
+            action(_touchEvent);
+        }
+    }
+}
 
-//        if (defined(action)) {
-//            Cartesian2.clone(position, touchStartEvent.position);
+void ScreenSpaceEventHandler::fireTouchMoveEvents()
+{
+    int modifier = _inputSystem ? getModifier(_inputSystem) : 0;
+    int numberOfTouches = _touchCount;
+    InputAction action;
 
-//            action(touchStartEvent);
-//        }
+    _touchEvent->button = Qt::LeftButton;
+    _touchEvent->modifier = modifier;
 
-//        event.preventDefault();
-//    }
+    if (numberOfTouches == 1 && _buttonDown == Qt::LeftButton) {
+        // moving single touch
+        Cartesian2 position = _touches[0].position;
+        _primaryPosition = position;
 
-//    if (numberOfTouches === 2 && !pinching) {
-//        // transitioning to pinch, trigger PINCH_START
-//        screenSpaceEventHandler._isPinching = true;
+        Cartesian2 previousPosition = _primaryPreviousPosition;
 
-//        action = screenSpaceEventHandler.getInputAction(ScreenSpaceEventType.PINCH_START, modifier);
+        action = getInputAction(ScreenSpaceEventType::MOUSE_MOVE, modifier);
 
-//        if (defined(action)) {
-//            Cartesian2.clone(positions.values[0], touch2StartEvent.position1);
-//            Cartesian2.clone(positions.values[1], touch2StartEvent.position2);
+        if (action) {
+            _touchEvent->position = position;
+            _touchEvent->movement.startPosition = previousPosition;
+            _touchEvent->movement.endPosition = position;
+            action(_touchEvent);
+        }
 
-//            action(touch2StartEvent);
+        _primaryPreviousPosition = position;
+    } else if (numberOfTouches == 2 && _isPinching) {
+        // moving pinch, one event for all moves since the last flush
+        action = getInputAction(ScreenSpaceEventType::PINCH_MOVE, modifier);
 
-//            // Touch-enabled devices, in particular iOS can have many default behaviours for
-//            // "pinch" events, which can still be executed unless we prevent them here.
-//            event.preventDefault();
-//        }
-//    }
+        if (action) {
+            Cartesian2 position1 = _touches[0].position;
+            Cartesian2 position2 = _touches[1].position;
+            Cartesian2 previousPosition1 = _touches[0].previousPosition;
+            Cartesian2 previousPosition2 = _touches[1].previousPosition;
+
+            double dX = position2.x - position1.x;
+            double dY = position2.y - position1.y;
+            double dist = sqrt(dX * dX + dY * dY) * 0.25;
+
+            double prevDX = previousPosition2.x - previousPosition1.x;
+            double prevDY = previousPosition2.y - previousPosition1.y;
+            double prevDist = sqrt(prevDX * prevDX + prevDY * prevDY) * 0.25;
+
+            double cY = (position2.y + position1.y) * 0.125;
+            double prevCY = (previousPosition2.y + previousPosition1.y) * 0.125;
+            double angle = atan2(dY, dX);
+            double prevAngle = atan2(prevDY, prevDX);
+
+            CameraMovement &movement = _touchEvent->movement;
+            movement.distance.startPosition = Cartesian2(0.0, prevDist);
+            movement.distance.endPosition = Cartesian2(0.0, dist);
+            movement.angleAndHeight.startPosition = Cartesian2(prevAngle, prevCY);
+            movement.angleAndHeight.endPosition = Cartesian2(angle, cY);
+
+            action(_touchEvent);
+        }
+    }
 }
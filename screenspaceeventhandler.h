@@ -2,11 +2,13 @@
 #define SCREENSPACEEVENTHANDLER_H
 
 #include <QObject>
+#include <QPoint>
 #include <functional>
 #include "screenspaceeventutils.h"
 
 class LiInputSystem;
 class CameraEventAggregator;
+class QTouchEvent;
 
 /**
  * @brief 处理用户输入事件
@@ -62,7 +64,93 @@ public:
      */
     void removeInputAction(ScreenSpaceEventType::Type type, int modifier);
 
+    /**
+     * @brief 处理Qt的触摸事件, 按触摸点的状态转发给touchStart, touchMove和touchEnd
+     *
+     * @param event 触摸事件 (TouchBegin, TouchUpdate, TouchEnd, TouchCancel)
+     * @return bool true: 已处理, false: 不是触摸事件
+     */
+    bool processTouchEvent(QTouchEvent *event);
+
+    /**
+     * @brief 触摸点按下, 触摸点数量改变时立即触发LEFT_DOWN, LEFT_UP, PINCH_START等事件
+     *
+     * @param id 触摸点的id
+     * @param position 触摸点的位置 (屏幕坐标)
+     */
+    void touchStart(int id, const Cartesian2 &position);
+
+    /**
+     * @brief 触摸点移动, 只记录位置, 由flushTouchEvents合并成一次MOUSE_MOVE或PINCH_MOVE
+     *
+     * @param id 触摸点的id
+     * @param position 触摸点的位置 (屏幕坐标)
+     */
+    void touchMove(int id, const Cartesian2 &position);
+
+    /**
+     * @brief 触摸点抬起
+     *
+     * @param id 触摸点的id
+     */
+    void touchEnd(int id);
+
+    /**
+     * @brief 取消所有触摸点 (与所有触摸点抬起相同)
+     *
+     */
+    void touchCancel();
+
+    /**
+     * @brief 鼠标移动 (没有LiInputSystem时使用), 与LiInputSystem的鼠标移动一样由flushInputEvents合并触发
+     *
+     * @param position 鼠标位置 (屏幕坐标)
+     */
+    void mouseMove(const Cartesian2 &position);
+
+    /**
+     * @brief 滚轮滚动 (没有LiInputSystem时使用)
+     *
+     * @param deltaY 滚动量, 与LiInputSystem::mouseWheeling相同
+     * @param modifier 键盘按下的键 (默认为0, 表示不按下任何键)
+     */
+    void wheel(int deltaY, int modifier = 0);
+
+    /**
+     * @brief 把上一次调用以来的鼠标移动和触摸移动各合并成一次事件触发, 每一帧调用一次
+     *
+     */
+    void flushInputEvents();
+
+    /**
+     * @brief 获取输入事件计数
+     *
+     * @return InputEventCounters 收到的和合并后触发的事件数量
+     */
+    InputEventCounters inputEventCounters() const;
+
+    /**
+     * @brief 获取当前的触摸点数量
+     *
+     * @return int 触摸点数量
+     */
+    int touchCount() const;
+
 private:
+    enum {
+        MAXIMUM_TOUCH_COUNT = 10
+    };
+
+    /**
+     * @brief 触摸点, 按按下的顺序存放在固定大小的数组中
+     *
+     */
+    struct TouchPoint {
+        int id = -1; ///< 触摸点的id
+        Cartesian2 position; ///< 当前位置
+        Cartesian2 previousPosition; ///< 上一次触发事件时的位置
+    };
+
     int getModifier(LiInputSystem *inputSystem) const;
     int getModifier(QKeyEvent *event) const;
     quint64 getInputEventKey(int type, int modifier) const;
@@ -73,12 +161,13 @@ private:
     void handleMouseMove(ScreenSpaceMouseEventPtr event);
     void handleDblClick(ScreenSpaceMouseEventPtr event);
     void handleWheel(ScreenSpaceMouseEventPtr event);
-    void handleTouchStart(ScreenSpaceMouseEventPtr event);
-    void handleTouchEnd(ScreenSpaceMouseEventPtr event);
-    void handleTouchMove(ScreenSpaceMouseEventPtr event);
-    void fireTouchEvents(ScreenSpaceMouseEventPtr event);
+    void flushMouseMove();
+    void flushTouchEvents();
+    int findTouch(int id) const;
+    void fireTouchEvents(const Cartesian2 &releasedPosition);
+    void fireTouchMoveEvents();
 
-    LiInputSystem *_inputSystem;
+    LiInputSystem *_inputSystem = nullptr;
 
     QHash<quint64, InputAction> _inputEvents;
     int _buttonDown = 0;
@@ -88,9 +177,14 @@ private:
     Cartesian2 _primaryStartPosition;
     Cartesian2 _primaryPosition;
     Cartesian2 _primaryPreviousPosition;
-    QHash<QString, Cartesian2> _positions;
-    QHash<QString, Cartesian2> _previousPositions;
-    QHash<QString, Cartesian2> _removalFunctions;
+    TouchPoint _touches[MAXIMUM_TOUCH_COUNT];
+    int _touchCount = 0;
+    bool _touchMoved = false;
+    ScreenSpaceMouseEventPtr _touchEvent; ///< 触摸事件共用一个对象, 不在每次移动时分配
+    ScreenSpaceMouseEventPtr _mouseMoveEvent; ///< 鼠标移动事件共用一个对象
+    QPoint _pendingMousePosition; ///< 尚未触发的鼠标位置
+    bool _mouseMovePending = false;
+    InputEventCounters _counters;
     int _clickPixelTolerance = 5;
 };
 
@@ -24,6 +24,24 @@ typedef std::function<void(double k)> TweenAction1;
  */
 typedef std::function<double(double k)> TweenAction1Double;
 
+/**
+ * @brief 相机位姿结构体 (世界坐标 + heading/pitch/roll)
+ *
+ */
+struct CameraPose {
+    Cartesian3 position; ///< 相机的世界坐标
+    double heading = 0.0; ///< 相机的heading (弧度)
+    double pitch = 0.0; ///< 相机的pitch (弧度)
+    double roll = 0.0; ///< 相机的roll (弧度)
+    double fovy = Math::EPSILON20; ///< 相机的视角 (度), 无效时表示不修改视角
+};
+
+/**
+ * @brief 定义一个仅以一个double类型为参数且返回值类型为CameraPose的函数
+ *
+ */
+typedef std::function<CameraPose(double k)> TweenActionPose;
+
 /**
  * @brief 相机信息结构体
  *
@@ -84,6 +102,17 @@ struct ScreenSpaceMouseEvent {
  */
 typedef QSharedPointer<ScreenSpaceMouseEvent> ScreenSpaceMouseEventPtr;
 
+/**
+ * @brief 输入事件计数, 用于验证高频输入是否被合并
+ *
+ */
+struct InputEventCounters {
+    quint64 rawMouseMoves = 0; ///< 收到的鼠标移动次数
+    quint64 dispatchedMouseMoves = 0; ///< 合并后触发的MOUSE_MOVE次数
+    quint64 rawTouchMoves = 0; ///< 收到的触摸移动次数
+    quint64 dispatchedTouchMoves = 0; ///< 合并后触发的MOUSE_MOVE或PINCH_MOVE次数
+};
+
 /**
  * @brief 窗口事件类型
  *
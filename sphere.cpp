@@ -0,0 +1,17 @@
+#include "sphere.h"
+
+Sphere::Sphere()
+{
+}
+
+Sphere::Sphere(double radius)
+    : _radius(radius)
+    , _radiusSquared(radius * radius)
+{
+}
+
+Cartesian3 Sphere::geodeticSurfaceNormal(const Cartesian3 &position) const
+{
+    Cartesian3 normal = position;
+    return normal.normalize();
+}
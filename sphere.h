@@ -0,0 +1,44 @@
+#ifndef SPHERE_H
+#define SPHERE_H
+
+#include "sscc_global.h"
+#include "cartesian3.h"
+
+/**
+ * @brief 以原点为中心的球, 用于手势中按拾取点半径构造的临时球面
+ *
+ * 与半径相等的Ellipsoid等价, 但求交使用闭式解, 不需要按oneOverRadii缩放, 也不需要分配Ellipsoid
+ */
+class CONTROLLER_EXPORT Sphere
+{
+public:
+    /**
+     * @brief 默认构造 (单位球)
+     *
+     */
+    Sphere();
+
+    /**
+     * @brief 构造
+     *
+     * @param radius 半径
+     */
+    explicit Sphere(double radius);
+
+    /**
+     * @brief 获取球面上一点的法线
+     *
+     * @param position 球面上的点
+     * @return Cartesian3 法线 (单位向量)
+     */
+    Cartesian3 geodeticSurfaceNormal(const Cartesian3 &position) const;
+
+    double radius() const { return _radius; }
+    double radiusSquared() const { return _radiusSquared; }
+
+private:
+    double _radius = 1.0;
+    double _radiusSquared = 1.0;
+};
+
+#endif // SPHERE_H
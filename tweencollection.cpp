@@ -1,6 +1,5 @@
 #include "tweencollection.h"
 #include "tweenjs.h"
-#include "timestamp.h"
 
 Tween::Tween(QObject *parent) : QObject(parent)
 {
@@ -35,14 +34,29 @@ void Tween::cancelTween(TweenCollection *tweenCollection)
     tweenCollection->removeTween(this);
 }
 
+bool Tween::samplePose(double time, double now, CameraPose &pose) const
+{
+    if (!_sample || !_tweenjs) {
+        return false;
+    }
+
+    bool ended = false;
+    double value = _tweenjs->valueAt(time, now, &ended);
+    if (ended) {
+        return false;
+    }
+
+    pose = _sample(value);
+    return true;
+}
+
 TweenCollection::TweenCollection()
 {
 }
 
-void TweenCollection::update()
+void TweenCollection::update(double time)
 {
     int i = 0;
-    quint64 time = getTimestamp();
     while (i < _tweens.length()) {
         Tween *tween = _tweens[i];
         TweenJS *tweenjs = tween->_tweenjs;
@@ -80,16 +94,15 @@ Tween *TweenCollection::add(Tween *options)
     double delay = delayInSeconds / SECONDS_PER_MILLISECOND;
 
     TweenAction1Double easingFunction = options->_easingFunction;
-    if(!easingFunction)
-        easingFunction = [=](double k){
-            return TweenJS::EasingLinearNone(k);
-        };
 
     double value = options->_startObject;
     TweenJS *tweenjs = new TweenJS(value);
     tweenjs->to(options->_stopObject, duration);
     tweenjs->delay(delay);
-    tweenjs->easing(easingFunction);
+    if (easingFunction)
+        tweenjs->easing(easingFunction);
+    else
+        tweenjs->easing(options->_easingType);
     if (options->_update) {
         TweenAction1 copyUpdate = options->_update;
         TweenAction1 action = [=](double k){
@@ -101,6 +114,8 @@ Tween *TweenCollection::add(Tween *options)
     tweenjs->repeat(0.0);
 
     Tween *tween = new Tween(tweenjs, options->_startObject, options->_stopObject, options->_duration, delayInSeconds, easingFunction, options->_update, options->_complete, options->_cancle);
+    tween->_easingType = options->_easingType;
+    tween->_sample = options->_sample;
     _tweens.append(tween);
 
     delete options;
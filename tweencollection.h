@@ -3,6 +3,7 @@
 
 #include <QtCore>
 #include "screenspaceeventutils.h"
+#include "easing.h"
 
 class TweenCollection;
 class TweenJS;
@@ -58,15 +59,27 @@ public:
      */
     void cancelTween(TweenCollection *tweenCollection);
 
+    /**
+     * @brief 预测动画在指定时间的相机位姿, 不修改动画状态
+     *
+     * @param time 时间参数 (毫秒), 与TweenCollection::update使用同一时钟
+     * @param now 当前时间 (毫秒)
+     * @param pose 按引用传递一个参数, 最后变成预测的位姿
+     * @return bool true: 成功, false: 该动画没有位姿采样函数, 或者time已经超过动画的结束时间
+     */
+    bool samplePose(double time, double now, CameraPose &pose) const;
+
     TweenJS *_tweenjs = nullptr;
     double _startObject = Math::EPSILON20;
     double _stopObject = Math::EPSILON20;
     double _duration = 0.0;
     double _delay = 0.0;
-    TweenAction1Double _easingFunction = nullptr;
+    EasingType::Type _easingType = EasingType::LinearNone; ///< 插值函数类型, _easingFunction为空时使用
+    TweenAction1Double _easingFunction = nullptr; ///< 自定义插值函数, 优先于_easingType
     TweenAction1 _update = nullptr;
     TweenAction _complete = nullptr;
     TweenAction _cancle = nullptr;
+    TweenActionPose _sample = nullptr; ///< 位姿采样函数, 参数与_update相同, 用于预测未来的相机位姿
     bool needsStart = true;
 };
 
@@ -86,8 +99,9 @@ public:
     /**
      * @brief update函数
      *
+     * @param time 当前帧的时间 (毫秒), 由ScreenSpaceCameraController的时钟提供, 与Tween::samplePose使用同一时钟
      */
-    void update();
+    void update(double time);
 
     /**
      * @brief 从动画合集中移除指定的动画
@@ -10,10 +10,6 @@ TweenJS::TweenJS(double object)
         _object = object;
         _valuesStart = object;
     }
-
-    _easingFunction = [=](double k) {
-        return TweenJS::EasingLinearNone(k);
-    };
 }
 
 void TweenJS::to(double properties, double duration)
@@ -55,6 +51,12 @@ void TweenJS::easing(TweenAction1Double easing)
     _easingFunction = easing;
 }
 
+void TweenJS::easing(EasingType::Type type)
+{
+    _easingType = type;
+    _easingFunction = nullptr;
+}
+
 void TweenJS::onUpdate(TweenAction1 callback)
 {
     _onUpdateCallback = callback;
@@ -79,7 +81,7 @@ bool TweenJS::update(double time)
     double elapsed = ( time - _startTime ) / _duration;
     elapsed = elapsed > 1.0 ? 1.0 : elapsed;
 
-    double value = _easingFunction(elapsed);
+    double value = _easingFunction ? _easingFunction(elapsed) : Easing::ease(_easingType, elapsed);
 
     if(defined(_valuesEnd)) {
         double start = _valuesStart;
@@ -103,21 +105,40 @@ bool TweenJS::update(double time)
     return true;
 }
 
+double TweenJS::valueAt(double time, double now, bool *ended) const
+{
+    double startTime = _isPlaying ? _startTime : now + _delayTime;
+    if (time < startTime) {
+        time = startTime;
+    }
+    if (ended) {
+        *ended = time > startTime + _duration;
+    }
+
+    double elapsed = ( time - startTime ) / _duration;
+    elapsed = elapsed > 1.0 ? 1.0 : elapsed;
+
+    double value = _easingFunction ? _easingFunction(elapsed) : Easing::ease(_easingType, elapsed);
+
+    if(defined(_valuesEnd)) {
+        double start = _isPlaying ? _valuesStart : _object;
+        return start + ( _valuesEnd - start ) * value;
+    }
+
+    return _object;
+}
+
 double TweenJS::EasingLinearNone(double k)
 {
-    return  k;
+    return Easing::linearNone(k);
 }
 
 double TweenJS::EasingCubicOut(double k)
 {
-    --k;
-    return k * k * k + 1;
+    return Easing::cubicOut(k);
 }
 
 double TweenJS::EasingQuinticInOut(double k)
 {
-    if ( ( k *= 2 ) < 1 )
-        return 0.5 * k * k * k * k * k;
-    k -= 2;
-    return 0.5 * ( k * k * k * k * k + 2 );
+    return Easing::quinticInOut(k);
 }
@@ -2,6 +2,7 @@
 #define TWEENJS_H
 
 #include "screenspaceeventutils.h"
+#include "easing.h"
 
 /**
  * @brief 动画插值函数类
@@ -52,12 +53,19 @@ public:
     void delay(double amount);
 
     /**
-     * @brief 设置动画采用的插值函数
+     * @brief 设置动画采用的插值函数 (自定义函数, 优先于插值函数类型)
      *
      * @param easing 插值函数
      */
     void easing(TweenAction1Double easing);
 
+    /**
+     * @brief 设置动画采用的插值函数类型
+     *
+     * @param type 插值函数类型
+     */
+    void easing(EasingType::Type type);
+
     /**
      * @brief update回调函数
      *
@@ -87,6 +95,16 @@ public:
      */
     bool update(double time);
 
+    /**
+     * @brief 计算动画在指定时间的插值结果, 不修改动画状态, 也不触发回调
+     *
+     * @param time 时间参数, 与update使用同一时钟; 动画尚未开始时按照从当前时刻开始计算
+     * @param now 当前时间, 仅在动画尚未开始时使用
+     * @param ended 不为空时返回time是否已经超过动画的结束时间 (超过时插值结果为终点)
+     * @return double 插值结果
+     */
+    double valueAt(double time, double now, bool *ended = nullptr) const;
+
     /**
      * @brief EasingLinearNone插值函数
      *
@@ -120,6 +138,7 @@ private:
     bool _isPlaying = false;
     double _delayTime = 0.0;
     double _startTime = 0.0;
+    EasingType::Type _easingType = EasingType::LinearNone;
     TweenAction1Double _easingFunction = nullptr;
     TweenAction1 _onUpdateCallback = nullptr;
     TweenAction _onCompleteCallback = nullptr;
@@ -0,0 +1,139 @@
+#include "windowprojection.h"
+#include "screenspaceeventutils.h"
+#include <limits>
+
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#include <immintrin.h>
+#define WINDOWPROJECTION_AVX2
+#endif
+
+namespace {
+const int BLOCK_SIZE = 256;
+}
+
+WindowProjection::WindowProjection()
+    : _nearPlane(std::numeric_limits<double>::infinity())
+{
+}
+
+WindowProjection::WindowProjection(const BatchTransform &worldToView, double fovy, double aspectRatio, double nearPlane, int width, int height)
+    : _worldToView(worldToView)
+    , _fovy(fovy)
+    , _aspectRatio(aspectRatio)
+    , _nearPlane(nearPlane)
+    , _width(width)
+    , _height(height)
+{
+    double tanPhi = tan(Math::toRadians(fovy) * 0.5);
+    double tanTheta = aspectRatio * tanPhi;
+
+    _centerX = width * 0.5;
+    _centerY = height * 0.5;
+    _scaleX = _centerX / tanTheta;
+    _scaleY = _centerY / tanPhi;
+}
+
+Cartesian2 WindowProjection::project(const Cartesian3 &position, int *flags) const
+{
+    Cartesian3 view = _worldToView.transformPoint(position);
+
+    if (!(view.y >= _nearPlane)) {
+        if (flags) {
+            *flags = BehindCamera;
+        }
+        return Cartesian2(Math::EPSILON20, 0);
+    }
+
+    double inverseDepth = 1.0 / view.y;
+    Cartesian2 result(_centerX + view.x * inverseDepth * _scaleX,
+                      _centerY - view.z * inverseDepth * _scaleY);
+
+    if (flags) {
+        bool inside = result.x >= 0.0 && result.x <= _width && result.y >= 0.0 && result.y <= _height;
+        *flags = inside ? Visible : OffScreen;
+    }
+    return result;
+}
+
+void WindowProjection::project(const double *x, const double *y, const double *z,
+                               double *windowX, double *windowY, quint8 *flags, int count) const
+{
+    // 先用BatchTransform批量变换到相机局部坐标系, 再投影
+    double viewX[BLOCK_SIZE];
+    double viewY[BLOCK_SIZE];
+    double viewZ[BLOCK_SIZE];
+
+    const double width = _width;
+    const double height = _height;
+
+    for (int begin = 0; begin < count; begin += BLOCK_SIZE) {
+        const int size = std::min(BLOCK_SIZE, count - begin);
+        _worldToView.transformPoints(x + begin, y + begin, z + begin, viewX, viewY, viewZ, size);
+
+        double *outX = windowX + begin;
+        double *outY = windowY + begin;
+        quint8 *outFlags = flags ? flags + begin : nullptr;
+        int i = 0;
+
+#ifdef WINDOWPROJECTION_AVX2
+        const __m256d one = _mm256_set1_pd(1.0);
+        const __m256d zero = _mm256_setzero_pd();
+        const __m256d nearPlane = _mm256_set1_pd(_nearPlane);
+        const __m256d centerX = _mm256_set1_pd(_centerX);
+        const __m256d centerY = _mm256_set1_pd(_centerY);
+        const __m256d scaleX = _mm256_set1_pd(_scaleX);
+        const __m256d scaleY = _mm256_set1_pd(_scaleY);
+        const __m256d right = _mm256_set1_pd(width);
+        const __m256d bottom = _mm256_set1_pd(height);
+        const __m256d undefinedX = _mm256_set1_pd(Math::EPSILON20);
+
+        for (; i + 4 <= size; i += 4) {
+            __m256d vx = _mm256_loadu_pd(viewX + i);
+            __m256d vy = _mm256_loadu_pd(viewY + i);
+            __m256d vz = _mm256_loadu_pd(viewZ + i);
+
+            // !(vy >= near), NaN也算在相机背后
+            __m256d behind = _mm256_cmp_pd(vy, nearPlane, _CMP_NGE_UQ);
+            __m256d inverseDepth = _mm256_div_pd(one, vy);
+            __m256d wx = _mm256_fmadd_pd(_mm256_mul_pd(vx, inverseDepth), scaleX, centerX);
+            __m256d wy = _mm256_fnmadd_pd(_mm256_mul_pd(vz, inverseDepth), scaleY, centerY);
+
+            __m256d outside = _mm256_or_pd(_mm256_or_pd(_mm256_cmp_pd(wx, zero, _CMP_LT_OQ), _mm256_cmp_pd(wx, right, _CMP_GT_OQ)),
+                                           _mm256_or_pd(_mm256_cmp_pd(wy, zero, _CMP_LT_OQ), _mm256_cmp_pd(wy, bottom, _CMP_GT_OQ)));
+
+            _mm256_storeu_pd(outX + i, _mm256_blendv_pd(wx, undefinedX, behind));
+            _mm256_storeu_pd(outY + i, _mm256_blendv_pd(wy, zero, behind));
+
+            if (outFlags) {
+                int behindMask = _mm256_movemask_pd(behind);
+                int outsideMask = _mm256_movemask_pd(outside);
+                for (int k = 0; k < 4; ++k) {
+                    outFlags[i + k] = (behindMask >> k) & 1 ? quint8(BehindCamera) : ((outsideMask >> k) & 1 ? quint8(OffScreen) : quint8(Visible));
+                }
+            }
+        }
+#endif
+
+        for (; i < size; ++i) {
+            if (!(viewY[i] >= _nearPlane)) {
+                outX[i] = Math::EPSILON20;
+                outY[i] = 0.0;
+                if (outFlags) {
+                    outFlags[i] = BehindCamera;
+                }
+                continue;
+            }
+
+            double inverseDepth = 1.0 / viewY[i];
+            double wx = _centerX + viewX[i] * inverseDepth * _scaleX;
+            double wy = _centerY - viewZ[i] * inverseDepth * _scaleY;
+            outX[i] = wx;
+            outY[i] = wy;
+
+            if (outFlags) {
+                bool inside = wx >= 0.0 && wx <= width && wy >= 0.0 && wy <= height;
+                outFlags[i] = inside ? Visible : OffScreen;
+            }
+        }
+    }
+}
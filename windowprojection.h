@@ -0,0 +1,88 @@
+#ifndef WINDOWPROJECTION_H
+#define WINDOWPROJECTION_H
+
+#include "sscc_global.h"
+#include "cartesian2.h"
+#include "batchtransform.h"
+
+/**
+ * @brief 世界坐标到屏幕坐标的投影 (CameraController::getPickRayPerspective的逆运算)
+ *
+ * 视锥与getPickRayPerspective相同: 屏幕左上角为(0, 0), 视角fovy为垂直方向, 水平方向由宽高比决定.
+ * 批量投影使用SoA数组, 编译时开启AVX2和FMA时每次处理4个点
+ */
+class CONTROLLER_EXPORT WindowProjection
+{
+public:
+    /**
+     * @brief 投影结果的标志
+     *
+     */
+    enum Flag {
+        Visible = 0x0, ///< 在屏幕内
+        BehindCamera = 0x1, ///< 在近裁剪面之后 (包括相机背后), 屏幕坐标无效
+        OffScreen = 0x2 ///< 在相机前方但不在屏幕内
+    };
+
+    /**
+     * @brief 默认构造 (无效的投影, 所有点都在相机背后)
+     *
+     */
+    WindowProjection();
+
+    /**
+     * @brief 构造
+     *
+     * @param worldToView 世界坐标到相机局部坐标系的变换 (x: right, y: direction, z: up)
+     * @param fovy 视角 (度)
+     * @param aspectRatio 宽高比
+     * @param nearPlane 近裁剪面
+     * @param width 窗口宽度 (像素)
+     * @param height 窗口高度 (像素)
+     */
+    WindowProjection(const BatchTransform &worldToView, double fovy, double aspectRatio, double nearPlane, int width, int height);
+
+    /**
+     * @brief 投影一个点
+     *
+     * @param position 世界坐标
+     * @param flags 不为空时返回Flag
+     * @return Cartesian2 屏幕坐标, 在相机背后时为Cartesian2(Math::EPSILON20, 0)
+     */
+    Cartesian2 project(const Cartesian3 &position, int *flags = nullptr) const;
+
+    /**
+     * @brief 批量投影
+     *
+     * @param x 世界坐标的x数组
+     * @param y 世界坐标的y数组
+     * @param z 世界坐标的z数组
+     * @param windowX 屏幕坐标的x数组, 在相机背后时为Math::EPSILON20
+     * @param windowY 屏幕坐标的y数组
+     * @param flags 每个点的Flag, 可以为空
+     * @param count 点的数量
+     */
+    void project(const double *x, const double *y, const double *z,
+                 double *windowX, double *windowY, quint8 *flags, int count) const;
+
+    double fovy() const { return _fovy; }
+    double aspectRatio() const { return _aspectRatio; }
+    double nearPlane() const { return _nearPlane; }
+    int width() const { return _width; }
+    int height() const { return _height; }
+
+private:
+    BatchTransform _worldToView;
+    double _fovy = 0.0;
+    double _aspectRatio = 0.0;
+    double _nearPlane = 0.0;
+    int _width = 0;
+    int _height = 0;
+
+    double _centerX = 0.0; ///< 屏幕中心x
+    double _centerY = 0.0; ///< 屏幕中心y
+    double _scaleX = 0.0; ///< width / (2 * tanTheta)
+    double _scaleY = 0.0; ///< height / (2 * tanPhi)
+};
+
+#endif // WINDOWPROJECTION_H